@@ -7,16 +7,19 @@ modules_ModelManager.subdir = modules/ModelManager
 modules_CameraModule.subdir = modules/CameraModule
 modules_LightModule.subdir = modules/LightModule
 app.subdir = app
+bench_SceneTextBench.subdir = bench/SceneTextBench
 
 modules_RenderModule.depends = core
 modules_ModelManager.depends = core
 modules_CameraModule.depends = core
 modules_LightModule.depends = core
 app.depends = core modules_RenderModule modules_ModelManager modules_CameraModule modules_LightModule
+bench_SceneTextBench.depends = core
 
 SUBDIRS += core \
            modules_RenderModule \
            modules_ModelManager \
            modules_CameraModule \
            modules_LightModule \
-           app
+           app \
+           bench_SceneTextBench
@@ -0,0 +1,26 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+#ifndef QT_NO_DEBUG
+namespace {
+thread_local std::size_t g_threadAllocs = 0;
+void* countedAlloc(std::size_t n){
+	++g_threadAllocs;
+	if(void* p = std::malloc(n ? n : 1)) return p;
+	throw std::bad_alloc();
+}
+}
+void* operator new(std::size_t n){ return countedAlloc(n); }
+void* operator new[](std::size_t n){ return countedAlloc(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+bool AllocationCounter::enabled(){ return true; }
+std::size_t AllocationCounter::thisThread(){ return g_threadAllocs; }
+#else
+bool AllocationCounter::enabled(){ return false; }
+std::size_t AllocationCounter::thisThread(){ return 0; }
+#endif
@@ -0,0 +1,12 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+#include <cstddef>
+// Debug-only count of global operator new calls made by the current thread.
+// Used by the render thread to check that steady-state frames don't touch the heap.
+// Note: on Windows each DLL has its own operator new, so only allocations made from
+// the executable are seen there; on ELF platforms module code is counted too.
+namespace AllocationCounter {
+bool enabled();
+std::size_t thisThread();
+}
+#endif // ALLOCATIONCOUNTER_H
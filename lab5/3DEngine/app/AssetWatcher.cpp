@@ -0,0 +1,179 @@
+#include "AssetWatcher.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr int kMissingRetries = 5;
+
+bool sameColor(const Color& a, const Color& b){ return a.r==b.r && a.g==b.g && a.b==b.b && a.a==b.a; }
+bool sameVec(const Vec3& a, const Vec3& b){ return a.x==b.x && a.y==b.y && a.z==b.z; }
+
+bool sameModel(const Model& a, const Model& b){
+	if(a.name != b.name || a.texture.file != b.texture.file || a.transform != b.transform) return false;
+	if(!sameColor(a.material.diffuse, b.material.diffuse) || a.meshes.size() != b.meshes.size()) return false;
+	for(std::size_t i=0;i<a.meshes.size();i++){
+		const Mesh& x = a.meshes[i]; const Mesh& y = b.meshes[i];
+		if(x.vertexCount() != y.vertexCount() || x.indexCount() != y.indexCount()) return false;
+		if(x.vertexCount() && std::memcmp(x.vertexData(), y.vertexData(), x.vertexCount() * sizeof(Vec3)) != 0) return false;
+		if(x.indexCount() && std::memcmp(x.indexData(), y.indexData(), x.indexCount() * sizeof(unsigned)) != 0) return false;
+	}
+	return true;
+}
+
+bool sameLight(const Light& a, const Light& b){
+	return a.type == b.type && sameVec(a.position, b.position) && sameVec(a.direction, b.direction)
+	    && sameColor(a.color, b.color) && a.intensity == b.intensity;
+}
+}
+
+AssetWatcher::AssetWatcher(QObject* parent):QThread(parent){
+	debounce.setSingleShot(true);
+	debounce.setInterval(kDebounceMs);
+	connect(&watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString& path){
+		changedPaths.insert(path);
+		debounce.start(); // restarted by every change, so a burst is handled once it settles
+	});
+	connect(&debounce, &QTimer::timeout, this, &AssetWatcher::dispatch);
+}
+
+AssetWatcher::~AssetWatcher(){
+	quitting.store(true);
+	{ QMutexLocker lock(&mutex); jobs.clear(); }
+	wait();
+}
+
+void AssetWatcher::sync(const Scene& s){
+	scene = &s;
+	scenePath = QString::fromStdString(s.attachedFile());
+	QSet<QString> wanted;
+	if(!scenePath.isEmpty()) wanted.insert(scenePath);
+	for(const auto& m : s.models) if(m && !m->texture.file.empty()) wanted.insert(QString::fromStdString(m->texture.file));
+	for(auto it = sources.begin(); it != sources.end(); ){
+		auto& ids = it->second;
+		ids.erase(std::remove_if(ids.begin(), ids.end(), [&](std::uint32_t id){ return !s.findModel(id); }), ids.end());
+		if(ids.empty()) it = sources.erase(it);
+		else { wanted.insert(it->first); ++it; }
+	}
+	const QStringList current = watcher.files();
+	for(const QString& p : current) if(!wanted.contains(p)) watcher.removePath(p);
+	for(const QString& p : wanted) if(!current.contains(p) && QFileInfo::exists(p)) watcher.addPath(p);
+}
+
+void AssetWatcher::setSourceModels(const QString& source, std::vector<std::uint32_t> ids){
+	if(ids.empty()) sources.erase(source);
+	else sources[source] = std::move(ids);
+}
+
+std::vector<std::uint32_t> AssetWatcher::sourceModels(const QString& source) const{
+	auto it = sources.find(source);
+	return it == sources.end() ? std::vector<std::uint32_t>() : it->second;
+}
+
+void AssetWatcher::noteOwnWrite(const QString& path){
+	const QFileInfo fi(path);
+	if(fi.exists()) ownWrites.insert(path, qMakePair(fi.lastModified(), fi.size()));
+}
+
+bool AssetWatcher::takeReload(Reload& out){
+	QMutexLocker lock(&mutex);
+	if(results.empty()) return false;
+	out = std::move(results.front());
+	results.pop_front();
+	return true;
+}
+
+void AssetWatcher::dispatch(){
+	const QSet<QString> paths = changedPaths;
+	changedPaths.clear();
+	for(const QString& path : paths){
+		const QFileInfo fi(path);
+		if(!fi.exists()){
+			// Saved by replacing the file: try again once the new one is in place
+			if(++missingRetries[path] <= kMissingRetries){ changedPaths.insert(path); debounce.start(); }
+			else missingRetries.remove(path);
+			continue;
+		}
+		missingRetries.remove(path);
+		// A replaced file drops out of the watcher
+		if(!watcher.files().contains(path)) watcher.addPath(path);
+		auto own = ownWrites.find(path);
+		if(own != ownWrites.end()){
+			const bool ours = own->first == fi.lastModified() && own->second == fi.size();
+			ownWrites.erase(own);
+			if(ours) continue;
+		}
+		Job job;
+		job.path = path;
+		if(path == scenePath){
+			if(!scene) continue;
+			job.kind = Reload::Kind::Scene;
+			job.snapshot = scene->snapshot();
+			job.sceneVersion = scene->version();
+		} else job.kind = sources.count(path) ? Reload::Kind::Source : Reload::Kind::Texture;
+		enqueue(std::move(job));
+	}
+}
+
+void AssetWatcher::enqueue(Job job){
+	QMutexLocker lock(&mutex);
+	jobs.push_back(std::move(job));
+	if(running) return;
+	running = true;
+	lock.unlock();
+	wait(); // the last run may still be returning
+	start();
+}
+
+void AssetWatcher::run(){
+	while(!quitting.load()){
+		Job job;
+		{
+			QMutexLocker lock(&mutex);
+			if(jobs.empty()){ running = false; return; }
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		Reload r;
+		r.kind = job.kind; r.path = job.path;
+		bool ok = false;
+		switch(job.kind){
+		case Reload::Kind::Texture: r.image = QImage(job.path); ok = !r.image.isNull(); break;
+		case Reload::Kind::Source: ok = modelManager.importModels(job.path.toStdString(), r.models) && !r.models.empty(); break;
+		case Reload::Kind::Scene: ok = readScene(job, r); break;
+		}
+		// Unreadable (e.g. still being written): the writer's next change brings it back
+		if(!ok) continue;
+		{ QMutexLocker lock(&mutex); results.push_back(std::move(r)); }
+		QMetaObject::invokeMethod(this, [this]{ emit reloadReady(); }, Qt::QueuedConnection);
+	}
+	QMutexLocker lock(&mutex);
+	running = false;
+}
+
+bool AssetWatcher::readScene(const Job& job, Reload& out){
+	std::vector<std::unique_ptr<Light>> lights;
+	std::vector<std::unique_ptr<Model>> models;
+	const bool ok = Scene::streamFromFile(job.path.toStdString(), [&](Scene::LoadBatch& batch){
+		for(auto& l : batch.lights) lights.push_back(std::move(l));
+		for(auto& m : batch.models) models.push_back(std::move(m));
+		return !quitting.load();
+	});
+	if(!ok || quitting.load()) return false;
+	const Scene& old = *job.snapshot;
+	bool any = models.size() != old.models.size() || lights.size() != old.lights.size();
+	out.changed.assign(models.size(), 1);
+	for(std::size_t i=0;i<models.size() && i<old.models.size();i++){
+		out.changed[i] = old.models[i] && sameModel(*models[i], *old.models[i]) ? 0 : 1;
+		any = any || out.changed[i];
+	}
+	out.lightsChanged = lights.size() != old.lights.size();
+	for(std::size_t i=0;i<lights.size() && !out.lightsChanged;i++) out.lightsChanged = !old.lights[i] || !sameLight(*lights[i], *old.lights[i]);
+	any = any || out.lightsChanged;
+	if(!any) return false; // e.g. our own save
+	out.models = std::move(models);
+	out.lights = std::move(lights);
+	out.sceneVersion = job.sceneVersion;
+	return true;
+}
@@ -0,0 +1,83 @@
+#ifndef ASSETWATCHER_H
+#define ASSETWATCHER_H
+#include <QThread>
+#include <QMutex>
+#include <QString>
+#include <QImage>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+#include "../core/include/Scene.h"
+#include "../modules/ModelManager/include/ModelManager.h"
+// Hot reload: watches the files behind the open scene (the scene file, model textures and the
+// sources of imported models). Once a burst of changes settles, each changed file is re-read on
+// this thread and queued for the GUI thread, which swaps in just that asset. A changed scene
+// file is compared with a snapshot of the scene, so only the models that differ come back.
+class AssetWatcher : public QThread {
+    Q_OBJECT
+public:
+    struct Reload {
+        enum class Kind { Texture, Source, Scene };
+        Kind kind{Kind::Texture};
+        QString path;
+        QImage image;                               // Texture: decoded here
+        std::vector<std::unique_ptr<Model>> models; // Source: the re-import; Scene: the file's models
+        std::vector<std::unique_ptr<Light>> lights; // Scene
+        std::vector<char> changed;                  // Scene: per model, differs from the scene
+        bool lightsChanged{false};
+        std::uint64_t sceneVersion{0};              // Scene: version of the scene it was compared with
+    };
+    static constexpr int kDebounceMs = 300;
+    explicit AssetWatcher(QObject* parent=nullptr);
+    ~AssetWatcher() override;
+    // Used for re-imports (e.g. to share the cooked-asset cache)
+    ModelManager& importer() { return modelManager; }
+    // Re-reads the watch list: the scene's file, its textures and the sources of models still in it
+    void sync(const Scene& scene);
+    // Models 'ids' were imported from 'source'
+    void setSourceModels(const QString& source, std::vector<std::uint32_t> ids);
+    std::vector<std::uint32_t> sourceModels(const QString& source) const;
+    // The file as it is now was written by us: not reported as a change
+    void noteOwnWrite(const QString& path);
+    // GUI side: next finished reload, if any
+    bool takeReload(Reload& out);
+signals:
+    void reloadReady();
+protected:
+    void run() override;
+private:
+    struct Job {
+        Reload::Kind kind{Reload::Kind::Texture};
+        QString path;
+        std::shared_ptr<const Scene> snapshot; // Scene jobs
+        std::uint64_t sceneVersion{0};
+    };
+    void dispatch();
+    void enqueue(Job job);
+    bool readScene(const Job& job, Reload& out);
+    // GUI thread
+    QFileSystemWatcher watcher;
+    QTimer debounce;
+    QSet<QString> changedPaths;
+    QHash<QString, int> missingRetries; // files caught mid-replace
+    QHash<QString, QPair<QDateTime, qint64>> ownWrites;
+    std::map<QString, std::vector<std::uint32_t>> sources;
+    const Scene* scene{nullptr};
+    QString scenePath;
+    // Shared with the worker
+    QMutex mutex;
+    std::deque<Job> jobs;
+    std::deque<Reload> results;
+    bool running{false};
+    std::atomic<bool> quitting{false};
+    ModelManager modelManager; // only used by the worker once set up
+};
+#endif // ASSETWATCHER_H
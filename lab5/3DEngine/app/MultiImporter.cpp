@@ -0,0 +1,120 @@
+#include "MultiImporter.h"
+#include "../modules/ModelManager/include/ModelManager.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+namespace {
+void hashTextures(const QStringList& paths, QHash<QString, QByteArray>& keys){
+	for(const QString& p : paths){
+		if(keys.contains(p)) continue;
+		QFile f(p);
+		if(!f.open(QIODevice::ReadOnly)) continue;
+		QCryptographicHash h(QCryptographicHash::Md5);
+		if(h.addData(&f)) keys.insert(p, h.result());
+	}
+}
+}
+
+MultiImporter::MultiImporter(QObject* parent):QObject(parent){}
+
+MultiImporter::~MultiImporter(){
+	cancel();
+	pool.waitForDone();
+}
+
+void MultiImporter::import(const QStringList& files, const QStringList& knownTextures){
+	cancel();
+	current = std::make_shared<Batch>();
+	Batch& b = *current;
+	b.cacheDir = cacheDir;
+	b.known = knownTextures;
+	b.results.resize(static_cast<std::size_t>(files.size()));
+	for(int i=0;i<files.size();i++) b.results[static_cast<std::size_t>(i)].path = files[i];
+	b.textureKeys.assign(b.results.size() + 1, {});
+	b.remaining.store(files.size() + 1);
+	running = true;
+	const unsigned id = job;
+	std::shared_ptr<Batch> batch = current;
+	for(int i=0;i<files.size();i++) pool.start([this, batch, i, id]{ read(*batch, i); finishOne(*batch, id); });
+	pool.start([this, batch, id]{ hashTextures(batch->known, batch->textureKeys.back()); finishOne(*batch, id); });
+}
+
+void MultiImporter::cancel(){
+	++job;
+	running = false;
+	if(!current) return;
+	current->cancelRequested.store(true);
+	current.reset();
+}
+
+void MultiImporter::read(Batch& batch, int index){
+	Result& r = batch.results[static_cast<std::size_t>(index)];
+	const QFileInfo info(r.path);
+	const QString suffix = info.suffix().toLower();
+	std::string error;
+	if(suffix == "scene" || suffix == "sceneb"){
+		r.ok = Scene::streamFromFile(r.path.toStdString(), [&](Scene::LoadBatch& loaded){
+			for(auto& l : loaded.lights) r.lights.push_back(std::move(l));
+			for(auto& m : loaded.models) r.models.push_back(std::move(m));
+			return !batch.cancelRequested.load();
+		}) && !batch.cancelRequested.load();
+	} else if(!batch.cancelRequested.load()){
+		ModelManager importer; // per file: the importers keep no shared state
+		importer.setCacheDirectory(batch.cacheDir);
+		r.ok = importer.importModels(r.path.toStdString(), r.models, &error);
+	}
+	if(!r.ok){
+		r.error = error.empty() ? tr("unreadable file") : QString::fromStdString(error);
+		r.lights.clear(); r.models.clear();
+		return;
+	}
+	// Texture paths written relative to the file are made absolute, and every path canonical,
+	// so one image reached two ways is one texture
+	QStringList textures;
+	for(auto& m : r.models){
+		if(!m || m->texture.file.empty()) continue;
+		QString tex = QString::fromStdString(m->texture.file);
+		if(QFileInfo(tex).isRelative() && !QFileInfo::exists(tex) && QFileInfo::exists(info.dir().filePath(tex))) tex = info.dir().filePath(tex);
+		const QString canonical = QFileInfo(tex).canonicalFilePath();
+		if(!canonical.isEmpty()) tex = canonical;
+		m->texture.file = tex.toStdString();
+		textures << tex;
+	}
+	if(!batch.cancelRequested.load()) hashTextures(textures, batch.textureKeys[static_cast<std::size_t>(index)]);
+}
+
+void MultiImporter::finishOne(Batch& batch, unsigned id){
+	const int total = static_cast<int>(batch.results.size()) + 1;
+	const int left = batch.remaining.fetch_sub(1) - 1;
+	QMetaObject::invokeMethod(this, [this, id, total, left]{
+		if(id != job) return;
+		emit progressChanged(total - left, total);
+		if(!left) emit finished();
+	}, Qt::QueuedConnection);
+}
+
+std::vector<MultiImporter::Result> MultiImporter::takeResults(){
+	std::vector<Result> out;
+	if(!running || !current || current->remaining.load() != 0) return out;
+	Batch& b = *current;
+	// The first file (the scene's own textures first of all) to bring an image names it for all
+	QHash<QByteArray, QString> byContent;
+	for(auto it = b.textureKeys.back().cbegin(); it != b.textureKeys.back().cend(); ++it) if(!byContent.contains(it.value())) byContent.insert(it.value(), it.key());
+	for(std::size_t i=0;i<b.results.size();i++){
+		for(auto& m : b.results[i].models){
+			if(!m || m->texture.file.empty()) continue;
+			const QString tex = QString::fromStdString(m->texture.file);
+			const auto key = b.textureKeys[i].constFind(tex);
+			if(key == b.textureKeys[i].cend()) continue;
+			const auto first = byContent.constFind(key.value());
+			if(first == byContent.cend()) byContent.insert(key.value(), tex);
+			else m->texture.file = first.value().toStdString();
+		}
+	}
+	out = std::move(b.results);
+	current.reset();
+	running = false;
+	return out;
+}
@@ -0,0 +1,66 @@
+#ifndef MULTIIMPORTER_H
+#define MULTIIMPORTER_H
+#include <QObject>
+#include <QThreadPool>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QByteArray>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../core/include/Scene.h"
+// Reads many scene and model files at once, one per pool thread, so the whole import takes
+// about as long as its slowest file. The GUI thread merges the results (Scene::merge) in the
+// order the files were given. Texture files are keyed by content as they are read, so copies
+// of one image in different folders end up as one texture.
+class MultiImporter : public QObject {
+    Q_OBJECT
+public:
+    struct Result {
+        QString path;
+        bool ok{false};
+        QString error;
+        std::vector<std::unique_ptr<Light>> lights;
+        std::vector<std::unique_ptr<Model>> models;
+    };
+    explicit MultiImporter(QObject* parent=nullptr);
+    // Waits for the pool, cancelled imports included
+    ~MultiImporter() override;
+    // Model files are imported through this cache directory (ModelManager::setCacheDirectory)
+    void setCacheDirectory(const std::string& dir){ cacheDir = dir; }
+    // Cancels any import still running. 'knownTextures' are the texture files already in the
+    // scene; a new texture with the same content is pointed at them.
+    void import(const QStringList& files, const QStringList& knownTextures);
+    // Drops the running import's results; no signals follow. Doesn't wait: its files stop at
+    // their next batch (scene files) or once read (models) and are thrown away.
+    void cancel();
+    bool busy() const { return running; }
+    // GUI side, after finished(): one result per file, in order, with texture paths resolved
+    std::vector<Result> takeResults();
+signals:
+    void progressChanged(int done, int total);
+    void finished();
+private:
+    // One per import, shared with its pool tasks, so tasks of a cancelled import never
+    // touch the next one's results
+    struct Batch {
+        std::string cacheDir;
+        QStringList known;
+        // Sized before the pool starts and left alone by the GUI thread until it is done
+        std::vector<Result> results;
+        std::vector<QHash<QString, QByteArray>> textureKeys; // texture file -> content hash, per file; the last entry is 'known'
+        std::atomic<int> remaining{0};
+        std::atomic<bool> cancelRequested{false};
+    };
+    // Pool side: fills results[index] / textureKeys[index] only
+    static void read(Batch& batch, int index);
+    void finishOne(Batch& batch, unsigned id);
+    QThreadPool pool;
+    std::string cacheDir;
+    std::shared_ptr<Batch> current;
+    bool running{false};
+    unsigned job{0}; // bumped on every import/cancel so stale queued signals are dropped
+};
+#endif // MULTIIMPORTER_H
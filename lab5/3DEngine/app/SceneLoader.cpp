@@ -0,0 +1,64 @@
+#include "SceneLoader.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+SceneLoader::SceneLoader(QObject* parent):QObject(parent){}
+
+SceneLoader::~SceneLoader(){
+	cancel();
+	for(QThread* t : threads){ t->wait(); delete t; }
+}
+
+void SceneLoader::load(const QString& path){
+	cancel();
+	file = path;
+	current = std::make_shared<Task>();
+	current->path = path.toStdString();
+	running = true;
+	const unsigned id = job;
+	std::shared_ptr<Task> task = current;
+	QThread* thread = QThread::create([this, task, id]{ run(task, id); });
+	threads.push_back(thread);
+	connect(thread, &QThread::finished, this, [this, thread]{
+		threads.erase(std::remove(threads.begin(), threads.end(), thread), threads.end());
+		thread->deleteLater();
+	});
+	thread->start();
+}
+
+void SceneLoader::cancel(){
+	++job;
+	running = false;
+	if(!current) return;
+	current->cancelRequested.store(true);
+	current.reset();
+}
+
+bool SceneLoader::takeBatch(Scene::LoadBatch& out){
+	if(!current) return false;
+	QMutexLocker lock(&current->mutex);
+	if(current->batches.empty()) return false;
+	out = std::move(current->batches.front());
+	current->batches.pop_front();
+	return true;
+}
+
+void SceneLoader::run(const std::shared_ptr<Task>& task, unsigned id){
+	// Load thread: touches only 'task'; 'job' is read back on the GUI thread
+	const bool ok = Scene::streamFromFile(task->path, [this, &task, id](Scene::LoadBatch& batch){
+		if(task->cancelRequested.load()) return false;
+		const int percent = static_cast<int>(batch.progress * 100.f + 0.5f);
+		{ QMutexLocker lock(&task->mutex); task->batches.push_back(std::move(batch)); }
+		QMetaObject::invokeMethod(this, [this, id, percent]{
+			if(id != job) return;
+			emit progressChanged(percent);
+			emit batchReady();
+		}, Qt::QueuedConnection);
+		return !task->cancelRequested.load();
+	});
+	QMetaObject::invokeMethod(this, [this, id, ok]{
+		if(id != job) return;
+		running = false;
+		emit loadFinished(ok);
+	}, Qt::QueuedConnection);
+}
@@ -0,0 +1,49 @@
+#ifndef SCENELOADER_H
+#define SCENELOADER_H
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "../core/include/Scene.h"
+// Loads a scene file on its own thread (Scene::streamFromFile) and queues the batches for
+// the GUI thread, which moves them into the live Scene while the rest is still loading.
+// Signals are emitted on the GUI thread and only for the current load.
+class SceneLoader : public QObject {
+    Q_OBJECT
+public:
+    explicit SceneLoader(QObject* parent=nullptr);
+    // Waits for every load thread, cancelled ones included
+    ~SceneLoader() override;
+    // Cancels any load still running
+    void load(const QString& path);
+    // Stops the running load and drops batches not taken yet; no signals follow. Doesn't
+    // wait: the thread stops at its next batch and its results are thrown away.
+    void cancel();
+    bool busy() const { return running; }
+    const QString& path() const { return file; }
+    // GUI side: next queued batch, if any
+    bool takeBatch(Scene::LoadBatch& out);
+signals:
+    void batchReady();
+    void progressChanged(int percent);
+    void loadFinished(bool ok);
+private:
+    // One per load, shared with its thread, so a cancelled thread never sees the next load's state
+    struct Task {
+        std::string path;
+        QMutex mutex;
+        std::deque<Scene::LoadBatch> batches;
+        std::atomic<bool> cancelRequested{false};
+    };
+    void run(const std::shared_ptr<Task>& task, unsigned id);
+    QString file;
+    std::shared_ptr<Task> current;
+    std::vector<QThread*> threads; // not finished yet, cancelled ones included
+    bool running{false};
+    unsigned job{0}; // bumped on every load/cancel so stale queued signals are dropped
+};
+#endif // SCENELOADER_H
@@ -0,0 +1,37 @@
+#include "SceneSaver.h"
+
+SceneSaver::SceneSaver(QObject* parent):QThread(parent){}
+
+// A save is never abandoned halfway; closing waits for it
+SceneSaver::~SceneSaver(){ wait(); }
+
+bool SceneSaver::save(std::unique_ptr<Scene> s, const QString& path, const Scene::SaveOptions& saveOptions){
+	if(pending) return false;
+	options = saveOptions;
+	return begin(std::move(s), path, false);
+}
+
+bool SceneSaver::compact(std::unique_ptr<Scene> s, const QString& path){
+	return !pending && begin(std::move(s), path, true);
+}
+
+bool SceneSaver::begin(std::unique_ptr<Scene> s, const QString& path, bool compact){
+	if(pending || !s) return false;
+	wait();
+	snapshot = std::move(s);
+	file = path;
+	compactOnly = compact;
+	pending = true;
+	QThread::start();
+	return true;
+}
+
+void SceneSaver::run(){
+	// Members are only written by the GUI thread while no save is pending
+	const std::string target = file.toStdString();
+	const bool ok = compactOnly ? snapshot->compactFile(target) : snapshot->saveToFile(target, options);
+	QMetaObject::invokeMethod(this, [this, ok]{
+		pending = false;
+		emit saveFinished(ok);
+	}, Qt::QueuedConnection);
+}
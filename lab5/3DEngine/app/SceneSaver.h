@@ -0,0 +1,35 @@
+#ifndef SCENESAVER_H
+#define SCENESAVER_H
+#include <QThread>
+#include <QString>
+#include <memory>
+#include "../core/include/Scene.h"
+// Writes a Scene::snapshot() on its own thread so the GUI keeps rendering and editing
+// meanwhile. One save at a time; saveFinished is emitted on the GUI thread.
+class SceneSaver : public QThread {
+    Q_OBJECT
+public:
+    explicit SceneSaver(QObject* parent=nullptr);
+    ~SceneSaver() override;
+    // Full save with 'options'; false if a save is still running
+    bool save(std::unique_ptr<Scene> snapshot, const QString& path, const Scene::SaveOptions& options);
+    // Scene::compactFile on the snapshot
+    bool compact(std::unique_ptr<Scene> snapshot, const QString& path);
+    bool busy() const { return pending; }
+    bool compacting() const { return compactOnly; }
+    const QString& path() const { return file; }
+    // GUI side, once finished: the snapshot that was written (for Scene::adoptSave)
+    std::unique_ptr<Scene> takeSnapshot(){ return std::move(snapshot); }
+signals:
+    void saveFinished(bool ok);
+protected:
+    void run() override;
+private:
+    bool begin(std::unique_ptr<Scene> s, const QString& path, bool compact);
+    QString file;
+    std::unique_ptr<Scene> snapshot;
+    Scene::SaveOptions options;
+    bool compactOnly{false};
+    bool pending{false}; // from start until saveFinished was delivered
+};
+#endif // SCENESAVER_H
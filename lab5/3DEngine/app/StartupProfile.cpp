@@ -0,0 +1,83 @@
+#include "StartupProfile.h"
+#include <QDebug>
+#include <QString>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+// Dynamic initialization runs before main(), which is as close to process start as we get portably
+const Clock::time_point processStart = Clock::now();
+struct Step { const char* name; double ms; };
+std::mutex stepsLock;
+std::vector<Step> steps;
+unsigned reached = 0;
+constexpr unsigned kAllMilestones = StartupProfile::WindowShown | StartupProfile::FirstFrame | StartupProfile::SceneReady;
+
+const char* milestoneName(StartupProfile::Milestone m){
+	switch(m){
+	case StartupProfile::WindowShown: return "window shown";
+	case StartupProfile::FirstFrame: return "first frame";
+	case StartupProfile::SceneReady: return "scene ready";
+	}
+	return "?";
+}
+
+// Caller holds stepsLock
+bool addStep(const char* name, double ms){
+	for(const auto& s : steps) if(std::strcmp(s.name, name) == 0) return false;
+	steps.push_back({name, ms});
+	return true;
+}
+
+double stepMs(const char* name){
+	for(const auto& s : steps) if(std::strcmp(s.name, name) == 0) return s.ms;
+	return -1.0;
+}
+}
+
+namespace StartupProfile {
+
+void mark(const char* name){
+	const double ms = std::chrono::duration<double, std::milli>(Clock::now() - processStart).count();
+	std::lock_guard<std::mutex> g(stepsLock);
+	if(reached != kAllMilestones) addStep(name, ms);
+}
+
+void reach(Milestone m){
+	const double ms = std::chrono::duration<double, std::milli>(Clock::now() - processStart).count();
+	double windowMs = 0.0;
+	{
+		std::lock_guard<std::mutex> g(stepsLock);
+		if(reached & m) return;
+		addStep(milestoneName(m), ms);
+		reached |= m;
+		if(reached != kAllMilestones) return;
+		windowMs = stepMs(milestoneName(WindowShown));
+	}
+	qInfo().noquote() << QString::fromStdString(report());
+	if(windowMs > kWindowBudgetMs) qWarning("Startup: window shown after %.1f ms (budget %.0f ms)", windowMs, kWindowBudgetMs);
+}
+
+bool complete(){
+	std::lock_guard<std::mutex> g(stepsLock);
+	return reached == kAllMilestones;
+}
+
+std::string report(){
+	std::lock_guard<std::mutex> g(stepsLock);
+	std::string out = "Startup (ms since process start, +since previous step)\n";
+	double prev = 0.0;
+	char line[128];
+	for(const auto& s : steps){
+		std::snprintf(line, sizeof(line), "%9.1f  +%8.1f  %s\n", s.ms, s.ms - prev, s.name);
+		out += line;
+		prev = s.ms;
+	}
+	return out;
+}
+
+}
@@ -0,0 +1,16 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+#include <string>
+// Startup timeline in ms since process start: named steps from main() through the window
+// being shown and the first rendered frame to the default scene being ready.
+// Thread-safe; only the first mark of each name is kept. Once all milestones are in, the
+// report is logged (with a warning if the window missed its budget).
+namespace StartupProfile {
+constexpr double kWindowBudgetMs = 200.0;
+enum Milestone : unsigned { WindowShown = 1u << 0, FirstFrame = 1u << 1, SceneReady = 1u << 2 };
+void mark(const char* name);
+void reach(Milestone m);
+bool complete();
+std::string report();
+}
+#endif // STARTUPPROFILE_H
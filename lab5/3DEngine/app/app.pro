@@ -10,10 +10,24 @@ INCLUDEPATH += $$PWD/../core/include \
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
-    widgets/SceneViewWidget.cpp
+    AllocationCounter.cpp \
+    SceneLoader.cpp \
+    SceneSaver.cpp \
+    AssetWatcher.cpp \
+    MultiImporter.cpp \
+    StartupProfile.cpp \
+    widgets/SceneViewWidget.cpp \
+    widgets/RenderThread.cpp
 HEADERS += \
     mainwindow.h \
-    widgets/SceneViewWidget.h
+    AllocationCounter.h \
+    SceneLoader.h \
+    SceneSaver.h \
+    AssetWatcher.h \
+    MultiImporter.h \
+    StartupProfile.h \
+    widgets/SceneViewWidget.h \
+    widgets/RenderThread.h
 FORMS += \
     mainwindow.ui
 CONFIG(debug, debug|release) {
@@ -4,13 +4,42 @@
 #include <QStringList>
 #include <QFileInfo>
 #include <QIcon>
+#include <QSettings>
+#include <QSurfaceFormat>
+#include <cstring>
+#include <cstdio>
+#include "../core/include/Scene.h"
+#include "../core/include/JobSystem.h"
+#include "../modules/ModelManager/include/ModelManager.h"
+#include "../modules/RenderModule/include/Renderer.h"
+#include "StartupProfile.h"
 
 int main(int argc, char *argv[]) {
+    StartupProfile::mark("main");
+    // 3DEngine --convert in.scene out.sceneb (either direction): no window, just convert
+    if(argc == 4 && std::strcmp(argv[1], "--convert") == 0){
+        Scene scene;
+        if(!scene.loadFromFile(argv[2])){ std::fprintf(stderr, "Cannot read %s\n", argv[2]); return 1; }
+        if(!scene.saveToFile(argv[3])){ std::fprintf(stderr, "Cannot write %s\n", argv[3]); return 1; }
+        return 0;
+    }
+    // One job pool: the modules get the app's, so Frame Statistics sees all of their work
+    ModelManager::shareJobSystem(JobSystem::instance());
+    Renderer::shareJobSystem(JobSystem::instance());
+    QCoreApplication::setOrganizationName("KNTU");
+    QCoreApplication::setApplicationName("3DEngine");
+    // Swap interval has to be chosen before any GL surface exists
+    QSurfaceFormat fmt = QSurfaceFormat::defaultFormat();
+    fmt.setSwapInterval(QSettings().value("view/vsync", true).toBool() ? 1 : 0);
+    QSurfaceFormat::setDefaultFormat(fmt);
     QApplication a(argc, argv);
     a.setWindowIcon(QIcon(":/icons/app_icon.png"));
+    StartupProfile::mark("QApplication created");
     MainWindow w;
+    StartupProfile::mark("main window constructed");
     QStringList args = a.arguments();
     if(args.size() > 1){ QString sceneFile = args.at(1); if(QFileInfo::exists(sceneFile)) w.loadSceneFile(sceneFile); }
     w.show();
+    StartupProfile::reach(StartupProfile::WindowShown);
     return a.exec();
 }
@@ -13,6 +13,20 @@
 #include <QtMath>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QSettings>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QListWidget>
+#include <QCheckBox>
+#include <QStatusBar>
+#include <QProgressBar>
+#include <QToolButton>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include "StartupProfile.h"
+#include "../core/include/SceneIndex.h"
+#include "../core/include/JobSystem.h"
 
 namespace {
 struct Basis { QVector3D f, r, u; };
@@ -137,6 +151,12 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     cameraController.setCamera(&scene.camera);
     cameraController.setInitialPosition(4, 3, 4, -135.0f, -20.0f, 60.0f);
     cameraController.reset();
+    // Imported models are cooked once and reused while the file is unchanged
+    const QString cacheRoot = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if(!cacheRoot.isEmpty()) modelManager.setCacheDirectory(QDir(cacheRoot).filePath("cooked").toStdString());
+    watcher.importer().setCacheDirectory(modelManager.cacheDirectory());
+    importer.setCacheDirectory(modelManager.cacheDirectory());
+    connect(&watcher, &AssetWatcher::reloadReady, this, &MainWindow::applyReloads);
     
     // Make view fill entire placeholder
     auto* layout = new QVBoxLayout(ui->sceneViewPlaceholder);
@@ -146,40 +166,128 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     // Raise labels to appear on top of view
     ui->labelFPS->raise();
     ui->labelZoom->raise();
+    ui->labelResolution->raise();
+    ui->labelResolution->hide();
     
     // Connect FPS and Zoom updates
     connect(view, &SceneViewWidget::fpsChanged, this, &MainWindow::updateFPSLabel);
     connect(view, &SceneViewWidget::fovChanged, this, &MainWindow::updateZoomLabel);
+    connect(view, &SceneViewWidget::resolutionScaleChanged, this, &MainWindow::updateResolutionLabel);
     float initialZoom = 60.0f / scene.camera.fov;
     ui->labelZoom->setText(QString("Zoom: x%1").arg(initialZoom, 0, 'f', 1));
 
-    const auto def = findDefaultScenePath();
-    if(!def.isEmpty()) loadSceneFile(def);
-    if(scene.models.empty()){
-        addTriangleSample(scene);
-        view->update();
-    }
+    // Background loading: progress and a cancel button live in the status bar
+    loadProgress = new QProgressBar(this);
+    loadProgress->setRange(0, 100);
+    loadProgress->setMaximumWidth(160);
+    loadProgress->hide();
+    loadCancel = new QToolButton(this);
+    loadCancel->setText(tr("Cancel"));
+    loadCancel->setToolTip(tr("Stop loading; models already shown are kept"));
+    loadCancel->hide();
+    statusBar()->addPermanentWidget(loadProgress);
+    statusBar()->addPermanentWidget(loadCancel);
+    connect(loadCancel, &QToolButton::clicked, this, &MainWindow::cancelSceneLoad);
+    connect(&loader, &SceneLoader::batchReady, this, &MainWindow::applyLoadedBatches);
+    connect(&loader, &SceneLoader::progressChanged, loadProgress, &QProgressBar::setValue);
+    connect(&loader, &SceneLoader::loadFinished, this, &MainWindow::finishSceneLoad);
+    connect(&saver, &SceneSaver::saveFinished, this, &MainWindow::finishSceneSave);
+    connect(&importer, &MultiImporter::progressChanged, this, [this](int done, int total){
+        statusBar()->showMessage(tr("Importing... %1/%2").arg(done).arg(total));
+    });
+    connect(&importer, &MultiImporter::finished, this, &MainWindow::finishImport);
+
+    // Nothing scene-related blocks the first frame: the default scene is looked up once the event
+    // loop runs (unless a file was passed on the command line) and loads in the background.
+    // A sample fills the view if startup ends without models.
+    sampleIfEmpty = true;
+    QTimer::singleShot(0, this, [this]{
+        if(!defaultScenePending) return;
+        defaultScenePending = false;
+        const auto def = findDefaultScenePath();
+        StartupProfile::mark("default scene located");
+        if(!def.isEmpty()) loadSceneFile(def);
+        else endLoadProgress();
+    });
 
     connect(ui->actionLoad_scene, &QAction::triggered, this, [this]{
-        auto file = QFileDialog::getOpenFileName(this, tr("Open Scene"), QString(), tr("Scene Files (*.scene);;All Files (*.*)"));
+        auto file = QFileDialog::getOpenFileName(this, tr("Open Scene"), QString(), tr("Scene Files (*.scene *.sceneb);;All Files (*.*)"));
         if(!file.isEmpty()) loadSceneFile(file);
     });
+    connect(ui->actionLoad_models, &QAction::triggered, this, [this]{
+        auto file = QFileDialog::getOpenFileName(this, tr("Load Models"), QString(), tr("Scene Files (*.scene *.sceneb);;All Files (*.*)"));
+        if(!file.isEmpty()) loadModelsFrom(file);
+    });
+    // Many scene and model files at once, merged into the current scene
+    connect(ui->actionImport_files, &QAction::triggered, this, [this]{
+        if(importer.busy()){ statusBar()->showMessage(tr("Wait for the current import to finish"), 5000); return; }
+        const QStringList files = QFileDialog::getOpenFileNames(this, tr("Import Files"), QString(),
+            tr("Scenes and Models (*.scene *.sceneb *.glb *.gltf *.obj *.stl *.ply);;All Files (*.*)"));
+        if(files.isEmpty()) return;
+        QStringList textures;
+        for(const auto& m : scene.models) if(m && !m->texture.file.empty()) textures << QString::fromStdString(m->texture.file);
+        textures.removeDuplicates();
+        importTimer.start();
+        importer.import(files, textures);
+        statusBar()->showMessage(tr("Importing %1 files...").arg(files.size()));
+    });
     connect(ui->actionDefault_scene, &QAction::triggered, this, [this]{
+        cancelSceneLoad();
         view->clearTextures();
-        scene.models.clear();
-        scene.lights.clear();
+        scene.clear();
+        watcher.sync(scene);
         view->update();
     });
     connect(ui->actionImport_scene, &QAction::triggered, this, [this]{
-        QString path = QFileDialog::getSaveFileName(this, tr("Export Current Scene"), QString(), tr("Scene Files (*.scene);;All Files (*.*)"));
+        if(saveRunning() || pointCloudsBlockSave()) return;
+        QString filter;
+        QString path = QFileDialog::getSaveFileName(this, tr("Export Current Scene"), QString(), tr("Scene Files (*.scene);;Binary Scene Files (*.sceneb);;All Files (*.*)"), &filter);
         if(path.isEmpty()) return;
-        if(QFileInfo(path).suffix().isEmpty()) path += ".scene";
-        if(scene.saveToFile(path.toStdString())){
-            QMessageBox::information(this, tr("Scene Exported"), tr("Saved: %1").arg(QDir::toNativeSeparators(path)));
+        if(QFileInfo(path).suffix().isEmpty()) path += filter.contains("sceneb") ? ".sceneb" : ".scene";
+        // 0 writes the plain format; 1-9 wraps it in zlib-compressed chunks
+        bool ok = false;
+        const int level = QInputDialog::getInt(this, tr("Export Current Scene"), tr("Compression level (0 = none, 1-9 = zlib):"),
+                                               QSettings().value("export/compression", 0).toInt(), 0, 9, 1, &ok);
+        if(!ok) return;
+        QSettings().setValue("export/compression", level);
+        Scene::SaveOptions options;
+        options.compressionLevel = level;
+        if(path.endsWith(".sceneb", Qt::CaseInsensitive)){
+            // 0 keeps raw arrays that load straight from the mapped file; otherwise positions are
+            // quantized to the given error and indices FIFO-coded, decoded on load
+            const double error = QInputDialog::getDouble(this, tr("Export Current Scene"), tr("Geometry codec error bound (0 = raw arrays):"),
+                                                         QSettings().value("export/positionError", 0.0).toDouble(), 0.0, 1.0, 6, &ok);
+            if(!ok) return;
+            QSettings().setValue("export/positionError", error);
+            options.positionError = static_cast<float>(error);
+            options.packIndices = error > 0.0;
+        }
+        // Written from a snapshot on the saver thread; the scene stays editable meanwhile
+        saver.save(scene.snapshot(), path, options);
+        statusBar()->showMessage(tr("Saving %1...").arg(QFileInfo(path).fileName()));
+    });
+    // Save appends the edits since the last load/save to the file's journal; a scene that
+    // didn't come from a file goes through Export instead
+    connect(ui->actionSave_scene, &QAction::triggered, this, [this]{
+        if(saveRunning() || pointCloudsBlockSave()) return;
+        if(!loadCancel->isHidden()){ statusBar()->showMessage(tr("Wait for the scene to finish loading"), 5000); return; }
+        const QString path = QString::fromStdString(scene.attachedFile());
+        if(path.isEmpty()){ ui->actionImport_scene->trigger(); return; }
+        QElapsedTimer timer; timer.start();
+        if(scene.saveEdits(path.toStdString())){
+            statusBar()->showMessage(tr("Saved %1 (%2 ms)").arg(QFileInfo(path).fileName()).arg(timer.elapsed()), 5000);
         } else {
             QMessageBox::warning(this, tr("Error"), tr("Failed to save scene file."));
         }
     });
+    connect(ui->actionCompact_scene, &QAction::triggered, this, [this]{
+        if(saveRunning() || pointCloudsBlockSave()) return;
+        if(!loadCancel->isHidden()){ statusBar()->showMessage(tr("Wait for the scene to finish loading"), 5000); return; }
+        const QString path = QString::fromStdString(scene.attachedFile());
+        if(path.isEmpty()){ statusBar()->showMessage(tr("The scene has no file to compact"), 5000); return; }
+        saver.compact(scene.snapshot(), path);
+        statusBar()->showMessage(tr("Rewriting %1...").arg(QFileInfo(path).fileName()));
+    });
     connect(ui->actionReset_camera, &QAction::triggered, this, [this]{
         cameraController.reset();
         view->update();
@@ -203,6 +311,27 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         double v = QInputDialog::getDouble(this, tr("Light Intensity"), tr("Intensity (0..10)"), currentLightIntensity, 0.0, 10.0, 2, &ok);
         if(ok){ currentLightIntensity = v; }
     });
+    connect(ui->actionImport_model, &QAction::triggered, this, [this]{
+        const QString file = QFileDialog::getOpenFileName(this, tr("Import Model"), QString(), tr("Models (*.glb *.gltf *.obj *.stl *.ply);;All Files (*.*)"));
+        if(file.isEmpty()) return;
+        QElapsedTimer timer; timer.start();
+        std::string error;
+        std::vector<std::unique_ptr<Model>> models;
+        if(!modelManager.importModels(file.toStdString(), models, &error)){
+            QMessageBox::warning(this, tr("Error"), tr("Failed to import %1: %2").arg(QFileInfo(file).fileName(), QString::fromStdString(error)));
+            return;
+        }
+        int added = 0;
+        std::vector<std::uint32_t> ids;
+        for(auto& m : models) if(scene.addModel(std::move(m))){ ++added; ids.push_back(scene.models.back()->id); }
+        // Edits to the source file are re-imported into these models
+        watcher.setSourceModels(file, std::move(ids));
+        watcher.sync(scene);
+        if(added < static_cast<int>(models.size()))
+            QMessageBox::warning(this, tr("Error"), tr("The scene is full: %1 of %2 models were added.").arg(added).arg(models.size()));
+        statusBar()->showMessage(tr("Imported %1 (%2 ms)").arg(QFileInfo(file).fileName()).arg(timer.elapsed()), 5000);
+        view->update();
+    });
     connect(ui->actionChange_texture, &QAction::triggered, this, [this]{
         if(scene.models.empty()){
             QMessageBox::information(this, tr("Change Texture"), tr("No models in scene."));
@@ -225,9 +354,63 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         const QString img = QFileDialog::getOpenFileName(this, tr("Choose Texture"), QString(), tr("Images (*.png *.jpg *.jpeg *.bmp);;All Files (*.*)"));
         if(img.isEmpty()) return;
         modelManager.applyTexture(img.toStdString(), model);
+        scene.markTextureChanged(model);
+        watcher.sync(scene);
         view->update();
     });
 
+    connect(ui->actionDynamic_resolution, &QAction::toggled, this, [this](bool on){
+        view->setDynamicResolution(on);
+        ui->labelResolution->setVisible(on);
+        updateResolutionLabel(1.0f, view->targetFrameTime());
+    });
+    connect(ui->actionTarget_frame_time, &QAction::triggered, this, [this]{
+        bool ok=false;
+        double ms = QInputDialog::getDouble(this, tr("Target Frame Time"), tr("Frame time, ms (8..100)"), view->targetFrameTime(), 8.0, 100.0, 1, &ok);
+        if(!ok) return;
+        view->setTargetFrameTime(static_cast<float>(ms));
+        updateResolutionLabel(1.0f, view->targetFrameTime());
+    });
+
+    connect(ui->actionFrame_limit, &QAction::triggered, this, [this]{
+        bool ok=false;
+        int fps = QInputDialog::getInt(this, tr("Frame Limit"), tr("Max FPS (0 = unlimited)"), view->frameLimit(), 0, 240, 1, &ok);
+        if(ok) view->setFrameLimit(fps);
+    });
+    ui->actionVSync->setChecked(QSettings().value("view/vsync", true).toBool());
+    connect(ui->actionVSync, &QAction::toggled, this, [this](bool on){
+        QSettings().setValue("view/vsync", on);
+        QMessageBox::information(this, tr("VSync"), tr("VSync will be %1 after restart.").arg(on ? tr("enabled") : tr("disabled")));
+    });
+    connect(ui->actionFrame_statistics, &QAction::triggered, this, [this]{
+        const FrameStats& fs = view->frameStats();
+        const FrameStats::Report r = fs.report();
+        auto row = [](const char* name, const FrameStats::Percentiles& p){
+            return QString("%1: p50 %2  p95 %3  p99 %4  max %5 ms\n").arg(name)
+                .arg(p.p50, 0, 'f', 2).arg(p.p95, 0, 'f', 2).arg(p.p99, 0, 'f', 2).arg(p.max, 0, 'f', 2);
+        };
+        QString text = tr("Last %1 frames\n\n").arg(r.frames);
+        text += row("CPU", r.cpu);
+        text += row("Present", r.present);
+        text += tr("\nHitches (> %1 ms): %2\n").arg(fs.hitchThreshold(), 0, 'f', 0).arg(r.hitches);
+        for(const auto& h : fs.recentHitches()){
+            text += QString("  #%1  %2 ms  [%3]\n").arg(h.frame).arg(h.presentMs, 0, 'f', 1)
+                .arg(QString::fromStdString(FrameStats::eventNames(h.events)));
+        }
+        // Load, import and mesh work goes through the job pool; utilisation since last shown
+        const auto workers = JobSystem::instance().stats();
+        if(!workers.empty()) text += tr("\nJob workers:\n");
+        for(std::size_t i=0;i<workers.size();i++){
+            text += tr("  #%1  %2% busy  %3 jobs (%4 stolen)\n").arg(i)
+                .arg(workers[i].utilisation * 100.0, 0, 'f', 0).arg(workers[i].jobs).arg(workers[i].stolen);
+        }
+        JobSystem::instance().resetStats();
+        const std::string graph = view->renderGraphDump();
+        if(!graph.empty()) text += "\n" + QString::fromStdString(graph);
+        if(StartupProfile::complete()) text += "\n" + QString::fromStdString(StartupProfile::report());
+        QMessageBox::information(this, tr("Frame Statistics"), text);
+    });
+
     auto connectSamples = [this]{
         QMenuBar* mb = this->menuBar(); if(!mb) return;
         QMenu* samples = nullptr;
@@ -260,10 +443,246 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     });
 }
 
-void MainWindow::loadSceneFile(const QString& path){ 
-    view->clearTextures(); 
-    scene.loadFromFile(path.toStdString()); 
-    view->update(); 
+void MainWindow::loadSceneFile(const QString& path){
+    defaultScenePending = false;
+    // Edits to the old scene can't be saved onto its file once the new one starts replacing it
+    scene.attachFile(std::string());
+    loader.load(path);
+    clearOnFirstBatch = true;
+    statusBar()->showMessage(tr("Loading %1...").arg(QFileInfo(path).fileName()));
+    loadProgress->setValue(0);
+    loadProgress->show();
+    loadCancel->show();
+}
+
+void MainWindow::applyLoadedBatches(){
+    Scene::LoadBatch batch;
+    bool any = false;
+    while(loader.takeBatch(batch)){
+        if(clearOnFirstBatch){
+            view->clearTextures();
+            scene.clear();
+            clearOnFirstBatch = false;
+        }
+        for(auto& l : batch.lights) scene.addLight(std::move(l));
+        for(auto& m : batch.models) scene.addModel(std::move(m));
+        any = true;
+    }
+    if(!any) return;
+    StartupProfile::mark("first models shown");
+    view->frameStats().markEvent(FrameStats::SceneLoad);
+    view->update();
+}
+
+void MainWindow::finishSceneLoad(bool ok){
+    applyLoadedBatches();
+    const QString name = QFileInfo(loader.path()).fileName();
+    if(ok && clearOnFirstBatch){
+        // Valid but empty file: replace the scene all the same
+        view->clearTextures();
+        scene.clear();
+    }
+    clearOnFirstBatch = false;
+    // Later saves journal onto the file just loaded
+    if(ok) scene.attachFile(loader.path().toStdString());
+    watcher.sync(scene);
+    if(!name.isEmpty()) statusBar()->showMessage(ok ? tr("Loaded %1").arg(name) : tr("Failed to load %1").arg(name), 5000);
+    endLoadProgress();
+}
+
+void MainWindow::cancelSceneLoad(){
+    if(loadCancel->isHidden()) return;
+    loader.cancel();
+    clearOnFirstBatch = false;
+    statusBar()->showMessage(tr("Loading cancelled"), 5000);
+    endLoadProgress();
+}
+
+void MainWindow::endLoadProgress(){
+    loadProgress->hide();
+    loadCancel->hide();
+    if(sampleIfEmpty){
+        if(scene.models.empty()) addTriangleSample(scene);
+        StartupProfile::reach(StartupProfile::SceneReady);
+    }
+    sampleIfEmpty = false;
+    view->update();
+}
+
+bool MainWindow::saveRunning(){
+    if(!saver.busy()) return false;
+    statusBar()->showMessage(tr("Wait for the current save to finish"), 5000);
+    return true;
+}
+
+bool MainWindow::pointCloudsBlockSave(){
+    if(!scene.hasPointClouds()) return false;
+    // Refused up front: writing the file would drop the points without a word
+    QMessageBox::warning(this, tr("Save"), tr("The scene contains point-cloud models, which scene files can't store yet. Nothing was saved."));
+    return true;
+}
+
+void MainWindow::finishSceneSave(bool ok){
+    // Releases the snapshot's hold on the scene's geometry
+    const auto snapshot = saver.takeSnapshot();
+    const QString path = saver.path();
+    if(!ok){
+        statusBar()->clearMessage();
+        QMessageBox::warning(this, tr("Error"), tr("Failed to save scene file."));
+        return;
+    }
+    // Edits made during the save go into the journal on the next Save
+    if(snapshot) scene.adoptSave(*snapshot);
+    watcher.noteOwnWrite(path);
+    watcher.sync(scene);
+    if(saver.compacting()){
+        statusBar()->showMessage(tr("Rewrote %1").arg(QFileInfo(path).fileName()), 5000);
+    } else {
+        statusBar()->clearMessage();
+        QMessageBox::information(this, tr("Scene Exported"), tr("Saved: %1").arg(QDir::toNativeSeparators(path)));
+    }
+}
+
+void MainWindow::loadModelsFrom(const QString& path){
+    // The index lists models without touching their geometry; only the picked ones are read
+    SceneIndex index;
+    if(!index.read(path.toStdString())){
+        QMessageBox::warning(this, tr("Error"), tr("Failed to read scene index."));
+        return;
+    }
+    QDialog dlg(this);
+    dlg.setWindowTitle(tr("Load Models - %1").arg(QFileInfo(path).fileName()));
+    auto* layout = new QVBoxLayout(&dlg);
+    auto* list = new QListWidget(&dlg);
+    list->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    for(const auto& e : index.models){
+        // Where the model ends up in the scene, not its raw vertex range
+        float lo[3], hi[3];
+        e.worldBounds(lo, hi);
+        list->addItem(tr("%1  (%2 meshes, %3 vertices, %4 triangles)  [%5, %6, %7] - [%8, %9, %10]")
+            .arg(QString::fromStdString(e.name)).arg(e.meshCount).arg(e.vertexCount).arg(e.indexCount / 3)
+            .arg(lo[0], 0, 'g', 4).arg(lo[1], 0, 'g', 4).arg(lo[2], 0, 'g', 4)
+            .arg(hi[0], 0, 'g', 4).arg(hi[1], 0, 'g', 4).arg(hi[2], 0, 'g', 4));
+    }
+    auto* append = new QCheckBox(tr("Append to current scene"), &dlg);
+    append->setChecked(true);
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dlg);
+    connect(buttons, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+    layout->addWidget(list);
+    layout->addWidget(append);
+    layout->addWidget(buttons);
+    dlg.resize(640, 360);
+    if(dlg.exec() != QDialog::Accepted) return;
+    std::vector<std::size_t> which;
+    for(int row=0; row<list->count(); ++row) if(list->item(row)->isSelected()) which.push_back(static_cast<std::size_t>(row));
+    if(which.empty()) return;
+    cancelSceneLoad();
+    view->frameStats().markEvent(FrameStats::SceneLoad);
+    if(!append->isChecked()) view->clearTextures();
+    if(!scene.loadModels(path.toStdString(), which, append->isChecked()))
+        QMessageBox::warning(this, tr("Error"), tr("Failed to load models."));
+    watcher.sync(scene);
+    view->update();
+}
+
+void MainWindow::finishImport(){
+    std::vector<MultiImporter::Result> results = importer.takeResults();
+    QStringList failed;
+    std::size_t added = 0, dropped = 0;
+    for(auto& r : results){
+        if(!r.ok){ failed << tr("%1: %2").arg(QFileInfo(r.path).fileName(), r.error); continue; }
+        const std::size_t first = scene.models.size();
+        added += scene.merge(r.lights, r.models);
+        dropped += r.models.size();
+        const QString suffix = QFileInfo(r.path).suffix().toLower();
+        if(suffix == "scene" || suffix == "sceneb") continue;
+        // As with a single import, edits to a model file are re-imported into its models
+        std::vector<std::uint32_t> ids;
+        for(std::size_t i=first;i<scene.models.size();i++) ids.push_back(scene.models[i]->id);
+        watcher.setSourceModels(r.path, std::move(ids));
+    }
+    watcher.sync(scene);
+    view->frameStats().markEvent(FrameStats::SceneLoad);
+    view->update();
+    statusBar()->showMessage(tr("Imported %1 models from %2 files (%3 ms)").arg(added).arg(static_cast<int>(results.size()) - static_cast<int>(failed.size())).arg(importTimer.elapsed()), 5000);
+    if(dropped) failed.prepend(tr("The scene is full: %1 models were not added.").arg(dropped));
+    if(!failed.isEmpty()) QMessageBox::warning(this, tr("Import Files"), failed.join('\n'));
+}
+
+void MainWindow::applyReloads(){
+    AssetWatcher::Reload r;
+    bool any = false;
+    while(watcher.takeReload(r)){
+        switch(r.kind){
+        case AssetWatcher::Reload::Kind::Texture: view->replaceTexture(r.path.toStdString(), r.image); break;
+        case AssetWatcher::Reload::Kind::Source: applySourceReload(r); break;
+        case AssetWatcher::Reload::Kind::Scene: applySceneReload(r); break;
+        }
+        any = true;
+    }
+    if(!any) return;
+    watcher.sync(scene);
+    view->update();
+}
+
+void MainWindow::applySourceReload(AssetWatcher::Reload& r){
+    // The re-import replaces the models that came from this file, in order; their placement
+    // and texture are the viewer's and stay
+    auto indexOf = [this](std::uint32_t id){
+        for(std::size_t i=0;i<scene.models.size();i++) if(scene.models[i] && scene.models[i]->id == id) return i;
+        return scene.models.size();
+    };
+    std::vector<std::uint32_t> ids;
+    for(std::uint32_t id : watcher.sourceModels(r.path)) if(indexOf(id) < scene.models.size()) ids.push_back(id);
+    std::vector<std::uint32_t> kept;
+    std::size_t k = 0;
+    for(; k < ids.size() && k < r.models.size(); k++){
+        // A fresh model instead of editableModel(), which would first copy the old geometry
+        auto& slot = scene.models[indexOf(ids[k])];
+        auto m = std::make_shared<Model>();
+        m->id = slot->id; m->name = slot->name; m->material = slot->material; m->texture = slot->texture; m->transform = slot->transform;
+        Model& from = *r.models[k];
+        m->meshes = std::move(from.meshes);
+        m->points = std::move(from.points);
+        m->fileBounds = from.fileBounds; m->boundsMin = from.boundsMin; m->boundsMax = from.boundsMax;
+        slot = m; // snapshots still holding the old model keep it
+        scene.markGeometryEdited(m.get());
+        kept.push_back(ids[k]);
+    }
+    // Models the file no longer has go; new ones are added
+    for(std::size_t j=k;j<ids.size();j++) scene.removeModel(indexOf(ids[j]));
+    for(; k < r.models.size(); k++) if(scene.addModel(std::move(r.models[k]))) kept.push_back(scene.models.back()->id);
+    watcher.setSourceModels(r.path, std::move(kept));
+    statusBar()->showMessage(tr("Reloaded %1").arg(QFileInfo(r.path).fileName()), 3000);
+}
+
+void MainWindow::applySceneReload(AssetWatcher::Reload& r){
+    // Compared against the scene as it was; edits made since would be overwritten
+    if(scene.version() != r.sceneVersion || scene.attachedFile() != r.path.toStdString() || loader.busy()){
+        statusBar()->showMessage(tr("%1 changed on disk; not reloaded over newer edits").arg(QFileInfo(r.path).fileName()), 5000);
+        return;
+    }
+    const std::size_t before = scene.models.size();
+    for(std::size_t i=0;i<r.models.size() && i<before;i++){
+        if(!r.changed[i]) continue;
+        // The reloaded model takes the old one's place (and id) as is; nothing is copied
+        std::shared_ptr<Model> m(std::move(r.models[i]));
+        m->id = scene.models[i]->id;
+        scene.models[i] = m;
+        scene.markGeometryEdited(m.get());
+        scene.markTransformEdited(m.get());
+        scene.markTextureChanged(m.get());
+    }
+    while(scene.models.size() > r.models.size()) scene.removeModel(scene.models.size() - 1);
+    for(std::size_t i=before;i<r.models.size();i++) scene.addModel(std::move(r.models[i]));
+    if(r.lightsChanged){
+        while(!scene.lights.empty()) scene.removeLight(scene.lights.size() - 1);
+        for(auto& l : r.lights) scene.addLight(std::move(l));
+    }
+    // The scene mirrors the file again, so journaled saves continue from it
+    scene.attachFile(r.path.toStdString());
+    statusBar()->showMessage(tr("Reloaded %1").arg(QFileInfo(r.path).fileName()), 3000);
 }
 
 MainWindow::~MainWindow(){ delete ui; }
@@ -304,6 +723,10 @@ void MainWindow::updateFPSLabel(int fps) {
     ui->labelFPS->setText(QString("FPS: %1").arg(fps));
 }
 
+void MainWindow::updateResolutionLabel(float scale, float targetMs) {
+    ui->labelResolution->setText(QString("Res: %1% @ %2 ms").arg(qRound(scale * 100.0f)).arg(targetMs, 0, 'f', 1));
+}
+
 void MainWindow::updateZoomLabel(float fov) {
     // Default FOV is 60, calculate zoom as inverse ratio
     float zoom = 60.0f / fov;
@@ -3,12 +3,18 @@
 
 #include <QMainWindow>
 #include "widgets/SceneViewWidget.h"
+#include "SceneLoader.h"
+#include "SceneSaver.h"
+#include "AssetWatcher.h"
+#include "MultiImporter.h"
 #include "../core/include/Scene.h"
 #include "../modules/ModelManager/include/ModelManager.h"
 #include "../modules/CameraModule/include/CameraController.h"
 #include "../modules/LightModule/include/LightManager.h"
 #include <QColor>
 #include <QString>
+#include <QElapsedTimer>
+class QProgressBar; class QToolButton;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -21,14 +27,39 @@ class MainWindow : public QMainWindow {
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+    // Loads in the background; the current scene is replaced when the first models arrive
     void loadSceneFile(const QString& path);
+    void cancelSceneLoad();
+    // Lists the models in a scene file and loads/appends the chosen ones
+    void loadModelsFrom(const QString& path);
     QString findUserGuidePath() const;
 private:
     QString findDefaultScenePath() const;
+    void applyLoadedBatches();
+    void finishSceneLoad(bool ok);
+    void endLoadProgress();
+    void finishSceneSave(bool ok);
+    bool saveRunning();
+    bool pointCloudsBlockSave();
+    void applyReloads();
+    void applySourceReload(AssetWatcher::Reload& r);
+    void applySceneReload(AssetWatcher::Reload& r);
+    void finishImport();
 private:
     Ui::MainWindow *ui; 
     SceneViewWidget* view{nullptr};
     Scene scene;
+    // Declared after 'scene': destroyed (and stopped) first
+    SceneLoader loader;
+    SceneSaver saver;
+    AssetWatcher watcher;
+    MultiImporter importer;
+    QElapsedTimer importTimer;
+    bool clearOnFirstBatch{false};
+    bool sampleIfEmpty{false};
+    bool defaultScenePending{true}; // cleared once any scene load has been started
+    QProgressBar* loadProgress{nullptr};
+    QToolButton* loadCancel{nullptr};
     ModelManager modelManager;
     CameraController cameraController;
     LightManager lightManager;
@@ -37,5 +68,6 @@ private:
 private slots:
     void updateFPSLabel(int fps);
     void updateZoomLabel(float fov);
+    void updateResolutionLabel(float scale, float targetMs);
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,144 @@
+#include "RenderThread.h"
+#include "../../core/include/FrameStats.h"
+#include "../AllocationCounter.h"
+#include "../StartupProfile.h"
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <algorithm>
+
+RenderThread::RenderThread(QOpenGLContext* shareWith, FrameStats* s, QObject* parent):QThread(parent), stats(s){
+	ctx = new QOpenGLContext();
+	ctx->setFormat(shareWith->format());
+	ctx->setShareContext(shareWith);
+	ctx->create();
+	// Offscreen surfaces have to be created on the GUI thread
+	surface = new QOffscreenSurface();
+	surface->setFormat(ctx->format());
+	surface->create();
+	ctx->moveToThread(this);
+}
+
+RenderThread::~RenderThread(){
+	stop();
+	delete ctx;
+	delete surface;
+}
+
+void RenderThread::requestFrame(){
+	// Coalesce: at most one pending wake-up, the render thread always takes the newest snapshot
+	if(!frameRequested.exchange(true)) wake.release();
+}
+
+void RenderThread::requestTextureReplace(const std::string& path, const QImage& image){
+	{ QMutexLocker lock(&replaceMutex); textureReplacements.emplace_back(path, image); }
+	texturesReplaced.store(true);
+	requestFrame();
+}
+
+std::string RenderThread::renderGraphDump() const{
+	QMutexLocker lock(&graphMutex);
+	return graphText;
+}
+
+void RenderThread::stop(){
+	if(!isRunning()) return;
+	quitting.store(true);
+	wake.release();
+	wait();
+}
+
+void RenderThread::run(){
+	if(!ctx->makeCurrent(surface)) return;
+	QOpenGLExtraFunctions* f = ctx->extraFunctions();
+	{
+		// Created and destroyed here so all GL objects live and die with the context current
+		Renderer renderer;
+		renderer.initialize();
+		renderer.setFrameStats(stats);
+		StartupProfile::mark("render thread ready");
+		bool first = true;
+		while(true){
+			wake.acquire();
+			if(quitting.load()) break;
+			frameRequested.store(false);
+			renderOne(renderer, f);
+			// Includes shader compilation (or the program cache hit) and the first uploads
+			if(first){ StartupProfile::mark("first frame rendered"); first = false; }
+		}
+		renderer.clearTextures();
+		for(unsigned i=0;i<3;i++){
+			Target& t = output.slot(i);
+			if(t.renderDone) f->glDeleteSync(t.renderDone);
+			if(t.presentDone) f->glDeleteSync(t.presentDone);
+			t = Target();
+		}
+		for(unsigned i=0;i<3;i++) snapshots.slot(i) = FrameSnapshot();
+	}
+	ctx->doneCurrent();
+	ctx->moveToThread(QCoreApplication::instance()->thread());
+}
+
+void RenderThread::renderOne(Renderer& renderer, QOpenGLExtraFunctions* f){
+	snapshots.acquire(); // keep rendering the previous snapshot if nothing new arrived
+	const FrameSnapshot& snap = snapshots.readSlot();
+	if(stats) stats->beginFrame();
+	const size_t allocsBefore = AllocationCounter::thisThread();
+	bool uploaded = false;
+	if(clearTextures.exchange(false)) renderer.clearTextures();
+	if(texturesReplaced.exchange(false)){
+		std::vector<std::pair<std::string, QImage>> replacements;
+		{ QMutexLocker lock(&replaceMutex); replacements.swap(textureReplacements); }
+		for(const auto& r : replacements) renderer.replaceTexture(r.first, r.second);
+	}
+	renderer.setDynamicResolution(dynRes.load());
+	renderer.setTargetFrameTime(targetMs.load());
+
+	Target& t = output.writeSlot();
+	// The GUI may still be blitting from this texture on its side of the pipe
+	if(t.presentDone){ f->glWaitSync(t.presentDone, 0, GL_TIMEOUT_IGNORED); f->glDeleteSync(t.presentDone); t.presentDone = nullptr; }
+	const int w = std::max(1, pixelW.load()), h = std::max(1, pixelH.load());
+	if(!t.fbo || t.width != w || t.height != h){
+		QOpenGLFramebufferObjectFormat fmt;
+		fmt.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+		fmt.setInternalTextureFormat(GL_RGBA8);
+		t.fbo = std::make_unique<QOpenGLFramebufferObject>(w, h, fmt);
+		uploaded = true;
+		t.texture = t.fbo->texture();
+		t.width = w; t.height = h;
+	}
+	t.fbo->bind();
+	f->glViewport(0, 0, w, h);
+	renderer.setViewportSize(w, h);
+	renderer.setTargetFramebuffer(t.fbo.get());
+	renderer.setSnapshot(snap);
+	consumed.store(renderer.retainedVersion());
+	renderer.renderScene();
+	renderer.setTargetFramebuffer(nullptr);
+	t.fbo->release();
+	if(renderer.graphBuilds() != lastGraphBuilds){
+		// Only on rebuilds, which already count as resource changes below
+		lastGraphBuilds = renderer.graphBuilds();
+		QMutexLocker lock(&graphMutex);
+		graphText = renderer.renderGraphDump();
+	}
+
+	// Steady state = no scene edits, no new GL resources and no arena growth
+	uploaded = uploaded || renderer.resourceChanges() != lastResourceChanges || renderer.arena().heapAllocationsTotal() != arenaBlocks;
+	lastResourceChanges = renderer.resourceChanges();
+	arenaBlocks = renderer.arena().heapAllocationsTotal();
+	const bool reshaped = renderer.retainedVersion() != lastVersion;
+	lastVersion = renderer.retainedVersion();
+	steadyFrames = (reshaped || uploaded) ? 0 : steadyFrames + 1;
+	if(AllocationCounter::enabled() && steadyFrames > kWarmupFrames){
+		const size_t allocs = AllocationCounter::thisThread() - allocsBefore;
+		Q_ASSERT_X(allocs == 0, "RenderThread", "heap allocation in a steady-state frame");
+	}
+
+	if(t.renderDone) f->glDeleteSync(t.renderDone);
+	t.renderDone = f->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	f->glFlush(); // fence must reach the GPU before the other context waits on it
+	output.publish();
+	scale.store(renderer.resolutionScale());
+	framesDone.fetch_add(1);
+	if(stats) stats->endFrame();
+}
@@ -0,0 +1,88 @@
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+#include <QThread>
+#include <QSemaphore>
+#include <QMutex>
+#include <QImage>
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLExtraFunctions>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../../modules/RenderModule/include/Renderer.h"
+#include "../../core/include/FrameSnapshot.h"
+#include "../../core/include/TripleBuffer.h"
+class FrameStats;
+// Owns a GL context shared with the view and renders snapshots into offscreen targets.
+// Snapshots come in and finished frames go out through lock-free triple buffers.
+class RenderThread : public QThread {
+    Q_OBJECT
+public:
+    // A finished frame: colour texture in the shared context plus fences for both directions
+    struct Target {
+        std::unique_ptr<QOpenGLFramebufferObject> fbo;
+        GLuint texture{0};
+        int width{0}, height{0};
+        GLsync renderDone{nullptr};  // set by the render thread, waited on before presenting
+        GLsync presentDone{nullptr}; // set by the GUI, waited on before rendering into it again
+    };
+    // Must be constructed on the GUI thread while shareWith is current
+    RenderThread(QOpenGLContext* shareWith, FrameStats* stats, QObject* parent=nullptr);
+    ~RenderThread() override;
+
+    // GUI side
+    FrameSnapshot& snapshotSlot() { return snapshots.writeSlot(); }
+    void publishSnapshot() { snapshots.publish(); }
+    void requestFrame();
+    void setPixelSize(int w, int h) { pixelW.store(w); pixelH.store(h); }
+    void setDynamicResolution(bool on) { dynRes.store(on); }
+    void setTargetFrameTime(float ms) { targetMs.store(ms); }
+    float resolutionScale() const { return scale.load(); }
+    void requestClearTextures() { clearTextures.store(true); }
+    // Hot-reloaded texture, already decoded; swapped in before the next frame
+    void requestTextureReplace(const std::string& path, const QImage& image);
+    unsigned framesRendered() const { return framesDone.load(); }
+    // Frame graph as last compiled (passes, lifetimes, memory), for the statistics dialog
+    std::string renderGraphDump() const;
+    // Scene version the render thread has applied; older pending deltas can be dropped
+    std::uint64_t consumedVersion() const { return consumed.load(); }
+    TripleBuffer<Target>& frames() { return output; }
+    void stop();
+protected:
+    void run() override;
+private:
+    void renderOne(Renderer& renderer, QOpenGLExtraFunctions* f);
+    QOpenGLContext* ctx{nullptr};
+    QOffscreenSurface* surface{nullptr};
+    FrameStats* stats{nullptr};
+    TripleBuffer<FrameSnapshot> snapshots;
+    TripleBuffer<Target> output;
+    QSemaphore wake;
+    std::atomic<bool> frameRequested{false};
+    std::atomic<bool> quitting{false};
+    std::atomic<bool> clearTextures{false};
+    QMutex replaceMutex;
+    std::vector<std::pair<std::string, QImage>> textureReplacements;
+    std::atomic<bool> texturesReplaced{false};
+    mutable QMutex graphMutex;
+    std::string graphText;
+    unsigned lastGraphBuilds{0};
+    std::atomic<bool> dynRes{false};
+    std::atomic<float> targetMs{33.3f};
+    std::atomic<float> scale{1.f};
+    std::atomic<int> pixelW{1}, pixelH{1};
+    std::atomic<unsigned> framesDone{0};
+    std::atomic<std::uint64_t> consumed{0};
+    // Debug: frames since the snapshot last changed shape, for the zero-allocation check
+    size_t steadyFrames{0};
+    std::uint64_t lastVersion{0};
+    size_t arenaBlocks{0};
+    unsigned lastResourceChanges{0};
+    static constexpr size_t kWarmupFrames = 8;
+};
+#endif // RENDERTHREAD_H
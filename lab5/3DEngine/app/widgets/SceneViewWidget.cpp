@@ -1,20 +1,61 @@
 #include "SceneViewWidget.h"
 #include <QOpenGLContext>
-#include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
 #include <QtMath>
+#include <algorithm>
+#include "../StartupProfile.h"
 SceneViewWidget::SceneViewWidget(QWidget* parent):QOpenGLWidget(parent){
 	setFocusPolicy(Qt::StrongFocus);
 	setMouseTracking(true);
 	fpsTimer.start();
+	pacingClock.start();
+	pacingTimer.setSingleShot(true);
+	pacingTimer.setTimerType(Qt::PreciseTimer);
+	connect(&pacingTimer, &QTimer::timeout, this, qOverload<>(&QWidget::update));
+	connect(this, &QOpenGLWidget::frameSwapped, this, &SceneViewWidget::onFrameSwapped);
 }
-void SceneViewWidget::initializeGL(){ renderer.initialize(); renderer.setViewportSize(width(), height()); }
-void SceneViewWidget::resizeGL(int w,int h){
-	if(QOpenGLContext* ctx = QOpenGLContext::currentContext()){
-		if(QOpenGLFunctions* f = ctx->functions()){
-			f->glViewport(0,0,w,h);
-		}
-	}
-	renderer.setViewportSize(w,h);
+SceneViewWidget::~SceneViewWidget(){
+	releaseGL();
+}
+void SceneViewWidget::initializeGL(){
+	StartupProfile::mark("GL context ready");
+	renderThread = std::make_unique<RenderThread>(context(), &stats);
+	renderThread->start();
+	// The widget context is recreated on reparenting; tear the render side down with it
+	connect(context(), &QOpenGLContext::aboutToBeDestroyed, this, &SceneViewWidget::releaseGL, Qt::DirectConnection);
+}
+void SceneViewWidget::releaseGL(){
+	if(!renderThread) return;
+	makeCurrent();
+	renderThread->stop();
+	if(presentFbo){ context()->extraFunctions()->glDeleteFramebuffers(1, &presentFbo); presentFbo = 0; }
+	renderThread.reset();
+	doneCurrent();
+}
+void SceneViewWidget::setFrameLimit(int fps){
+	maxFPS = fps > 0 ? fps : 0;
+	// A hitch is a frame well past the pacing period, never less than 50 ms
+	stats.setHitchThreshold(maxFPS ? std::max(50.f, 1.5f * 1000.f / maxFPS) : 50.f);
+	nextFrameNs = pacingClock.nsecsElapsed();
+	pacingTimer.stop();
+	update();
+}
+void SceneViewWidget::scheduleNextFrame(){
+	if(maxFPS <= 0){ update(); return; }
+	// Pace against a fixed schedule rather than "now + period" so timer jitter doesn't accumulate
+	const qint64 period = 1000000000LL / maxFPS;
+	const qint64 now = pacingClock.nsecsElapsed();
+	nextFrameNs += period;
+	if(nextFrameNs < now) nextFrameNs = now; // fell behind: don't try to catch up with a burst
+	pacingTimer.start(static_cast<int>((nextFrameNs - now) / 1000000));
+}
+void SceneViewWidget::onFrameSwapped(){
+	// Hitches are kept in the stats (recentHitches) for the Frame Statistics dialog
+	stats.presented();
+}
+void SceneViewWidget::resizeGL(int,int){
+	// Render targets follow the pixel size published with each snapshot
+	stats.markEvent(FrameStats::Resize);
 }
 void SceneViewWidget::mousePressEvent(QMouseEvent* e){ lastPos = e->pos(); }
 void SceneViewWidget::mouseMoveEvent(QMouseEvent* e){
@@ -72,24 +113,96 @@ void SceneViewWidget::wheelEvent(QWheelEvent* e){
 	emit fovChanged(scene->camera.fov);
 	update();
 }
-void SceneViewWidget::paintGL(){
-	if(scene){
-		renderer.setCamera(&scene->camera);
-		std::vector<Light*> ls;
-		for(auto& l: scene->lights) ls.push_back(l.get());
-		renderer.setLights(ls);
-		renderer.clearModels();
-		for(auto& m: scene->models) renderer.addModel(m.get());
+SceneDelta SceneViewWidget::makeDelta(const SceneChange& c) const{
+	SceneDelta d;
+	d.change = c;
+	switch(c.kind){
+	case SceneChange::Kind::ModelAdded:
+	case SceneChange::Kind::GeometryEdited:
+	case SceneChange::Kind::TransformEdited:
+	case SceneChange::Kind::TextureChanged:
+		// Current state of the model; if it was removed later in the journal the removal follows
+		if(auto m = scene->findModel(c.id)){ d.model = m; d.texture = m->texture; d.transform = m->transform; }
+		break;
+	case SceneChange::Kind::LightAdded:
+	case SceneChange::Kind::LightEdited:
+		if(const Light* l = scene->findLight(c.id)) d.light = *l;
+		break;
+	default: break;
 	}
-	renderer.renderScene();
-	// FPS tracking
-	frameCount++;
+	return d;
+}
+void SceneViewWidget::collectSceneDeltas(){
+	// Drop what the render thread has already folded into its mirror
+	const std::uint64_t done = renderThread->consumedVersion();
+	size_t keep = 0;
+	while(keep < pendingDeltas.size() && pendingDeltas[keep].change.version <= done) ++keep;
+	if(keep) pendingDeltas.erase(pendingDeltas.begin(), pendingDeltas.begin() + static_cast<std::ptrdiff_t>(keep));
+	if(!scene || scene->version() == seenVersion) return; // steady state: no scene traversal
+	changeScratch.clear();
+	if(scene->changesSince(seenVersion, changeScratch)){
+		for(const auto& c : changeScratch) pendingDeltas.push_back(makeDelta(c));
+	} else {
+		// Fell out of the journal window: resend the whole scene at the current version
+		const std::uint64_t v = scene->version();
+		pendingDeltas.clear();
+		pendingDeltas.push_back(makeDelta({v, 0, SceneChange::Kind::Cleared}));
+		for(const auto& l : scene->lights) if(l) pendingDeltas.push_back(makeDelta({v, l->id, SceneChange::Kind::LightAdded}));
+		for(const auto& m : scene->models) if(m) pendingDeltas.push_back(makeDelta({v, m->id, SceneChange::Kind::ModelAdded}));
+	}
+	seenVersion = scene->version();
+}
+void SceneViewWidget::publishSnapshot(){
+	collectSceneDeltas();
+	FrameSnapshot& snap = renderThread->snapshotSlot();
+	if(scene) snap.camera = scene->camera;
+	snap.version = seenVersion;
+	// Slots are reused, so with no pending edits this is a clear() and nothing else
+	snap.deltas.assign(pendingDeltas.begin(), pendingDeltas.end());
+	const qreal dpr = devicePixelRatioF();
+	renderThread->setPixelSize(qRound(width()*dpr), qRound(height()*dpr));
+	renderThread->setDynamicResolution(dynRes);
+	renderThread->setTargetFrameTime(targetMs);
+	renderThread->publishSnapshot();
+	renderThread->requestFrame();
+}
+void SceneViewWidget::presentLatestFrame(){
+	QOpenGLExtraFunctions* f = context()->extraFunctions();
+	auto& frames = renderThread->frames();
+	frames.acquire();
+	RenderThread::Target& t = frames.readSlot();
+	if(!t.texture){
+		f->glClearColor(0.1f,0.1f,0.15f,1.f);
+		f->glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+		return;
+	}
+	if(t.renderDone) f->glWaitSync(t.renderDone, 0, GL_TIMEOUT_IGNORED);
+	if(!firstFramePresented){ StartupProfile::reach(StartupProfile::FirstFrame); firstFramePresented = true; }
+	if(!presentFbo) f->glGenFramebuffers(1, &presentFbo);
+	const qreal dpr = devicePixelRatioF();
+	f->glBindFramebuffer(GL_READ_FRAMEBUFFER, presentFbo);
+	f->glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, t.texture, 0);
+	f->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, defaultFramebufferObject());
+	f->glBlitFramebuffer(0, 0, t.width, t.height, 0, 0, qRound(width()*dpr), qRound(height()*dpr), GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	f->glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+	// Tell the render thread when it may draw into this texture again
+	if(t.presentDone) f->glDeleteSync(t.presentDone);
+	t.presentDone = f->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	f->glFlush();
+}
+void SceneViewWidget::paintGL(){
+	if(!renderThread) return;
+	publishSnapshot();
+	presentLatestFrame();
+	// FPS tracking (frames completed by the render thread, not GUI repaints)
 	qint64 elapsed = fpsTimer.elapsed();
 	if(elapsed - lastFPSUpdate >= 500){
-		currentFPS = static_cast<int>(frameCount * 1000.0 / (elapsed - lastFPSUpdate));
+		const unsigned done = renderThread->framesRendered();
+		currentFPS = static_cast<int>((done - lastFrameCount) * 1000.0 / (elapsed - lastFPSUpdate));
 		emit fpsChanged(currentFPS);
-		frameCount = 0;
+		if(dynRes) emit resolutionScaleChanged(renderThread->resolutionScale(), targetMs);
+		lastFrameCount = done;
 		lastFPSUpdate = elapsed;
 	}
-	update();
+	scheduleNextFrame();
 }
@@ -1,22 +1,40 @@
 #ifndef SCENEVIEWWIDGET_H
 #define SCENEVIEWWIDGET_H
 #include <QOpenGLWidget>
-#include "../../modules/RenderModule/include/Renderer.h"
+#include "RenderThread.h"
 #include "../../core/include/Scene.h"
+#include "../../core/include/FrameStats.h"
 #include <QPoint>
+#include <QTimer>
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QElapsedTimer>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
 class SceneViewWidget : public QOpenGLWidget {
     Q_OBJECT
 public:
     explicit SceneViewWidget(QWidget* parent=nullptr);
+    ~SceneViewWidget() override;
     Scene* scene{nullptr};
     int getFPS() const { return currentFPS; }
-    void clearTextures() { renderer.clearTextures(); }
+    void clearTextures() { if(renderThread) renderThread->requestClearTextures(); }
+    void replaceTexture(const std::string& path, const QImage& image) { if(renderThread) renderThread->requestTextureReplace(path, image); update(); }
+    void setDynamicResolution(bool on) { dynRes = on; update(); }
+    bool dynamicResolution() const { return dynRes; }
+    void setTargetFrameTime(float ms) { targetMs = (ms>1.f?ms:1.f); }
+    float targetFrameTime() const { return targetMs; }
+    FrameStats& frameStats() { return stats; }
+    std::string renderGraphDump() const { return renderThread ? renderThread->renderGraphDump() : std::string(); }
+    // Frame limiter: 0 = render as fast as vsync allows
+    void setFrameLimit(int fps);
+    int frameLimit() const { return maxFPS; }
 signals:
     void fpsChanged(int fps);
     void fovChanged(float fov);
+    void resolutionScaleChanged(float scale, float targetMs);
 protected:
     void initializeGL() override;
     void resizeGL(int w,int h) override;
@@ -25,11 +43,32 @@ protected:
     void mouseMoveEvent(QMouseEvent* e) override;
     void wheelEvent(QWheelEvent* e) override;
 private:
-    Renderer renderer;
+    // Scene rendering happens on renderThread; paintGL only publishes a snapshot and presents
+    std::unique_ptr<RenderThread> renderThread;
+    GLuint presentFbo{0};
+    bool firstFramePresented{false};
+    // Scene edits not yet confirmed by the render thread, and the last journal version read
+    std::vector<SceneDelta> pendingDeltas;
+    std::vector<SceneChange> changeScratch;
+    std::uint64_t seenVersion{0};
+    void collectSceneDeltas();
+    SceneDelta makeDelta(const SceneChange& c) const;
+    bool dynRes{false};
+    float targetMs{33.3f};
     QPoint lastPos;
     QElapsedTimer fpsTimer;
-    int frameCount{0};
+    unsigned lastFrameCount{0};
     int currentFPS{0};
     qint64 lastFPSUpdate{0};
+    FrameStats stats;
+    QTimer pacingTimer;
+    QElapsedTimer pacingClock;
+    qint64 nextFrameNs{0};
+    int maxFPS{0};
+    void publishSnapshot();
+    void presentLatestFrame();
+    void releaseGL();
+    void scheduleNextFrame();
+    void onFrameSwapped();
 };
 #endif // SCENEVIEWWIDGET_H
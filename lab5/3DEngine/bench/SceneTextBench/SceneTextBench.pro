@@ -0,0 +1,13 @@
+TEMPLATE = app
+TARGET = SceneTextBench
+CONFIG += c++17 console
+CONFIG -= app_bundle
+QT += core
+INCLUDEPATH += $$PWD/../../core/include
+SOURCES += \
+    main.cpp
+CONFIG(debug, debug|release) {
+    LIBS += -L$$OUT_PWD/../../core/debug -lCore
+} else {
+    LIBS += -L$$OUT_PWD/../../core/release -lCore
+}
@@ -0,0 +1,123 @@
+// Times Scene::loadFromFile (block read, std::from_chars, parallel chunks) against the
+// per-line istringstream loader it replaced, on a generated .scene, and checks that both
+// give the same bytes.
+// Usage: SceneTextBench [vertices=3000000] [models=12] [file=<temp dir>/bench.scene]
+#include "Scene.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+double msSince(Clock::time_point t){ return std::chrono::duration<double, std::milli>(Clock::now() - t).count(); }
+
+// The loader as it was before the fast path: one istringstream per line. Models only.
+void legacyLoad(const std::string& path, std::vector<std::vector<Mesh>>& models){
+	std::ifstream in(path);
+	std::string line;
+	int expectModels = -1;
+	while(std::getline(in, line)){
+		if(line.empty()) continue;
+		std::istringstream ss(line);
+		std::string key; ss >> key;
+		if(key == "LIGHTS"){
+			int n = 0; ss >> n;
+			for(int i=0;i<n;i++){ if(!std::getline(in, line)) break; if(line.rfind("LIGHT",0)!=0) --i; }
+		} else if(key == "MODELS"){
+			ss >> expectModels;
+			for(int mi=0; mi<expectModels; ++mi){
+				std::vector<Mesh> meshes;
+				if(!std::getline(in, line)) break; // NAME
+				std::getline(in, line); // TEXTURE
+				std::getline(in, line); // MATERIAL
+				int meshCount = 0; if(std::getline(in, line) && line.rfind("MESHES",0)==0){ std::istringstream mcs(line.substr(6)); mcs >> meshCount; }
+				for(int k=0;k<meshCount;k++){
+					int vcount=0; if(!std::getline(in, line)) break; if(line.rfind("VERTICES",0)==0){ std::istringstream vs(line.substr(8)); vs >> vcount; }
+					std::vector<Vec3> verts; verts.reserve(vcount);
+					for(int vi=0; vi<vcount; ++vi){ if(!std::getline(in, line)) break; std::istringstream vls(line); char c; Vec3 v; vls >> c >> v.x >> v.y >> v.z; verts.push_back(v); }
+					int icount=0; if(!std::getline(in, line)) break; if(line.rfind("INDICES",0)==0){ std::istringstream is(line.substr(7)); is >> icount; }
+					std::vector<unsigned> idx; idx.reserve(icount);
+					for(int ii=0; ii<icount; ++ii){ if(!std::getline(in, line)) break; std::istringstream ils(line); char c; unsigned a = 0; ils >> c >> a; idx.push_back(a); }
+					Mesh m; m.vertices = std::move(verts); m.indices = std::move(idx); meshes.push_back(std::move(m));
+				}
+				models.push_back(std::move(meshes));
+			}
+		}
+	}
+}
+
+// Random soup of triangles; values span several magnitudes so both parsers see exponents too
+bool generate(const std::string& path, std::size_t vertices, int modelCount){
+	Scene scene;
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> pos(-100.f, 100.f);
+	std::uniform_int_distribution<int> scale(-3, 3);
+	const std::size_t perModel = std::max<std::size_t>(3, vertices / static_cast<std::size_t>(modelCount)) / 3 * 3;
+	for(int mi=0; mi<modelCount; ++mi){
+		auto m = std::make_unique<Model>();
+		m->name = "bench" + std::to_string(mi);
+		Mesh mesh;
+		mesh.vertices.resize(perModel);
+		for(auto& v : mesh.vertices){ const float s = std::pow(10.f, float(scale(rng))); v.x = pos(rng)*s; v.y = pos(rng)*s; v.z = pos(rng)*s; }
+		mesh.indices.resize(perModel * 3);
+		std::uniform_int_distribution<unsigned> pick(0, static_cast<unsigned>(perModel - 1));
+		for(auto& i : mesh.indices) i = pick(rng);
+		m->meshes.push_back(std::move(mesh));
+		if(!scene.addModel(std::move(m))) return false;
+	}
+	return scene.saveToFile(path);
+}
+
+bool sameGeometry(const Scene& scene, const std::vector<std::vector<Mesh>>& legacy){
+	if(scene.models.size() != legacy.size()) return false;
+	for(std::size_t mi=0; mi<legacy.size(); ++mi){
+		const auto& a = scene.models[mi]->meshes; const auto& b = legacy[mi];
+		if(a.size() != b.size()) return false;
+		for(std::size_t k=0;k<a.size();k++){
+			if(a[k].vertexCount() != b[k].vertices.size() || a[k].indexCount() != b[k].indices.size()) return false;
+			if(std::memcmp(a[k].vertexData(), b[k].vertices.data(), b[k].vertices.size() * sizeof(Vec3)) != 0) return false;
+			if(std::memcmp(a[k].indexData(), b[k].indices.data(), b[k].indices.size() * sizeof(unsigned)) != 0) return false;
+		}
+	}
+	return true;
+}
+}
+
+int main(int argc, char** argv){
+	const std::size_t vertices = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 3000000;
+	const int modelCount = argc > 2 ? std::max(1, std::min(50, std::atoi(argv[2]))) : 12;
+	const std::string path = argc > 3 ? argv[3] : (std::filesystem::temp_directory_path() / "bench.scene").string();
+
+	auto t = Clock::now();
+	if(!generate(path, vertices, modelCount)){ std::fprintf(stderr, "can't write %s\n", path.c_str()); return 1; }
+	std::printf("generated %s (%zu vertices, %d models) in %.0f ms\n", path.c_str(), vertices, modelCount, msSince(t));
+	std::printf("job threads: %u\n", JobSystem::instance().threadCount());
+
+	// Run the slow one first so the fast one doesn't get the colder page cache
+	std::vector<std::vector<Mesh>> legacy;
+	t = Clock::now();
+	legacyLoad(path, legacy);
+	const double slowMs = msSince(t);
+
+	Scene scene;
+	t = Clock::now();
+	if(!scene.loadFromFile(path)){ std::fprintf(stderr, "load failed\n"); return 1; }
+	const double fastMs = msSince(t);
+
+	std::printf("istream loader:    %8.0f ms\n", slowMs);
+	std::printf("from_chars loader: %8.0f ms  (%.1fx)\n", fastMs, slowMs / std::max(0.001, fastMs));
+	const bool same = sameGeometry(scene, legacy);
+	std::printf("geometry %s\n", same ? "identical" : "DIFFERS");
+	return same ? 0 : 2;
+}
@@ -13,8 +13,21 @@ HEADERS += \
     include/Component.h \
     include/Model.h \
     include/Mesh.h \
+    include/PointCloud.h \
     include/Material.h \
     include/Texture.h \
+    include/FrameStats.h \
+    include/FrameSnapshot.h \
+    include/TripleBuffer.h \
+    include/FrameArena.h \
+    include/SceneJournal.h \
+    include/SceneText.h \
+    include/SceneBinary.h \
+    include/SceneIndex.h \
+    include/SceneContainer.h \
+    include/GeometryCodec.h \
+    include/SceneEditLog.h \
+    include/JobSystem.h
 
 SOURCES += \
     src/Color.cpp \
@@ -26,4 +39,13 @@ SOURCES += \
     src/Model.cpp \
     src/Mesh.cpp \
     src/Material.cpp \
-    src/Texture.cpp
+    src/Texture.cpp \
+    src/FrameStats.cpp \
+    src/FrameArena.cpp \
+    src/SceneText.cpp \
+    src/SceneBinary.cpp \
+    src/SceneIndex.cpp \
+    src/SceneContainer.cpp \
+    src/GeometryCodec.cpp \
+    src/SceneEditLog.cpp \
+    src/JobSystem.cpp
@@ -0,0 +1,54 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+#include <cstddef>
+#include <memory>
+#include <vector>
+// Bump-pointer allocator for per-frame temporaries. Everything is released at once by
+// reset() at the end of the frame; memory is kept, so after the first few frames a
+// steady scene allocates nothing from the heap.
+class FrameArena {
+public:
+    explicit FrameArena(std::size_t initialBytes = 256 * 1024);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t align);
+    // End of frame: frees everything; if the frame overflowed, the arena is regrown
+    // into one block big enough for it so the next frame stays in a single block.
+    void reset();
+
+    std::size_t used() const { return usedBytes; }
+    std::size_t capacity() const { return capacityBytes; }
+    std::size_t highWater() const { return peakBytes; }
+    // Heap blocks taken since the last reset(); zero in steady state
+    std::size_t heapAllocationsThisFrame() const { return frameHeapAllocs; }
+    std::size_t heapAllocationsTotal() const { return totalHeapAllocs; }
+private:
+    struct Block { std::unique_ptr<unsigned char[]> data; std::size_t size{0}; };
+    void addBlock(std::size_t minBytes);
+    std::vector<Block> blocks;
+    std::size_t current{0};   // index of the block being bumped
+    std::size_t offset{0};    // bump offset inside blocks[current]
+    std::size_t usedBytes{0};
+    std::size_t capacityBytes{0};
+    std::size_t peakBytes{0};
+    std::size_t frameHeapAllocs{0};
+    std::size_t totalHeapAllocs{0};
+};
+
+// std-compatible allocator over a FrameArena; deallocate is a no-op
+template <class T>
+struct ArenaAllocator {
+    using value_type = T;
+    FrameArena* arena{nullptr};
+    explicit ArenaAllocator(FrameArena& a) : arena(&a) {}
+    template <class U> ArenaAllocator(const ArenaAllocator<U>& o) : arena(o.arena) {}
+    T* allocate(std::size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, std::size_t) {}
+    template <class U> bool operator==(const ArenaAllocator<U>& o) const { return arena == o.arena; }
+    template <class U> bool operator!=(const ArenaAllocator<U>& o) const { return arena != o.arena; }
+};
+
+template <class T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+#endif // FRAMEARENA_H
@@ -0,0 +1,31 @@
+#ifndef FRAMESNAPSHOT_H
+#define FRAMESNAPSHOT_H
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Camera.h"
+#include "Light.h"
+#include "Model.h"
+#include "Texture.h"
+#include "SceneJournal.h"
+// One scene edit plus whatever the render thread needs to apply it without touching
+// the live Scene. Models are shared so they outlive removal from the scene; texture,
+// transform and light values are copied because the GUI edits them in place.
+struct SceneDelta {
+    SceneChange change;
+    std::shared_ptr<const Model> model;
+    Texture texture;
+    std::array<float,16> transform{};
+    Light light;
+};
+
+// What the GUI thread hands to the render thread each frame. Deltas are cumulative
+// since the last version the render thread confirmed, so skipped snapshots lose nothing;
+// with no edits the list is empty and the render thread keeps its retained scene.
+struct FrameSnapshot {
+    Camera camera;
+    std::uint64_t version{0};
+    std::vector<SceneDelta> deltas;
+};
+#endif // FRAMESNAPSHOT_H
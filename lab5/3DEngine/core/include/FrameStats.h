@@ -0,0 +1,58 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+// Per-frame CPU / present timing in a ring buffer with percentiles and hitch tagging
+class FrameStats {
+public:
+    // What happened during a frame; attached to the sample so hitches can be explained
+    enum Event : unsigned {
+        TextureUpload = 1u << 0,
+        SceneLoad     = 1u << 1,
+        BufferGrowth  = 1u << 2,
+        Resize        = 1u << 3
+    };
+    struct Sample { float cpuMs{0.f}; float presentMs{0.f}; unsigned events{0}; };
+    struct Hitch { std::uint64_t frame{0}; float cpuMs{0.f}; float presentMs{0.f}; unsigned events{0}; };
+    struct Percentiles { float p50{0.f}, p95{0.f}, p99{0.f}, max{0.f}; };
+    struct Report { std::size_t frames{0}; Percentiles cpu; Percentiles present; std::size_t hitches{0}; };
+
+    static constexpr std::size_t kCapacity = 1024;
+    static constexpr std::size_t kHitchHistory = 32;
+
+    // begin/endFrame bracket CPU work and may run on the render thread
+    void beginFrame();
+    void endFrame();
+    // Call when the frame reached the screen; returns true if it was a hitch
+    bool presented();
+    // Thread-safe: may be called from loaders or the renderer at any time
+    void markEvent(Event e) { pendingEvents.fetch_or(e, std::memory_order_relaxed); }
+
+    void setHitchThreshold(float ms) { hitchMs = ms; }
+    float hitchThreshold() const { return hitchMs; }
+    std::uint64_t frameIndex() const { return frames; }
+    const Hitch& lastHitch() const { return hitchRing[(hitchHead + kHitchHistory - 1) % kHitchHistory]; }
+
+    Report report() const;
+    std::vector<Hitch> recentHitches() const;
+    void reset();
+    static std::string eventNames(unsigned events);
+private:
+    using Clock = std::chrono::steady_clock;
+    std::array<Sample, kCapacity> ring{};
+    std::size_t head{0}, count{0};
+    std::array<Hitch, kHitchHistory> hitchRing{};
+    std::size_t hitchHead{0}, hitchCount{0}, hitchTotal{0};
+    std::uint64_t frames{0};
+    float hitchMs{50.f};
+    std::atomic<float> lastCpuMs{0.f}; // written by the render thread, read on present
+    Clock::time_point frameStart{};
+    Clock::time_point lastPresent{};
+    bool havePresent{false};
+    std::atomic<unsigned> pendingEvents{0};
+};
+#endif // FRAMESTATS_H
@@ -0,0 +1,24 @@
+#ifndef GEOMETRYCODEC_H
+#define GEOMETRYCODEC_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Vec3.h"
+// Mesh-specific codecs for the .sceneb path.
+//   Positions: quantized to a grid just under 2*maxError, delta coded along the vertex order,
+//   zigzagged and bit-packed per axis in blocks of 128 with one width byte per block.
+//   Indices: a 32-entry FIFO of recently used vertices; hits and "next new vertex" take
+//   one byte, anything else a byte plus a zigzag varint.
+// Decoders validate sizes and never read past 'size'.
+namespace GeometryCodec {
+    enum VertexCodec : std::uint32_t { RawVertices = 0, QuantDelta = 1 };
+    enum IndexCodec : std::uint32_t { RawIndices = 0, IndexFifo = 1 };
+    struct Quantization { float origin[3]{0,0,0}; float step{0}; };
+
+    // False if the error bound is finer than float precision over the mesh's extent
+    bool encodePositions(const Vec3* v, std::size_t count, float maxError, Quantization& q, std::string& out);
+    bool decodePositions(const char* data, std::size_t size, std::size_t count, const Quantization& q, Vec3* out);
+    void encodeIndices(const unsigned* idx, std::size_t count, std::string& out);
+    bool decodeIndices(const char* data, std::size_t size, std::size_t count, unsigned* out);
+}
+#endif // GEOMETRYCODEC_H
@@ -0,0 +1,117 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+// Work-stealing job pool for loaders, mesh processing and culling. Every worker has its own
+// deque: it pushes and pops at the back, idle workers steal from the front of the others'.
+// Jobs posted from outside the pool are dealt round the workers. A thread waiting on a Counter
+// runs jobs meanwhile (a thread outside the pool only those of that counter), so jobs may wait
+// for jobs they post. Jobs must not throw.
+// Core is static, so on Windows each DLL linking it has its own instance(): the app creates
+// the one pool and installs it into every module (setInstance) before the module uses it.
+class JobSystem {
+public:
+    // Jobs outstanding under it. Wait on it (wait()) before it goes out of scope, and reuse it
+    // only once done.
+    class Counter {
+    public:
+        int pending() const { return count.load(std::memory_order_acquire); }
+        bool done() const { return pending() == 0; }
+    private:
+        friend class JobSystem;
+        std::atomic<int> count{0};
+        std::mutex mutex;
+        std::vector<std::pair<std::function<void()>, Counter*>> after; // runAfter(), until done
+    };
+    struct WorkerStats {
+        std::uint64_t jobs{0};   // run by this worker since resetStats()
+        std::uint64_t stolen{0}; // of those, taken from another worker's deque
+        double busySeconds{0};
+        double utilisation{0};   // busySeconds over the time since resetStats()
+    };
+    // One worker per core but one, as the thread that waits works too
+    static JobSystem& instance();
+    // instance() returns 'system' from now on; the default pool is then never created
+    static void setInstance(JobSystem& system);
+    explicit JobSystem(unsigned workerCount);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    // Workers plus the calling thread
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+    void run(std::function<void()> job, Counter* counter = nullptr);
+    // 'job' starts once 'dependency' is done (at once if it already is)
+    void runAfter(Counter& dependency, std::function<void()> job, Counter* counter = nullptr);
+    // Returns once at most 'atMost' of the counter's jobs are left
+    void wait(Counter& counter, int atMost = 0);
+    // body(i) for i in [0, count), split into ranges of at least 'grain' over all threads;
+    // returns when every range is done. Allocates nothing, so per-frame work can use it.
+    template <class Body> void parallelFor(std::size_t count, const Body& body, std::size_t grain = 1);
+    std::vector<WorkerStats> stats() const;
+    void resetStats();
+private:
+    struct Job {
+        void (*fn)(void* context, std::size_t begin, std::size_t end);
+        void* context;
+        std::size_t begin, end;
+        Counter* counter; // already counted
+    };
+    static constexpr std::size_t kDequeSize = 1024;
+    struct Worker {
+        std::mutex mutex;
+        Job ring[kDequeSize];
+        std::size_t head{0}, tail{0};
+        std::size_t index{0};
+        std::thread thread;
+        std::atomic<std::uint64_t> jobs{0}, stolen{0}, busyNs{0};
+    };
+    Worker* current() const;
+    // Set by the constructor, so every module's copy of the code finds the workers of this pool
+    // through the thread locals of the module that created it
+    Worker* (*currentIn)(const JobSystem*);
+    static Worker* currentOf(const JobSystem* system);
+    void post(const Job& job);
+    bool take(Worker* self, const Counter* only, Job& out, bool& stolen);
+    void execute(Worker* self, const Job& job, bool stolen);
+    void finish(Counter* counter);
+    void postFunction(std::function<void()> job, Counter* counter);
+    void workerLoop(Worker* self);
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<std::size_t> nextWorker{0};
+    std::atomic<std::size_t> queued{0};
+    std::atomic<int> sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool quitting{false};
+    std::atomic<std::int64_t> statsSince{0};
+};
+
+template <class Body> void JobSystem::parallelFor(std::size_t count, const Body& body, std::size_t grain){
+    if(!count) return;
+    auto call = [](void* context, std::size_t begin, std::size_t end){
+        const Body& f = *static_cast<const Body*>(context);
+        for(std::size_t i=begin;i<end;i++) f(i);
+    };
+    void* context = const_cast<void*>(static_cast<const void*>(&body));
+    // A few ranges per thread, so one that falls behind is made up for by stealing
+    const std::size_t slices = std::size_t(threadCount()) * 4;
+    const std::size_t size = std::max(std::max<std::size_t>(1, grain), (count + slices - 1) / slices);
+    if(size >= count || workers.empty()){ call(context, 0, count); return; }
+    Counter counter;
+    counter.count.store(static_cast<int>((count - size + size - 1) / size) + 1);
+    for(std::size_t b=size;b<count;b+=size) post({call, context, b, std::min(count, b + size), &counter});
+    // The first range is the caller's own
+    call(context, 0, size);
+    finish(&counter);
+    wait(counter);
+}
+#endif // JOBSYSTEM_H
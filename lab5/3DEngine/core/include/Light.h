@@ -2,10 +2,12 @@
 #define LIGHT_H
 #include "Color.h"
 #include "Vec3.h"
+#include <cstdint>
 #include <string>
 class Light {
 public:
     enum class Type { Point, Directional };
+    std::uint32_t id{0}; // assigned by Scene
     Type type{Type::Point};
     Vec3 position{0,0,0};
     Vec3 direction{0,-1,0};
@@ -1,6 +1,30 @@
 #ifndef MESH_H
 #define MESH_H
+#include <cstddef>
+#include <memory>
 #include <vector>
 #include "Vec3.h"
-struct Mesh { std::vector<Vec3> vertices; std::vector<unsigned> indices; };
+// Geometry is either owned (the vectors) or a read-only view into external storage such as
+// a mapped .sceneb file; 'backing' keeps that storage alive. Read through the accessors;
+// call detach() before editing a view in place.
+struct Mesh {
+    std::vector<Vec3> vertices;
+    std::vector<unsigned> indices;
+    std::shared_ptr<const void> backing;
+    const Vec3* viewVertices{nullptr};
+    std::size_t viewVertexCount{0};
+    const unsigned* viewIndices{nullptr};
+    std::size_t viewIndexCount{0};
+
+    bool isView() const { return backing != nullptr; }
+    const Vec3* vertexData() const { return isView() ? viewVertices : vertices.data(); }
+    std::size_t vertexCount() const { return isView() ? viewVertexCount : vertices.size(); }
+    const unsigned* indexData() const { return isView() ? viewIndices : indices.data(); }
+    std::size_t indexCount() const { return isView() ? viewIndexCount : indices.size(); }
+    // Copies viewed data into the owned vectors and drops the view
+    void detach();
+    // Lets the OS page a view's data out (it is read back if touched again), e.g. once it is on
+    // the GPU; no-op for owned data and where the platform has no such hint
+    void releasePages() const;
+};
 #endif // MESH_H
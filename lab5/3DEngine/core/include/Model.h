@@ -1,15 +1,28 @@
 #ifndef MODEL_H
 #define MODEL_H
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 #include "Mesh.h"
+#include "PointCloud.h"
 #include "Material.h"
 #include "Texture.h"
 class Model {
 public:
+    std::uint32_t id{0}; // assigned by Scene
     std::string name;
     std::vector<Mesh> meshes;
+    // Set for point-cloud models (which have no meshes); shared, as copies never edit it
+    std::shared_ptr<const PointCloud> points;
+    // Bounds recorded in the .sceneb the meshes view, so culling needn't page them in; only
+    // trusted while every mesh is still a view (editing detaches). Read through modelBounds().
+    bool fileBounds{false};
+    std::array<float,3> boundsMin{}, boundsMax{};
     Material material; 
     Texture texture; 
+    // Column-major 4x4 model-to-world matrix
+    std::array<float,16> transform{1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
 };
 #endif // MODEL_H
@@ -0,0 +1,24 @@
+#ifndef POINTCLOUD_H
+#define POINTCLOUD_H
+#include <cstdint>
+#include <vector>
+#include "Vec3.h"
+// A scan as octree leaves: each cell is a contiguous run of 'points' with its bounds, cells
+// in depth-first (Morton) order so neighbouring cells sit together in memory. Points are
+// shuffled inside a cell, so any prefix of one is an even subsample of it; that is what
+// lets the renderer draw distant cells with fewer points.
+struct PointCloud {
+    struct Point {
+        Vec3 position;
+        std::uint32_t color{0xFFFFFFFFu}; // RGBA8, red in the lowest byte
+    };
+    struct Cell {
+        float boundsMin[3]{0,0,0}, boundsMax[3]{0,0,0};
+        std::uint32_t first{0}, count{0};
+    };
+    static constexpr std::uint32_t kMaxCellPoints = 16384;
+    std::vector<Point> points;
+    std::vector<Cell> cells;
+    bool hasColor{false};
+};
+#endif // POINTCLOUD_H
@@ -2,17 +2,103 @@
 #define SCENE_H
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
 #include "Model.h"
 #include "Light.h"
 #include "Camera.h"
+#include "SceneJournal.h"
+#include "SceneEditLog.h"
 class Scene {
 public:
-    std::vector<std::unique_ptr<Model>> models;
+    // Shared so render snapshots can keep a model alive after it leaves the scene.
+    // Edit through the methods below so the change journal stays accurate.
+    std::vector<std::shared_ptr<Model>> models;
     std::vector<std::unique_ptr<Light>> lights;
     Camera camera;
-    bool addModel(std::unique_ptr<Model> m){ if(models.size()>=50) return false; models.push_back(std::move(m)); return true; }
-    bool addLight(std::unique_ptr<Light> l){ if(lights.size()>=10) return false; lights.push_back(std::move(l)); return true; }
+    bool addModel(std::unique_ptr<Model> m);
+    bool addLight(std::unique_ptr<Light> l);
+    bool removeModel(std::size_t index);
+    bool removeLight(std::size_t index);
+    void clear();
+    // Report in-place edits made to a model or light owned by this scene
+    void markGeometryEdited(const Model* m){ if(m) journal.record(SceneChange::Kind::GeometryEdited, m->id); }
+    void markTransformEdited(const Model* m){ if(m) journal.record(SceneChange::Kind::TransformEdited, m->id); }
+    void markTextureChanged(const Model* m){ if(m) journal.record(SceneChange::Kind::TextureChanged, m->id); }
+    void markLightEdited(const Light* l){ if(l) journal.record(SceneChange::Kind::LightEdited, l->id); }
+    std::uint64_t version() const { return journal.version(); }
+    bool changesSince(std::uint64_t since, std::vector<SceneChange>& out) const { return journal.changesSince(since, out); }
+    std::shared_ptr<Model> findModel(std::uint32_t id) const;
+    const Light* findLight(std::uint32_t id) const;
+    // .scene text or .sceneb binary, optionally inside a compressed container (detected by
+    // content on load; format by extension on save, compressionLevel 1..9 wraps it in zlib chunks)
     bool loadFromFile(const std::string& path);
-    bool saveToFile(const std::string& path) const;
+    bool saveToFile(const std::string& path, int compressionLevel = 0) const;
+    // .sceneb only: positionError > 0 quantizes positions, packIndices FIFO-codes the index streams
+    struct SaveOptions {
+        int compressionLevel{0};
+        float positionError{0.f};
+        bool packIndices{false};
+    };
+    bool saveToFile(const std::string& path, const SaveOptions& options) const;
+    // None of the scene formats stores point clouds yet, so every save (saveToFile, saveEdits,
+    // compactFile) fails while this is true rather than writing the model without its points
+    bool hasPointClouds() const;
+    // Loads only the listed models (indices into SceneIndex::models of that file); without
+    // 'append' the scene is replaced and the file's lights come along
+    bool loadModels(const std::string& path, const std::vector<std::size_t>& which, bool append);
+    // Off-thread loading: reads 'path' without touching any Scene and hands lights and models
+    // over in file order, a batch at a time, as their geometry becomes ready. Returning false
+    // from 'deliver' stops early. False only if the file can't be read or is malformed
+    // (before the first batch for binary and compressed files).
+    struct LoadBatch {
+        std::vector<std::unique_ptr<Light>> lights;
+        std::vector<std::unique_ptr<Model>> models;
+        float progress{0.f}; // 0..1 after this batch
+    };
+    static bool streamFromFile(const std::string& path, const std::function<bool(LoadBatch&)>& deliver);
+    // Multi-file import: appends lights and models read elsewhere, keeping the camera. A model
+    // whose name is already taken becomes "name (2)", "name (3)"...; whatever doesn't fit is left
+    // in the vectors. Returns the number of models added.
+    std::size_t merge(std::vector<std::unique_ptr<Light>>& newLights, std::vector<std::unique_ptr<Model>>& newModels);
+    // Journaled saves: once the scene was loaded from or fully saved to 'path', saveEdits(path)
+    // only appends the edits made since to "<path>.journal" (SceneEditLog), and loading replays
+    // it. Past kCompactMinBytes and half the file's size, or on compactFile(), the journal is
+    // folded into a fresh full save. Anything it can't describe falls back to a full save too.
+    static constexpr std::uint64_t kCompactMinBytes = 64 * 1024;
+    bool saveEdits(const std::string& path) const;
+    bool compactFile(const std::string& path) const;
+    // The scene now mirrors 'path' (after loading it another way, e.g. streamFromFile); "" detaches
+    void attachFile(const std::string& path);
+    const std::string& attachedFile() const { return saved.path; }
+    // Non-blocking saves: a copy sharing mesh buffers with this scene (its models view the live
+    // geometry), which another thread can save while editing goes on here. Geometry shared
+    // this way must not change in place: edit it through editableModel().
+    std::unique_ptr<Scene> snapshot() const;
+    // After a snapshot of this scene was saved: journaled saves continue from that file.
+    // False if this scene was attached to another file since the snapshot was taken.
+    bool adoptSave(const Scene& snapshot);
+    // Model for in-place edits; copied first while a snapshot or the renderer shares it
+    std::shared_ptr<Model> editableModel(std::size_t index);
+private:
+    bool writeFile(const std::string& path, const SaveOptions& options) const;
+    bool writeText(std::ostream& out) const;
+    struct SavedFile {
+        std::string path;
+        SceneEditLog::Stamp base;       // the scene file the journal builds on
+        std::uint64_t journalBytes{0};
+        std::uint64_t version{0};       // journal version that file + journal reflect
+        std::vector<std::uint32_t> modelIds, lightIds; // in file order
+        SaveOptions options;            // kept for compaction
+        std::uint64_t generation{0};    // bumped on every rebase
+    };
+    void rebase(const std::string& path, const SaveOptions& options) const;
+    mutable SavedFile saved;
+    mutable std::uint64_t generations{0};
+    std::uint64_t snapshotOf{0};        // snapshot(): generation of the scene it was taken from
+    SceneJournal journal;
+    std::uint32_t nextId{1};
 };
 #endif // SCENE_H
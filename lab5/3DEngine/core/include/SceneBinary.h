@@ -0,0 +1,84 @@
+#ifndef SCENEBINARY_H
+#define SCENEBINARY_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+class Scene; class Model; class Light;
+// .sceneb: binary companion of the .scene text format, laid out to be memory-mapped.
+//   FileHeader | LightRecord[] | ModelRecord[] | MeshRecord[] | strings | 16-byte aligned arrays
+// Mesh arrays are raw little-endian Vec3/unsigned; loading maps the file and points Mesh
+// views at them, so nothing is parsed or copied until the geometry is actually touched.
+// Version 2 widens MeshRecord so either array may instead hold a GeometryCodec stream;
+// those meshes are decoded into owned storage on load. Files without any codec stay version 1.
+namespace SceneBinary {
+    constexpr char kMagic[8] = {'S','C','E','N','E','B','\0','\0'};
+    constexpr std::uint32_t kVersion = 2;
+    constexpr std::uint32_t kVersionRaw = 1;   // 32-byte mesh records, raw arrays only
+    constexpr std::uint32_t kByteOrder = 0x01020304;
+    constexpr std::uint64_t kAlign = 16;
+
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;      // reads back as kByteOrder on a same-endian host
+        float camera[6];              // position xyz, yaw, pitch, fov
+        std::uint32_t lightCount, modelCount, meshCount, reserved;
+        std::uint64_t lightsOffset, modelsOffset, meshesOffset;
+        std::uint64_t stringsOffset, stringsSize;
+        std::uint64_t dataOffset, fileSize;
+    };
+    struct LightRecord {
+        std::uint32_t type;           // 0 point, 1 directional (as in .scene)
+        float position[3], direction[3], color[4], intensity;
+    };
+    struct ModelRecord {
+        std::uint64_t nameOffset;     // into the string table
+        std::uint32_t nameSize, textureSize;
+        std::uint64_t textureOffset;
+        float diffuse[4];
+        float transform[16];
+        float boundsMin[3], boundsMax[3];
+        std::uint32_t firstMesh, meshCount;
+    };
+    struct MeshRecord {
+        std::uint64_t verticesOffset, vertexCount;
+        std::uint64_t indicesOffset, indexCount;
+        // Version 2 only (a version 1 record ends here)
+        std::uint64_t verticesBytes, indicesBytes;
+        std::uint32_t vertexCodec, indexCodec;  // GeometryCodec::VertexCodec / IndexCodec
+        float quantOrigin[3], quantStep;
+    };
+    static_assert(sizeof(FileHeader) == 112, "FileHeader layout");
+    static_assert(sizeof(LightRecord) == 48, "LightRecord layout");
+    static_assert(sizeof(ModelRecord) == 136, "ModelRecord layout");
+    static_assert(sizeof(MeshRecord) == 72, "MeshRecord layout");
+    constexpr std::uint64_t meshRecordSize(std::uint32_t version){ return version == kVersionRaw ? 32 : sizeof(MeshRecord); }
+    bool supportedVersion(const FileHeader& h);
+    // Record i of the mesh table (bounds already checked); version 1 records come back as raw codecs
+    MeshRecord readMeshRecord(const char* data, const FileHeader& h, std::uint64_t i);
+
+    // Optional geometry codecs for save; meshes they can't help are written raw
+    struct Encoding {
+        float positionError{0.f};   // > 0: quantize positions to within this distance
+        bool packIndices{false};
+    };
+
+    // Checks the magic only; cheap enough to call on every open
+    bool isBinaryFile(const std::string& path);
+    // 'only' restricts loading to those model-table indices; 'append' keeps the current scene
+    // (and skips the file's lights) instead of replacing it
+    bool load(const std::string& path, Scene& scene, const std::vector<std::size_t>* only = nullptr, bool append = false);
+    bool save(const Scene& scene, const std::string& path, const Encoding& encoding = Encoding());
+    // Just these models (no lights, default camera), e.g. a cooked import; read back with read()
+    bool saveModels(const std::vector<const Model*>& models, const std::string& path, const Encoding& encoding = Encoding());
+    // In-memory images (e.g. decoded from a compressed container); views keep 'image' alive
+    bool isBinaryImage(const char* data, std::size_t size);
+    bool loadImage(std::shared_ptr<const std::string> image, Scene& scene, const std::vector<std::size_t>* only = nullptr, bool append = false);
+    bool saveImage(const Scene& scene, std::string& out, const Encoding& encoding = Encoding());
+    // Whole file into plain lists instead of a Scene, e.g. on a loader thread
+    bool read(const std::string& path, std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models);
+    bool readImage(std::shared_ptr<const std::string> image, std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models);
+}
+#endif // SCENEBINARY_H
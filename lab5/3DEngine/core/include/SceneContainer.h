@@ -0,0 +1,42 @@
+#ifndef SCENECONTAINER_H
+#define SCENECONTAINER_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+// Optional compressed wrapper around a .scene / .sceneb image:
+//   Header | ChunkEntry[chunkCount] | qCompress'ed chunks
+// Chunks are kChunkSize bytes of the image, compressed independently (zlib via qCompress)
+// and checked with qChecksum, so they can be inflated in parallel while later ones are read.
+namespace SceneContainer {
+    constexpr char kMagic[8] = {'S','C','E','N','E','Z','\0','\0'};
+    constexpr std::uint32_t kVersion = 1;
+    constexpr std::uint32_t kChunkSize = 1u << 20;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t chunkSize;
+        std::uint32_t chunkCount;
+        std::int32_t level;
+        std::uint64_t rawSize;
+    };
+    struct ChunkEntry {
+        std::uint64_t offset;       // of the compressed bytes in the file
+        std::uint32_t packedSize;
+        std::uint32_t rawSize;
+        std::uint16_t checksum;     // qChecksum of the raw bytes
+        std::uint16_t reserved16;
+        std::uint32_t reserved32;
+    };
+    static_assert(sizeof(Header) == 32, "Header layout");
+    static_assert(sizeof(ChunkEntry) == 24, "ChunkEntry layout");
+
+    bool isContainer(const std::string& path);
+    // Compression level a container was written with; 0 if 'path' isn't one
+    int levelOf(const std::string& path);
+    // Reads chunks on the calling thread while workers inflate them into 'image'
+    bool read(const std::string& path, std::string& image);
+    // level 1..9 (zlib); chunks are compressed in parallel
+    bool write(const std::string& path, const char* data, std::size_t size, int level);
+}
+#endif // SCENECONTAINER_H
@@ -0,0 +1,73 @@
+#ifndef SCENEEDITLOG_H
+#define SCENEEDITLOG_H
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Model.h"
+#include "Light.h"
+// "<scene>.journal": append-only edits on top of a saved scene file, so small changes save in
+// milliseconds instead of rewriting the whole file.
+//   Header | Record*      Record = RecordHeader | payload
+// Records address models and lights by position, as they stand when the record is replayed.
+// The header stamps the base file (size, mtime); a journal for another base is ignored.
+// Each record carries a checksum, so a write torn by a crash only loses that last record.
+namespace SceneEditLog {
+    constexpr char kMagic[8] = {'S','C','E','N','E','J','\0','\0'};
+    constexpr std::uint32_t kVersion = 1;
+
+    enum class Op : std::uint8_t {
+        Clear, ModelAdd, ModelReplace, ModelRemove, ModelTransform, ModelLook,
+        LightAdd, LightSet, LightRemove
+    };
+    struct Stamp { std::uint64_t size{0}; std::int64_t mtime{0}; };
+    struct Header {
+        char magic[8];
+        std::uint32_t version, reserved;
+        std::uint64_t baseSize;
+        std::int64_t baseMtime;
+    };
+    struct RecordHeader {
+        std::uint32_t payloadSize;
+        std::uint16_t checksum;      // qChecksum of the payload
+        std::uint8_t op, reserved;
+        std::uint32_t index;         // model/light position (unused by Clear and the Add ops)
+    };
+    static_assert(sizeof(Header) == 32, "Header layout");
+    static_assert(sizeof(RecordHeader) == 12, "RecordHeader layout");
+
+    inline std::string pathFor(const std::string& scenePath){ return scenePath + ".journal"; }
+    bool stampOf(const std::string& path, Stamp& s);
+
+    // Record builders, each appends one framed record to 'out'
+    void recordClear(std::string& out);
+    void recordModel(std::string& out, Op op, std::uint32_t index, const Model& m);     // ModelAdd / ModelReplace
+    void recordTransform(std::string& out, std::uint32_t index, const std::array<float,16>& transform);
+    void recordLook(std::string& out, std::uint32_t index, const Material& material, const Texture& texture);
+    void recordLight(std::string& out, Op op, std::uint32_t index, const Light& l);     // LightAdd / LightSet
+    void recordRemove(std::string& out, Op op, std::uint32_t index);                    // ModelRemove / LightRemove
+
+    // Makes the journal ready to append for 'base': a stale one is deleted, a torn tail cut off.
+    // Returns its size in bytes (0 = no journal).
+    std::uint64_t prepare(const std::string& scenePath, const Stamp& base);
+    // Appends framed records (writing the header first if there is no journal yet); 'journalSize' gets the new size
+    bool append(const std::string& scenePath, const Stamp& base, const std::string& records, std::uint64_t& journalSize);
+    void remove(const std::string& scenePath);
+    // Header check only: a journal for the scene file as it is now
+    bool pending(const std::string& scenePath);
+
+    struct Edit {
+        Op op{Op::Clear};
+        std::uint32_t index{0};
+        std::unique_ptr<Model> model;        // ModelAdd, ModelReplace
+        std::unique_ptr<Light> light;        // LightAdd, LightSet
+        std::array<float,16> transform{};    // ModelTransform
+        Material material; Texture texture;  // ModelLook
+    };
+    // Decoded edits of a journal matching the current base; false if there is none
+    bool read(const std::string& scenePath, std::vector<Edit>& out);
+    // Replays edits onto lists loaded from the base file; out-of-range positions are skipped
+    void apply(std::vector<Edit>& edits, std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models);
+}
+#endif // SCENEEDITLOG_H
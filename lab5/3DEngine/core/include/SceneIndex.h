@@ -0,0 +1,35 @@
+#ifndef SCENEINDEX_H
+#define SCENEINDEX_H
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SceneText.h"
+class Model;
+// Table of contents of a scene file: enough to list its models and seek straight to them.
+// .sceneb carries it in its own tables; for .scene text it is built once (a full parse)
+// and cached next to the file as "<file>.idx", rebuilt when the scene's size/mtime change.
+// For compressed containers the offsets refer to the decoded image.
+struct SceneIndex {
+    struct ModelEntry {
+        std::string name;
+        std::uint64_t begin{0}, end{0};   // byte range of the model in the scene file
+        std::uint32_t ordinal{0};         // position in its MODELS section / model table
+        std::uint32_t meshCount{0};
+        std::uint64_t vertexCount{0}, indexCount{0};
+        float boundsMin[3]{0,0,0}, boundsMax[3]{0,0,0}; // model space
+        std::array<float,16> transform{1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1}; // column-major
+        // Bounds box moved by 'transform', i.e. where the model sits in the scene
+        void worldBounds(float lo[3], float hi[3]) const;
+    };
+    bool binary{false};
+    std::vector<SceneText::Span> lightSections; // text only
+    std::vector<ModelEntry> models;
+
+    bool read(const std::string& scenePath);
+    static std::string sidecarPath(const std::string& scenePath){ return scenePath + ".idx"; }
+};
+// Axis-aligned bounds over all meshes and cloud points; false (and zeros) if the model has neither.
+// Bounds recorded in the model's file are used as long as its meshes haven't been detached.
+bool modelBounds(const Model& m, float lo[3], float hi[3]);
+#endif // SCENEINDEX_H
@@ -0,0 +1,42 @@
+#ifndef SCENEJOURNAL_H
+#define SCENEJOURNAL_H
+#include <cstdint>
+#include <vector>
+// One compact record per scene edit; ids are Model::id / Light::id
+struct SceneChange {
+    enum class Kind : std::uint8_t {
+        ModelAdded, ModelRemoved, GeometryEdited, TransformEdited, TextureChanged,
+        LightAdded, LightRemoved, LightEdited,
+        Cleared
+    };
+    std::uint64_t version{0};
+    std::uint32_t id{0};
+    Kind kind{Kind::Cleared};
+};
+
+// Bounded, append-only log of scene edits with a monotonically increasing version.
+// Consumers remember the last version they saw and ask for everything after it;
+// if they fell behind the retained window they have to resync from the full scene.
+class SceneJournal {
+public:
+    static constexpr std::size_t kMaxEntries = 4096;
+    std::uint64_t version() const { return current; }
+    void record(SceneChange::Kind kind, std::uint32_t id){
+        if(entries.size() >= kMaxEntries){
+            // Drop the older half; consumers behind it will resync
+            entries.erase(entries.begin(), entries.begin() + kMaxEntries/2);
+        }
+        entries.push_back({++current, id, kind});
+    }
+    // Appends changes with version > since; false if some of them were already dropped
+    bool changesSince(std::uint64_t since, std::vector<SceneChange>& out) const {
+        if(since >= current) return true;
+        if(entries.empty() || entries.front().version > since + 1) return false;
+        for(const auto& c : entries) if(c.version > since) out.push_back(c);
+        return true;
+    }
+private:
+    std::vector<SceneChange> entries;
+    std::uint64_t current{0};
+};
+#endif // SCENEJOURNAL_H
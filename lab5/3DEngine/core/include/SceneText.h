@@ -0,0 +1,83 @@
+#ifndef SCENETEXT_H
+#define SCENETEXT_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Vec3.h"
+#include "Model.h"
+#include "Light.h"
+// Helpers for the fast .scene text loader: the file is read in one block, a sequential
+// pass walks the section structure and cuts the "v"/"i" runs into chunks, then the
+// chunks are parsed on all cores straight into preallocated mesh arrays.
+namespace SceneText {
+    bool readFile(const std::string& path, std::string& out);
+
+    // getline() over an in-memory buffer (same line splitting as std::getline on the file)
+    class LineCursor {
+    public:
+        LineCursor(const char* begin, const char* end) : p(begin), e(end) {}
+        bool getline(std::string& line);
+        // Skips up to 'count' lines; returns how many were there
+        std::size_t skip(std::size_t count);
+        const char* pos() const { return p; }
+    private:
+        const char* p;
+        const char* e;
+        const char* lineEnd(const char*& next) const;
+    };
+
+    // A run of consecutive data lines and where their values go
+    struct Chunk {
+        const char* begin{nullptr};
+        const char* end{nullptr};   // just past the last line
+        std::size_t lines{0};
+        std::size_t first{0};       // element index of the first line
+        Vec3* vertices{nullptr};    // "v x y z" lines, or
+        unsigned* indices{nullptr}; // "i n" lines
+    };
+    constexpr std::size_t kChunkLines = 16384;
+    // Skips 'count' lines at the cursor, appending one chunk per kChunkLines lines;
+    // returns the number of lines actually present
+    std::size_t collect(LineCursor& in, std::size_t count, std::vector<Chunk>& out);
+    void parseChunks(const Chunk* chunks, std::size_t count);
+    inline void parseChunks(const std::vector<Chunk>& chunks){ parseChunks(chunks.data(), chunks.size()); }
+
+    // One light or model in file order; byte offsets are relative to the parsed buffer
+    struct Parsed {
+        std::unique_ptr<Light> light;
+        std::unique_ptr<Model> model;
+        std::uint64_t begin{0}, end{0}; // model: from its NAME line to after its last index line
+        std::uint32_t ordinal{0};       // model: position inside its MODELS section
+        std::size_t chunkEnd{0};        // scan(): chunks up to here fill this and every earlier item
+    };
+    struct Span { std::uint64_t begin{0}, end{0}; };
+    // Both passes over a whole .scene (or a range holding complete sections); lightSections
+    // receives the byte range of every LIGHTS block
+    void parse(const char* begin, const char* end, std::vector<Parsed>& out, std::vector<Span>* lightSections = nullptr);
+    // Pass 1 only: models come back sized but empty until their chunks are parsed,
+    // so the caller can fill them a few at a time
+    void scan(const char* begin, const char* end, std::vector<Parsed>& out, std::vector<Chunk>& chunks, std::vector<Span>* lightSections = nullptr);
+    // Exactly one model record (a Parsed::begin..end range); null if the range is empty
+    std::unique_ptr<Model> parseModel(const char* begin, const char* end, int ordinal);
+
+    // Writer side: shortest round-trip formatting (std::to_chars), so a reload gives back
+    // exactly the same floats
+    void appendFloat(std::string& out, float v);
+    void appendUnsigned(std::string& out, std::size_t v);
+    // Output is a list of pieces: literal text, or a run of vertices/indices to format
+    struct Piece {
+        std::string text;
+        const Vec3* vertices{nullptr};
+        const unsigned* indices{nullptr};
+        std::size_t count{0};
+    };
+    // Splits data runs into kChunkLines pieces after the literal 'text'
+    void appendVertices(std::vector<Piece>& pieces, const Vec3* v, std::size_t count);
+    void appendIndices(std::vector<Piece>& pieces, const unsigned* idx, std::size_t count);
+    // Formats data pieces in parallel, a window at a time into reused buffers, and writes in order
+    bool writePieces(std::ostream& out, const std::vector<Piece>& pieces);
+}
+#endif // SCENETEXT_H
@@ -0,0 +1,31 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+#include <atomic>
+// Lock-free single-producer / single-consumer triple buffer.
+// The writer fills writeSlot() and publish()es it; the reader acquire()s the newest
+// published slot and keeps reading it until the next acquire. Neither side ever waits,
+// and slots are reused so their contents can keep allocated capacity between frames.
+template <class T>
+class TripleBuffer {
+public:
+    T& writeSlot() { return slots[writeIdx]; }
+    void publish() { writeIdx = middle.exchange(writeIdx | kFresh, std::memory_order_acq_rel) & kIndexMask; }
+    // Returns true if a newer slot was published since the last acquire
+    bool acquire() {
+        if(!(middle.load(std::memory_order_relaxed) & kFresh)) return false;
+        readIdx = middle.exchange(readIdx, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    T& readSlot() { return slots[readIdx]; }
+    const T& readSlot() const { return slots[readIdx]; }
+    // Only safe when neither side is running (setup / teardown)
+    T& slot(unsigned i) { return slots[i]; }
+private:
+    static constexpr unsigned kIndexMask = 3u;
+    static constexpr unsigned kFresh = 4u;
+    T slots[3]{};
+    unsigned writeIdx{0};
+    unsigned readIdx{2};
+    std::atomic<unsigned> middle{1};
+};
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,45 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(std::size_t initialBytes){ addBlock(initialBytes); frameHeapAllocs = 0; }
+
+void FrameArena::addBlock(std::size_t minBytes){
+	Block b;
+	b.size = std::max<std::size_t>(minBytes, 4096);
+	b.data.reset(new unsigned char[b.size]);
+	capacityBytes += b.size;
+	blocks.push_back(std::move(b));
+	++frameHeapAllocs; ++totalHeapAllocs;
+}
+
+void* FrameArena::allocate(std::size_t bytes, std::size_t align){
+	if(bytes == 0) bytes = 1;
+	while(true){
+		Block& b = blocks[current];
+		const auto base = reinterpret_cast<std::uintptr_t>(b.data.get());
+		const std::size_t aligned = ((base + offset + align - 1) & ~(std::uintptr_t(align) - 1)) - base;
+		if(aligned + bytes <= b.size){
+			usedBytes += (aligned - offset) + bytes;
+			offset = aligned + bytes;
+			return b.data.get() + aligned;
+		}
+		// Overflow: move to the next block, growing geometrically
+		if(current + 1 >= blocks.size()) addBlock(std::max(bytes + align, blocks.back().size * 2));
+		++current;
+		offset = 0;
+	}
+}
+
+void FrameArena::reset(){
+	peakBytes = std::max(peakBytes, usedBytes);
+	if(blocks.size() > 1){
+		// Consolidate so a frame of this size fits in one block from now on
+		const std::size_t total = capacityBytes;
+		blocks.clear();
+		capacityBytes = 0;
+		addBlock(total);
+	}
+	current = 0; offset = 0; usedBytes = 0;
+	frameHeapAllocs = 0;
+}
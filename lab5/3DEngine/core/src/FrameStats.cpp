@@ -0,0 +1,87 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+float msBetween(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b){
+	return std::chrono::duration<float, std::milli>(b - a).count();
+}
+// Nearest-rank percentile on an already sorted range
+float percentile(const std::vector<float>& sorted, float p){
+	if(sorted.empty()) return 0.f;
+	size_t rank = static_cast<size_t>(std::ceil(p * static_cast<float>(sorted.size())));
+	if(rank > 0) --rank;
+	return sorted[std::min(rank, sorted.size()-1)];
+}
+FrameStats::Percentiles summarize(std::vector<float>& v){
+	FrameStats::Percentiles out;
+	if(v.empty()) return out;
+	std::sort(v.begin(), v.end());
+	out.p50 = percentile(v, 0.50f);
+	out.p95 = percentile(v, 0.95f);
+	out.p99 = percentile(v, 0.99f);
+	out.max = v.back();
+	return out;
+}
+}
+
+void FrameStats::beginFrame(){ frameStart = Clock::now(); }
+
+void FrameStats::endFrame(){ lastCpuMs.store(msBetween(frameStart, Clock::now()), std::memory_order_relaxed); }
+
+bool FrameStats::presented(){
+	const auto now = Clock::now();
+	Sample s;
+	s.cpuMs = lastCpuMs.load(std::memory_order_relaxed);
+	s.presentMs = havePresent ? msBetween(lastPresent, now) : s.cpuMs;
+	s.events = pendingEvents.exchange(0, std::memory_order_relaxed);
+	lastPresent = now; havePresent = true;
+	ring[head] = s;
+	head = (head + 1) % kCapacity;
+	if(count < kCapacity) ++count;
+	++frames;
+	if(s.presentMs < hitchMs && s.cpuMs < hitchMs) return false;
+	Hitch& h = hitchRing[hitchHead];
+	h.frame = frames; h.cpuMs = s.cpuMs; h.presentMs = s.presentMs; h.events = s.events;
+	hitchHead = (hitchHead + 1) % kHitchHistory;
+	if(hitchCount < kHitchHistory) ++hitchCount;
+	++hitchTotal;
+	return true;
+}
+
+FrameStats::Report FrameStats::report() const{
+	Report r;
+	r.frames = count;
+	r.hitches = hitchTotal;
+	std::vector<float> cpu; cpu.reserve(count);
+	std::vector<float> present; present.reserve(count);
+	for(size_t i=0;i<count;i++){ cpu.push_back(ring[i].cpuMs); present.push_back(ring[i].presentMs); }
+	r.cpu = summarize(cpu);
+	r.present = summarize(present);
+	return r;
+}
+
+std::vector<FrameStats::Hitch> FrameStats::recentHitches() const{
+	std::vector<Hitch> out; out.reserve(hitchCount);
+	for(size_t i=0;i<hitchCount;i++) out.push_back(hitchRing[(hitchHead + kHitchHistory - hitchCount + i) % kHitchHistory]);
+	return out;
+}
+
+void FrameStats::reset(){
+	head = count = 0;
+	frames = 0;
+	hitchHead = hitchCount = hitchTotal = 0;
+	havePresent = false;
+	pendingEvents.store(0, std::memory_order_relaxed);
+}
+
+std::string FrameStats::eventNames(unsigned events){
+	if(!events) return "-";
+	std::string out;
+	auto add = [&](unsigned bit, const char* name){ if(events & bit){ if(!out.empty()) out += ", "; out += name; } };
+	add(TextureUpload, "texture upload");
+	add(SceneLoad, "scene load");
+	add(BufferGrowth, "buffer growth");
+	add(Resize, "resize");
+	return out;
+}
@@ -0,0 +1,173 @@
+#include "GeometryCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace GeometryCodec {
+
+namespace {
+constexpr std::size_t kBlock = 128;
+constexpr std::size_t kPad = 8; // trailing zeros so the unpacker can always load 8 bytes
+constexpr unsigned kFifo = 32;
+constexpr unsigned char kNextNew = kFifo;     // highest seen + 1
+constexpr unsigned char kLiteral = kFifo + 1; // followed by zigzag varint relative to highest + 1
+
+inline std::uint32_t zigzag(std::int32_t v){ return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31); }
+inline std::int32_t unzigzag(std::uint32_t v){ return static_cast<std::int32_t>(v >> 1) ^ -static_cast<std::int32_t>(v & 1); }
+inline unsigned bitWidth(std::uint32_t v){ unsigned w = 0; while(v){ ++w; v >>= 1; } return w; }
+
+void packBlock(const std::uint32_t* v, std::size_t n, unsigned w, std::string& out){
+	const std::size_t bytes = (n * w + 7) / 8;
+	const std::size_t start = out.size();
+	out.resize(start + bytes, '\0');
+	unsigned char* dst = reinterpret_cast<unsigned char*>(&out[start]);
+	std::size_t bit = 0;
+	for(std::size_t i=0;i<n;i++, bit += w){
+		std::uint64_t x = std::uint64_t(v[i]) << (bit & 7);
+		for(std::size_t b = bit >> 3; x; ++b, x >>= 8) dst[b] |= static_cast<unsigned char>(x);
+	}
+}
+
+// Branch-free: one unaligned 64-bit load per value (w <= 32, shift <= 7)
+inline void unpackBlock(const unsigned char* src, std::size_t n, unsigned w, std::uint32_t* v){
+	const std::uint64_t mask = w == 32 ? 0xffffffffull : ((1ull << w) - 1);
+	for(std::size_t i=0;i<n;i++){
+		const std::size_t bit = i * w;
+		std::uint64_t x; std::memcpy(&x, src + (bit >> 3), 8);
+		v[i] = static_cast<std::uint32_t>((x >> (bit & 7)) & mask);
+	}
+}
+
+inline std::uint64_t zigzag64(std::int64_t v){ return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63); }
+inline std::int64_t unzigzag64(std::uint64_t v){ return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1); }
+
+void putVarint(std::uint64_t v, std::string& out){
+	while(v >= 0x80){ out.push_back(static_cast<char>((v & 0x7f) | 0x80)); v >>= 7; }
+	out.push_back(static_cast<char>(v));
+}
+}
+
+bool encodePositions(const Vec3* v, std::size_t count, float maxError, Quantization& q, std::string& out){
+	out.clear();
+	if(!(maxError > 0.f)) return false;
+	float lo[3] = {0,0,0}, hi[3] = {0,0,0};
+	if(count){ lo[0]=hi[0]=v[0].x; lo[1]=hi[1]=v[0].y; lo[2]=hi[2]=v[0].z; }
+	for(std::size_t i=0;i<count;i++){
+		const float c[3] = {v[i].x, v[i].y, v[i].z};
+		for(int a=0;a<3;a++){ lo[a] = std::min(lo[a], c[a]); hi[a] = std::max(hi[a], c[a]); }
+	}
+	// Reconstruction rounds once more in float; keep that slack out of the half-step
+	float mag = 0.f;
+	for(int a=0;a<3;a++){
+		if(!std::isfinite(lo[a]) || !std::isfinite(hi[a])) return false;
+		mag = std::max({mag, std::fabs(lo[a]), std::fabs(hi[a])});
+	}
+	const float slack = 2.f * mag * std::numeric_limits<float>::epsilon();
+	if(slack * 2.f >= maxError) return false;
+	q.step = 2.f * (maxError - slack);
+	for(int a=0;a<3;a++){
+		q.origin[a] = lo[a];
+		// Past 2^24 steps float can't hold the grid anyway; keep such meshes raw
+		if(double(hi[a]) - double(lo[a]) > double(q.step) * double(1 << 24)) return false;
+	}
+	std::vector<std::uint32_t> deltas(count);
+	for(int a=0;a<3;a++){
+		std::int32_t prev = 0;
+		for(std::size_t i=0;i<count;i++){
+			const float c = a==0 ? v[i].x : (a==1 ? v[i].y : v[i].z);
+			const std::int32_t cur = static_cast<std::int32_t>(std::lround((double(c) - double(q.origin[a])) / double(q.step)));
+			deltas[i] = zigzag(cur - prev);
+			prev = cur;
+		}
+		for(std::size_t b=0;b<count;b+=kBlock){
+			const std::size_t n = std::min(kBlock, count - b);
+			std::uint32_t all = 0;
+			for(std::size_t i=0;i<n;i++) all |= deltas[b + i];
+			const unsigned w = bitWidth(all);
+			out.push_back(static_cast<char>(w));
+			packBlock(&deltas[b], n, w, out);
+		}
+	}
+	out.append(kPad, '\0');
+	return true;
+}
+
+bool decodePositions(const char* data, std::size_t size, std::size_t count, const Quantization& q, Vec3* out){
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+	const unsigned char* end = p + size;
+	if(size < kPad) return false;
+	std::uint32_t block[kBlock];
+	for(int a=0;a<3;a++){
+		std::uint32_t acc = 0;
+		const float origin = q.origin[a], step = q.step;
+		for(std::size_t b=0;b<count;b+=kBlock){
+			const std::size_t n = std::min(kBlock, count - b);
+			if(p >= end) return false;
+			const unsigned w = *p++;
+			const std::size_t bytes = (n * w + 7) / 8;
+			if(w > 32 || bytes + kPad > static_cast<std::size_t>(end - p)) return false;
+			unpackBlock(p, n, w, block);
+			p += bytes;
+			for(std::size_t i=0;i<n;i++){
+				acc += static_cast<std::uint32_t>(unzigzag(block[i]));
+				block[i] = acc;
+			}
+			float* dst = reinterpret_cast<float*>(out + b) + a;
+			for(std::size_t i=0;i<n;i++) dst[i*3] = origin + float(static_cast<std::int32_t>(block[i])) * step;
+		}
+	}
+	return true;
+}
+
+void encodeIndices(const unsigned* idx, std::size_t count, std::string& out){
+	out.clear();
+	out.reserve(count + 16);
+	unsigned fifo[kFifo]; unsigned head = 0; unsigned filled = 0;
+	std::int64_t highest = -1;
+	for(std::size_t i=0;i<count;i++){
+		const unsigned v = idx[i];
+		unsigned hit = kFifo;
+		for(unsigned k=0;k<filled;k++) if(fifo[(head - 1 - k) & (kFifo - 1)] == v){ hit = k; break; }
+		if(hit < kFifo){ out.push_back(static_cast<char>(hit)); continue; }
+		if(std::int64_t(v) == highest + 1) out.push_back(static_cast<char>(kNextNew));
+		else { out.push_back(static_cast<char>(kLiteral)); putVarint(zigzag64(std::int64_t(v) - (highest + 1)), out); }
+		highest = std::max<std::int64_t>(highest, v);
+		fifo[head & (kFifo - 1)] = v; ++head; filled = std::min(filled + 1, kFifo);
+	}
+}
+
+bool decodeIndices(const char* data, std::size_t size, std::size_t count, unsigned* out){
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+	const unsigned char* end = p + size;
+	unsigned fifo[kFifo] = {}; unsigned head = 0; unsigned filled = 0;
+	std::int64_t highest = -1;
+	for(std::size_t i=0;i<count;i++){
+		if(p >= end) return false;
+		const unsigned char c = *p++;
+		if(c < kFifo){
+			if(c >= filled) return false;
+			out[i] = fifo[(head - 1 - c) & (kFifo - 1)];
+			continue;
+		}
+		std::int64_t v = highest + 1;
+		if(c == kLiteral){
+			std::uint64_t z = 0; unsigned shift = 0;
+			while(true){
+				if(p >= end || shift > 35) return false;
+				const unsigned char b = *p++;
+				z |= std::uint64_t(b & 0x7f) << shift; shift += 7;
+				if(!(b & 0x80)) break;
+			}
+			v += unzigzag64(z);
+		} else if(c != kNextNew) return false;
+		if(v < 0 || v > std::int64_t(std::numeric_limits<unsigned>::max())) return false;
+		out[i] = static_cast<unsigned>(v);
+		highest = std::max(highest, v);
+		fifo[head & (kFifo - 1)] = out[i]; ++head; filled = std::min(filled + 1, kFifo);
+	}
+	return true;
+}
+
+}
@@ -0,0 +1,187 @@
+#include "JobSystem.h"
+#include <chrono>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+std::int64_t nowNs(){ return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count(); }
+
+// The pool and worker the current thread belongs to, if any
+thread_local const void* tlsSystem = nullptr;
+thread_local void* tlsWorker = nullptr;
+
+std::atomic<JobSystem*> installed{nullptr};
+
+void callFunction(void* context, std::size_t, std::size_t){
+	std::unique_ptr<std::function<void()>> f(static_cast<std::function<void()>*>(context));
+	(*f)();
+}
+}
+
+JobSystem& JobSystem::instance(){
+	if(JobSystem* system = installed.load(std::memory_order_acquire)) return *system;
+	static JobSystem system(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return system;
+}
+
+void JobSystem::setInstance(JobSystem& system){
+	installed.store(&system, std::memory_order_release);
+}
+
+JobSystem::JobSystem(unsigned workerCount) : currentIn(&JobSystem::currentOf){
+	statsSince.store(nowNs());
+	for(unsigned i=0;i<workerCount;i++){ workers.push_back(std::make_unique<Worker>()); workers.back()->index = i; }
+	for(auto& w : workers){ Worker* self = w.get(); self->thread = std::thread([this, self]{ workerLoop(self); }); }
+}
+
+JobSystem::~JobSystem(){
+	{ std::lock_guard<std::mutex> g(sleepMutex); quitting = true; }
+	wake.notify_all();
+	for(auto& w : workers) w->thread.join();
+}
+
+JobSystem::Worker* JobSystem::current() const{
+	return currentIn(this);
+}
+
+JobSystem::Worker* JobSystem::currentOf(const JobSystem* system){
+	return tlsSystem == system ? static_cast<Worker*>(tlsWorker) : nullptr;
+}
+
+void JobSystem::run(std::function<void()> job, Counter* counter){
+	if(counter) counter->count.fetch_add(1);
+	postFunction(std::move(job), counter);
+}
+
+void JobSystem::runAfter(Counter& dependency, std::function<void()> job, Counter* counter){
+	if(counter) counter->count.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> g(dependency.mutex);
+		if(dependency.count.load() != 0){ dependency.after.emplace_back(std::move(job), counter); return; }
+	}
+	postFunction(std::move(job), counter);
+}
+
+void JobSystem::postFunction(std::function<void()> job, Counter* counter){
+	post({callFunction, new std::function<void()>(std::move(job)), 0, 0, counter});
+}
+
+void JobSystem::post(const Job& job){
+	Worker* self = current();
+	if(workers.empty()){ execute(self, job, false); return; }
+	Worker* target = self ? self : workers[nextWorker.fetch_add(1) % workers.size()].get();
+	{
+		std::lock_guard<std::mutex> g(target->mutex);
+		if(target->tail - target->head < kDequeSize){
+			target->ring[target->tail++ % kDequeSize] = job;
+			target = nullptr;
+		}
+	}
+	// Deque full: the poster runs it
+	if(target){ execute(self, job, false); return; }
+	queued.fetch_add(1);
+	if(sleeping.load()){
+		{ std::lock_guard<std::mutex> g(sleepMutex); }
+		wake.notify_one();
+	}
+}
+
+bool JobSystem::take(Worker* self, const Counter* only, Job& out, bool& stolen){
+	if(self && !only){
+		std::lock_guard<std::mutex> g(self->mutex);
+		if(self->tail != self->head){
+			out = self->ring[--self->tail % kDequeSize];
+			queued.fetch_sub(1);
+			stolen = false;
+			return true;
+		}
+	}
+	const std::size_t n = workers.size();
+	const std::size_t start = self ? self->index : nextWorker.load();
+	for(std::size_t k=0;k<n;k++){
+		Worker* w = workers[(start + k) % n].get();
+		if(w == self && !only) continue;
+		std::lock_guard<std::mutex> g(w->mutex);
+		if(!only){
+			if(w->tail == w->head) continue;
+			out = w->ring[w->head++ % kDequeSize];
+		} else {
+			// Only jobs of the awaited counter: the newest, moving the back one into its place
+			std::size_t i = w->tail;
+			while(i != w->head && w->ring[(i - 1) % kDequeSize].counter != only) --i;
+			if(i == w->head) continue;
+			out = w->ring[(i - 1) % kDequeSize];
+			w->ring[(i - 1) % kDequeSize] = w->ring[(w->tail - 1) % kDequeSize];
+			--w->tail;
+		}
+		queued.fetch_sub(1);
+		stolen = w != self;
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::execute(Worker* self, const Job& job, bool stolen){
+	if(!self){ job.fn(job.context, job.begin, job.end); finish(job.counter); return; }
+	const std::int64_t start = nowNs();
+	job.fn(job.context, job.begin, job.end);
+	self->busyNs.fetch_add(static_cast<std::uint64_t>(nowNs() - start), std::memory_order_relaxed);
+	self->jobs.fetch_add(1, std::memory_order_relaxed);
+	if(stolen) self->stolen.fetch_add(1, std::memory_order_relaxed);
+	finish(job.counter);
+}
+
+void JobSystem::finish(Counter* counter){
+	if(!counter) return;
+	std::vector<std::pair<std::function<void()>, Counter*>> ready;
+	{
+		// Held across the decrement: wait() takes it before returning, so the counter outlives this
+		std::lock_guard<std::mutex> g(counter->mutex);
+		if(counter->count.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+		ready.swap(counter->after);
+	}
+	for(auto& r : ready) postFunction(std::move(r.first), r.second);
+}
+
+void JobSystem::wait(Counter& counter, int atMost){
+	Worker* self = current();
+	for(int idle = 0; counter.count.load(std::memory_order_acquire) > atMost; ){
+		Job job; bool stolen = false;
+		// Outside the pool only the counter's own jobs: the render thread mustn't pick up a load
+		if(take(self, self ? nullptr : &counter, job, stolen)){ execute(self, job, stolen); idle = 0; }
+		else if(++idle < 64) std::this_thread::yield();
+		else std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+	std::lock_guard<std::mutex> g(counter.mutex);
+}
+
+void JobSystem::workerLoop(Worker* self){
+	tlsSystem = this;
+	tlsWorker = self;
+	while(true){
+		Job job; bool stolen = false;
+		if(take(self, nullptr, job, stolen)){ execute(self, job, stolen); continue; }
+		std::unique_lock<std::mutex> g(sleepMutex);
+		sleeping.fetch_add(1);
+		wake.wait(g, [this]{ return quitting || queued.load() > 0; });
+		sleeping.fetch_sub(1);
+		if(quitting && queued.load() == 0) return;
+	}
+}
+
+std::vector<JobSystem::WorkerStats> JobSystem::stats() const{
+	const double elapsed = std::max<std::int64_t>(1, nowNs() - statsSince.load()) * 1e-9;
+	std::vector<WorkerStats> out;
+	for(const auto& w : workers){
+		WorkerStats s;
+		s.jobs = w->jobs.load(); s.stolen = w->stolen.load();
+		s.busySeconds = w->busyNs.load() * 1e-9;
+		s.utilisation = std::min(1.0, s.busySeconds / elapsed);
+		out.push_back(s);
+	}
+	return out;
+}
+
+void JobSystem::resetStats(){
+	for(auto& w : workers){ w->jobs.store(0); w->stolen.store(0); w->busyNs.store(0); }
+	statsSince.store(nowNs());
+}
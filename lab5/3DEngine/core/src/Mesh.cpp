@@ -1 +1,31 @@
-#include "Mesh.h"
\ No newline at end of file
+#include "Mesh.h"
+#include <cstdint>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+void Mesh::detach(){
+	if(!isView()) return;
+	vertices.assign(viewVertices, viewVertices + viewVertexCount);
+	indices.assign(viewIndices, viewIndices + viewIndexCount);
+	viewVertices = nullptr; viewIndices = nullptr;
+	viewVertexCount = viewIndexCount = 0;
+	backing.reset();
+}
+
+void Mesh::releasePages() const{
+#if defined(__linux__) && defined(MADV_PAGEOUT)
+	if(!isView()) return;
+	// PAGEOUT rather than DONTNEED: views may also sit on heap memory, which must survive
+	const std::uintptr_t page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+	auto release = [&](const void* p, std::size_t bytes){
+		if(!p || !bytes) return;
+		const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(p) & ~(page - 1);
+		const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(p) + bytes;
+		madvise(reinterpret_cast<void*>(begin), end - begin, MADV_PAGEOUT);
+	};
+	release(viewVertices, viewVertexCount * sizeof(Vec3));
+	release(viewIndices, viewIndexCount * sizeof(unsigned));
+#endif
+}
@@ -3,97 +3,468 @@
 #include <sstream>
 #include <string>
 #include <limits>
+#include <set>
+#include <algorithm>
+#include <filesystem>
 #include "Model.h"
 #include "Light.h"
+#include "SceneText.h"
+#include "SceneBinary.h"
+#include "SceneIndex.h"
+#include "SceneContainer.h"
+#include "SceneEditLog.h"
 
-static std::string trimLeft(const std::string& s){ size_t i=0; while(i<s.size() && std::isspace(static_cast<unsigned char>(s[i]))) ++i; return s.substr(i); }
+bool Scene::addModel(std::unique_ptr<Model> m){
+	if(!m || models.size()>=50) return false;
+	m->id = nextId++;
+	journal.record(SceneChange::Kind::ModelAdded, m->id);
+	models.push_back(std::move(m));
+	return true;
+}
+
+bool Scene::addLight(std::unique_ptr<Light> l){
+	if(!l || lights.size()>=10) return false;
+	l->id = nextId++;
+	journal.record(SceneChange::Kind::LightAdded, l->id);
+	lights.push_back(std::move(l));
+	return true;
+}
+
+bool Scene::removeModel(std::size_t index){
+	if(index >= models.size()) return false;
+	if(models[index]) journal.record(SceneChange::Kind::ModelRemoved, models[index]->id);
+	models.erase(models.begin() + static_cast<std::ptrdiff_t>(index));
+	return true;
+}
+
+bool Scene::removeLight(std::size_t index){
+	if(index >= lights.size()) return false;
+	if(lights[index]) journal.record(SceneChange::Kind::LightRemoved, lights[index]->id);
+	lights.erase(lights.begin() + static_cast<std::ptrdiff_t>(index));
+	return true;
+}
+
+void Scene::clear(){
+	models.clear(); lights.clear();
+	journal.record(SceneChange::Kind::Cleared, 0);
+}
+
+std::size_t Scene::merge(std::vector<std::unique_ptr<Light>>& newLights, std::vector<std::unique_ptr<Model>>& newModels){
+	for(auto& l : newLights) if(l && lights.size() < 10) addLight(std::move(l));
+	std::set<std::string> names;
+	for(const auto& m : models) if(m) names.insert(m->name);
+	std::size_t added = 0;
+	for(auto& m : newModels){
+		if(!m || models.size() >= 50) continue;
+		std::string name = m->name;
+		for(int n = 2; !name.empty() && names.count(name); n++) name = m->name + " (" + std::to_string(n) + ")";
+		m->name = name;
+		names.insert(name);
+		if(addModel(std::move(m))) added++;
+	}
+	newLights.erase(std::remove(newLights.begin(), newLights.end(), nullptr), newLights.end());
+	newModels.erase(std::remove(newModels.begin(), newModels.end(), nullptr), newModels.end());
+	return added;
+}
+
+std::shared_ptr<Model> Scene::findModel(std::uint32_t id) const{
+	for(const auto& m : models) if(m && m->id == id) return m;
+	return nullptr;
+}
+
+const Light* Scene::findLight(std::uint32_t id) const{
+	for(const auto& l : lights) if(l && l->id == id) return l.get();
+	return nullptr;
+}
+
+static bool hasSuffix(const std::string& s, const std::string& suffix){
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Decoded container payload: either format, optionally only some models
+static bool loadImage(Scene& scene, std::shared_ptr<std::string> image, const std::vector<std::size_t>* only, bool append){
+	if(SceneBinary::isBinaryImage(image->data(), image->size())) return SceneBinary::loadImage(std::move(image), scene, only, append);
+	std::vector<SceneText::Parsed> parsed;
+	SceneText::parse(image->data(), image->data() + image->size(), parsed);
+	std::vector<char> wanted;
+	if(only){
+		std::size_t modelCount = 0;
+		for(const auto& p : parsed) if(p.model) ++modelCount;
+		wanted.assign(modelCount, 0);
+		for(std::size_t i : *only){ if(i >= modelCount) return false; wanted[i] = 1; }
+	}
+	if(!append) scene.clear();
+	std::size_t model = 0;
+	for(auto& p : parsed){
+		if(p.light){ if(!append) scene.addLight(std::move(p.light)); continue; }
+		if(!only || wanted[model]) scene.addModel(std::move(p.model));
+		++model;
+	}
+	return true;
+}
+
+static bool loadBase(Scene& scene, const std::string& path){
+	if(SceneContainer::isContainer(path)){
+		auto image = std::make_shared<std::string>();
+		if(!SceneContainer::read(path, *image)) return false;
+		return loadImage(scene, std::move(image), nullptr, false);
+	}
+	// Binary scenes are recognised by content, whatever the extension
+	if(SceneBinary::isBinaryFile(path)) return SceneBinary::load(path, scene);
+	std::string buffer;
+	if(!SceneText::readFile(path, buffer)) return false;
+	scene.clear();
+	std::vector<SceneText::Parsed> parsed;
+	SceneText::parse(buffer.data(), buffer.data() + buffer.size(), parsed);
+	// Added after parsing, in file order, so ids match a sequential load
+	for(auto& p : parsed){
+		if(p.light) scene.addLight(std::move(p.light));
+		else scene.addModel(std::move(p.model));
+	}
+	return true;
+}
 
 bool Scene::loadFromFile(const std::string& path){
-	std::ifstream in(path);
+	if(SceneEditLog::pending(path)){
+		// Base file plus replayed journal, then added in the resulting order
+		std::vector<std::unique_ptr<Light>> newLights;
+		std::vector<std::unique_ptr<Model>> newModels;
+		const bool ok = streamFromFile(path, [&](LoadBatch& b){
+			for(auto& l : b.lights) newLights.push_back(std::move(l));
+			for(auto& m : b.models) newModels.push_back(std::move(m));
+			return true;
+		});
+		if(!ok) return false;
+		clear();
+		for(auto& l : newLights) addLight(std::move(l));
+		for(auto& m : newModels) addModel(std::move(m));
+	} else if(!loadBase(*this, path)) return false;
+	attachFile(path);
+	return true;
+}
+
+bool Scene::loadModels(const std::string& path, const std::vector<std::size_t>& which, bool append){
+	if(SceneContainer::isContainer(path)){
+		auto image = std::make_shared<std::string>();
+		if(!SceneContainer::read(path, *image)) return false;
+		return loadImage(*this, std::move(image), &which, append);
+	}
+	if(SceneBinary::isBinaryFile(path)) return SceneBinary::load(path, *this, &which, append);
+	SceneIndex index;
+	if(!index.read(path)) return false;
+	for(std::size_t i : which) if(i >= index.models.size()) return false;
+	std::ifstream in(path, std::ios::binary);
 	if(!in) return false;
-	models.clear(); lights.clear();
+	// Only the byte ranges of the light sections and the chosen models are read
+	std::string buffer;
+	auto readRange = [&](std::uint64_t begin, std::uint64_t end){
+		buffer.resize(static_cast<std::size_t>(end - begin));
+		in.seekg(static_cast<std::streamoff>(begin));
+		return buffer.empty() || static_cast<bool>(in.read(&buffer[0], static_cast<std::streamsize>(buffer.size())));
+	};
+	std::vector<std::unique_ptr<Light>> newLights;
+	if(!append){
+		for(const auto& r : index.lightSections){
+			if(!readRange(r.begin, r.end)) return false;
+			std::vector<SceneText::Parsed> parsed;
+			SceneText::parse(buffer.data(), buffer.data() + buffer.size(), parsed);
+			for(auto& p : parsed) if(p.light) newLights.push_back(std::move(p.light));
+		}
+	}
+	std::vector<std::unique_ptr<Model>> newModels;
+	for(std::size_t i : which){
+		const auto& e = index.models[i];
+		if(!readRange(e.begin, e.end)) return false;
+		auto m = SceneText::parseModel(buffer.data(), buffer.data() + buffer.size(), static_cast<int>(e.ordinal));
+		if(m) newModels.push_back(std::move(m));
+	}
+	if(!append) clear();
+	for(auto& l : newLights) addLight(std::move(l));
+	for(auto& m : newModels) addModel(std::move(m));
+	return true;
+}
+
+// Streaming batch sizes: enough geometry per batch to amortise the handoff, small enough that
+// models keep appearing while a large file loads
+static constexpr std::size_t kStreamChunks = 64; // text: about a million data lines
+static constexpr std::size_t kStreamModels = 4;  // binary: all models are ready at once
 
-	std::string line;
-	int expectLights = -1;
-	int expectModels = -1;
-	while(std::getline(in, line)){
-		if(line.empty()) continue;
-		std::istringstream ss(line);
-		std::string key; ss >> key;
-		if(key == "CAMERA"){
-			//keep current camera
-			continue;
-		} else if(key == "LIGHTS"){
-			ss >> expectLights;
-			for(int i=0;i<expectLights;i++){
-				if(!std::getline(in, line)) break; if(line.empty()){ --i; continue; }
-				std::istringstream ls(line); std::string lkey; ls >> lkey; if(lkey != "LIGHT"){ --i; continue; }
-				auto lt = std::make_unique<Light>();
-				int t=0; ls >> t;
-				lt->type = (t==1) ? Light::Type::Directional : Light::Type::Point;
-				ls >> lt->position.x >> lt->position.y >> lt->position.z;
-				ls >> lt->direction.x >> lt->direction.y >> lt->direction.z;
-				ls >> lt->color.r >> lt->color.g >> lt->color.b >> lt->color.a;
-				ls >> lt->intensity;
-				addLight(std::move(lt));
-			}
-		} else if(key == "MODELS"){
-			ss >> expectModels;
-			for(int mi=0; mi<expectModels; ++mi){
-				auto md = std::make_unique<Model>();
-				// NAME line
-				if(!std::getline(in, line)) break; if(line.rfind("NAME",0)==0){ md->name = trimLeft(line.substr(4)); if(!md->name.empty() && md->name[0]==' ') md->name.erase(0,1);} else { md->name = "model"+std::to_string(mi); }
-				// TEXTURE line
-				if(std::getline(in, line) && line.rfind("TEXTURE",0)==0){ std::string pathPart = trimLeft(line.substr(7)); if(!pathPart.empty() && pathPart[0]==' ') pathPart.erase(0,1); if(pathPart != "-" && !pathPart.empty()){ md->texture.file = pathPart; md->texture.loaded = true; } }
-				// MATERIAL line
-				if(std::getline(in, line) && line.rfind("MATERIAL",0)==0){ std::istringstream ms(line.substr(8)); ms >> md->material.diffuse.r >> md->material.diffuse.g >> md->material.diffuse.b >> md->material.diffuse.a; }
-				// MESHES line
-				int meshCount = 0; if(std::getline(in, line) && line.rfind("MESHES",0)==0){ std::istringstream mcs(line.substr(6)); mcs >> meshCount; }
-				for(int k=0;k<meshCount;k++){
-					// VERTICES
-					int vcount=0; if(!std::getline(in, line)) break; if(line.rfind("VERTICES",0)==0){ std::istringstream vs(line.substr(8)); vs >> vcount; }
-					std::vector<Vec3> verts; verts.reserve(vcount);
-					for(int vi=0; vi<vcount; ++vi){ if(!std::getline(in, line)) break; std::istringstream vls(line); char c; Vec3 v; vls >> c >> v.x >> v.y >> v.z; verts.push_back(v); }
-					// INDICES
-					int icount=0; if(!std::getline(in, line)) break; if(line.rfind("INDICES",0)==0){ std::istringstream is(line.substr(7)); is >> icount; }
-					std::vector<unsigned> idx; idx.reserve(icount);
-					for(int ii=0; ii<icount; ++ii){ if(!std::getline(in, line)) break; std::istringstream ils(line); char c; unsigned a; ils >> c >> a; idx.push_back(a); }
-					Mesh m; m.vertices = std::move(verts); m.indices = std::move(idx); md->meshes.push_back(std::move(m));
-				}
-				addModel(std::move(md));
-			}
+static bool streamText(const char* begin, const char* end, const std::function<bool(Scene::LoadBatch&)>& deliver){
+	std::vector<SceneText::Parsed> parsed;
+	std::vector<SceneText::Chunk> chunks;
+	SceneText::scan(begin, end, parsed, chunks);
+	std::size_t item = 0, done = 0;
+	while(item < parsed.size()){
+		// At least one item, then more while their chunks still fit in the batch
+		std::size_t last = item + 1;
+		while(last < parsed.size() && parsed[last].chunkEnd - done <= kStreamChunks) ++last;
+		const std::size_t chunkEnd = parsed[last - 1].chunkEnd;
+		SceneText::parseChunks(chunks.data() + done, chunkEnd - done);
+		done = chunkEnd;
+		Scene::LoadBatch batch;
+		for(; item < last; ++item){
+			if(parsed[item].light) batch.lights.push_back(std::move(parsed[item].light));
+			else if(parsed[item].model) batch.models.push_back(std::move(parsed[item].model));
 		}
+		batch.progress = chunks.empty() ? float(item) / float(parsed.size()) : float(done) / float(chunks.size());
+		if(!deliver(batch)) break;
 	}
 	return true;
 }
 
-bool Scene::saveToFile(const std::string& path) const{
-	std::ofstream f(path); if(!f) return false;
+static bool streamLists(std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models, const std::function<bool(Scene::LoadBatch&)>& deliver){
+	Scene::LoadBatch batch;
+	batch.lights = std::move(lights);
+	std::size_t next = 0;
+	do {
+		const std::size_t end = std::min(models.size(), next + kStreamModels);
+		for(; next < end; ++next) batch.models.push_back(std::move(models[next]));
+		batch.progress = models.empty() ? 1.f : float(next) / float(models.size());
+		if(!deliver(batch)) break;
+		batch = Scene::LoadBatch();
+	} while(next < models.size());
+	return true;
+}
+
+static bool streamBase(const std::string& path, const std::function<bool(Scene::LoadBatch&)>& deliver){
+	std::vector<std::unique_ptr<Light>> lights;
+	std::vector<std::unique_ptr<Model>> models;
+	if(SceneContainer::isContainer(path)){
+		auto image = std::make_shared<std::string>();
+		if(!SceneContainer::read(path, *image)) return false;
+		if(!SceneBinary::isBinaryImage(image->data(), image->size())) return streamText(image->data(), image->data() + image->size(), deliver);
+		if(!SceneBinary::readImage(std::move(image), lights, models)) return false;
+		return streamLists(lights, models, deliver);
+	}
+	if(SceneBinary::isBinaryFile(path)){
+		if(!SceneBinary::read(path, lights, models)) return false;
+		return streamLists(lights, models, deliver);
+	}
+	std::string buffer;
+	if(!SceneText::readFile(path, buffer)) return false;
+	return streamText(buffer.data(), buffer.data() + buffer.size(), deliver);
+}
+
+bool Scene::streamFromFile(const std::string& path, const std::function<bool(LoadBatch&)>& deliver){
+	std::vector<SceneEditLog::Edit> edits;
+	if(!SceneEditLog::read(path, edits) || edits.empty()) return streamBase(path, deliver);
+	// Edits address positions in the base file, so all of it is collected before replaying
+	std::vector<std::unique_ptr<Light>> lights;
+	std::vector<std::unique_ptr<Model>> models;
+	const bool ok = streamBase(path, [&](LoadBatch& b){
+		for(auto& l : b.lights) lights.push_back(std::move(l));
+		for(auto& m : b.models) models.push_back(std::move(m));
+		return true;
+	});
+	if(!ok) return false;
+	SceneEditLog::apply(edits, lights, models);
+	return streamLists(lights, models, deliver);
+}
+
+bool Scene::saveToFile(const std::string& path, int compressionLevel) const{
+	SaveOptions options;
+	options.compressionLevel = compressionLevel;
+	return saveToFile(path, options);
+}
+
+bool Scene::saveToFile(const std::string& path, const SaveOptions& options) const{
+	if(!writeFile(path, options)) return false;
+	// The new file is the base for journaled saves from here on
+	SceneEditLog::remove(path);
+	rebase(path, options);
+	return true;
+}
+
+bool Scene::hasPointClouds() const{
+	return std::any_of(models.begin(), models.end(), [](const std::shared_ptr<Model>& m){ return m && m->points; });
+}
+
+bool Scene::writeFile(const std::string& path, const SaveOptions& options) const{
+	if(hasPointClouds()) return false;
+	const bool binary = hasSuffix(path, ".sceneb");
+	SceneBinary::Encoding encoding;
+	encoding.positionError = options.positionError; encoding.packIndices = options.packIndices;
+	if(options.compressionLevel > 0){
+		// Build the plain image in memory, then wrap it in compressed chunks
+		std::string image;
+		if(binary){ if(!SceneBinary::saveImage(*this, image, encoding)) return false; }
+		else { std::ostringstream os; if(!writeText(os)) return false; image = os.str(); }
+		return SceneContainer::write(path, image.data(), image.size(), options.compressionLevel);
+	}
+	if(binary) return SceneBinary::save(*this, path, encoding);
+	// Written next to the target and renamed over it, so a failed save leaves the old file intact
+	const std::string temp = path + ".saving";
+	std::ofstream f(temp, std::ios::binary);
+	bool ok = f && writeText(f);
+	f.close();
+	std::error_code ec;
+	if(ok && !f.fail()) std::filesystem::rename(temp, path, ec);
+	else ok = false;
+	if(!ok || ec){ std::filesystem::remove(temp, ec); return false; }
+	return true;
+}
+
+void Scene::attachFile(const std::string& path){
+	SaveOptions options;
+	options.compressionLevel = SceneContainer::levelOf(path);
+	rebase(path, options);
+}
+
+void Scene::rebase(const std::string& path, const SaveOptions& options) const{
+	saved = SavedFile();
+	saved.generation = ++generations;
+	if(!SceneEditLog::stampOf(path, saved.base)) return;
+	saved.path = path; saved.options = options; saved.version = journal.version();
+	saved.journalBytes = SceneEditLog::prepare(path, saved.base);
+	for(const auto& m : models) if(m) saved.modelIds.push_back(m->id);
+	for(const auto& l : lights) if(l) saved.lightIds.push_back(l->id);
+}
+
+std::unique_ptr<Scene> Scene::snapshot() const{
+	auto s = std::make_unique<Scene>();
+	s->camera = camera; s->journal = journal; s->nextId = nextId;
+	s->saved = saved; s->snapshotOf = saved.generation;
+	for(const auto& l : lights) if(l) s->lights.push_back(std::make_unique<Light>(*l));
+	for(const auto& m : models){
+		if(!m) continue;
+		auto shell = std::make_shared<Model>();
+		shell->id = m->id; shell->name = m->name;
+		shell->material = m->material; shell->texture = m->texture; shell->transform = m->transform;
+		shell->points = m->points;
+		shell->boundsMin = m->boundsMin; shell->boundsMax = m->boundsMax;
+		shell->fileBounds = m->fileBounds; // cleared below if any mesh was detached
+		shell->meshes.resize(m->meshes.size());
+		for(std::size_t i=0;i<m->meshes.size();i++){
+			const Mesh& from = m->meshes[i];
+			Mesh& to = shell->meshes[i];
+			shell->fileBounds = shell->fileBounds && from.isView();
+			// Owned arrays are viewed where they are; the view keeps the live model alive
+			to.backing = from.isView() ? from.backing : std::shared_ptr<const void>(m);
+			to.viewVertices = from.vertexData(); to.viewVertexCount = from.vertexCount();
+			to.viewIndices = from.indexData(); to.viewIndexCount = from.indexCount();
+		}
+		s->models.push_back(std::move(shell));
+	}
+	return s;
+}
+
+bool Scene::adoptSave(const Scene& snapshot){
+	if(snapshot.saved.path.empty() || saved.generation != snapshot.snapshotOf) return false;
+	saved = snapshot.saved;
+	saved.generation = ++generations;
+	return true;
+}
+
+std::shared_ptr<Model> Scene::editableModel(std::size_t index){
+	if(index >= models.size() || !models[index]) return nullptr;
+	auto& m = models[index];
+	// Snapshot views and render deltas hold references; they keep the old copy
+	if(m.use_count() > 1) m = std::make_shared<Model>(*m);
+	return m;
+}
+
+static std::uint64_t journalSize(const std::string& path){
+	std::error_code ec;
+	const auto size = std::filesystem::file_size(SceneEditLog::pathFor(path), ec);
+	return ec ? 0 : size;
+}
+
+bool Scene::saveEdits(const std::string& path) const{
+	using Kind = SceneChange::Kind;
+	using SceneEditLog::Op;
+	if(hasPointClouds()) return false;
+	// Only on top of the exact file and journal this scene last loaded or saved
+	SceneEditLog::Stamp now;
+	std::vector<SceneChange> changes;
+	if(path != saved.path || !SceneEditLog::stampOf(path, now) || now.size != saved.base.size || now.mtime != saved.base.mtime
+	   || journalSize(path) != saved.journalBytes || !journal.changesSince(saved.version, changes))
+		return saveToFile(path, path == saved.path ? saved.options : SaveOptions());
+	// Replays the changes over the saved id order, recording current state by file position
+	std::vector<std::uint32_t> modelIds = saved.modelIds, lightIds = saved.lightIds;
+	auto position = [](const std::vector<std::uint32_t>& ids, std::uint32_t id){
+		return static_cast<std::size_t>(std::find(ids.begin(), ids.end(), id) - ids.begin());
+	};
+	// Records carry current state, so each model/light needs at most one of each kind
+	std::set<std::pair<std::uint32_t, Kind>> written;
+	auto once = [&](std::uint32_t id, std::initializer_list<Kind> kinds){
+		const bool first = !written.count({id, *kinds.begin()});
+		for(Kind k : kinds) written.insert({id, k});
+		return first;
+	};
+	const std::initializer_list<Kind> wholeModel = {Kind::GeometryEdited, Kind::TransformEdited, Kind::TextureChanged};
+	std::string records;
+	for(const auto& c : changes){
+		const std::size_t mi = position(modelIds, c.id), li = position(lightIds, c.id);
+		const auto m = findModel(c.id);
+		const Light* l = findLight(c.id);
+		const bool model = m && mi < modelIds.size(), light = l && li < lightIds.size();
+		const auto at = [](std::size_t i){ return static_cast<std::uint32_t>(i); };
+		switch(c.kind){
+		case Kind::Cleared: SceneEditLog::recordClear(records); modelIds.clear(); lightIds.clear(); break;
+		// Models and lights added and removed again since the last save never reach the file
+		case Kind::ModelAdded: if(m){ once(c.id, wholeModel); SceneEditLog::recordModel(records, Op::ModelAdd, 0, *m); modelIds.push_back(c.id); } break;
+		case Kind::ModelRemoved: if(mi < modelIds.size()){ SceneEditLog::recordRemove(records, Op::ModelRemove, at(mi)); modelIds.erase(modelIds.begin() + static_cast<std::ptrdiff_t>(mi)); } break;
+		case Kind::GeometryEdited: if(model && once(c.id, wholeModel)) SceneEditLog::recordModel(records, Op::ModelReplace, at(mi), *m); break;
+		case Kind::TransformEdited: if(model && once(c.id, {Kind::TransformEdited})) SceneEditLog::recordTransform(records, at(mi), m->transform); break;
+		case Kind::TextureChanged: if(model && once(c.id, {Kind::TextureChanged})) SceneEditLog::recordLook(records, at(mi), m->material, m->texture); break;
+		case Kind::LightAdded: if(l){ once(c.id, {Kind::LightEdited}); SceneEditLog::recordLight(records, Op::LightAdd, 0, *l); lightIds.push_back(c.id); } break;
+		case Kind::LightRemoved: if(li < lightIds.size()){ SceneEditLog::recordRemove(records, Op::LightRemove, at(li)); lightIds.erase(lightIds.begin() + static_cast<std::ptrdiff_t>(li)); } break;
+		case Kind::LightEdited: if(light && once(c.id, {Kind::LightEdited})) SceneEditLog::recordLight(records, Op::LightSet, at(li), *l); break;
+		}
+	}
+	// The replayed order has to come out as ours; otherwise write everything
+	std::vector<std::uint32_t> currentModels, currentLights;
+	for(const auto& mp : models) if(mp) currentModels.push_back(mp->id);
+	for(const auto& lp : lights) if(lp) currentLights.push_back(lp->id);
+	if(modelIds != currentModels || lightIds != currentLights) return saveToFile(path, saved.options);
+	if(!records.empty() && !SceneEditLog::append(path, saved.base, records, saved.journalBytes)) return saveToFile(path, saved.options);
+	saved.version = journal.version();
+	saved.modelIds = std::move(modelIds); saved.lightIds = std::move(lightIds);
+	if(saved.journalBytes > std::max(kCompactMinBytes, saved.base.size / 2)) return compactFile(path);
+	return true;
+}
+
+bool Scene::compactFile(const std::string& path) const{
+	return saveToFile(path, path == saved.path ? saved.options : SaveOptions());
+}
+
+bool Scene::writeText(std::ostream& f) const{
+	// Large files go through reusable buffers; headers are collected as literal pieces
+	std::vector<SceneText::Piece> pieces(1);
+	auto text = [&](const char* s){ pieces.back().text += s; };
+	auto num = [&](float v){ SceneText::appendFloat(pieces.back().text, v); };
+	auto count = [&](std::size_t v){ SceneText::appendUnsigned(pieces.back().text, v); };
+	auto sp = [&](float v){ text(" "); num(v); };
 	// Camera
-	f << "CAMERA " << camera.position.x << ' ' << camera.position.y << ' ' << camera.position.z
-	  << ' ' << camera.yaw << ' ' << camera.pitch << ' ' << camera.fov << "\n";
+	text("CAMERA"); sp(camera.position.x); sp(camera.position.y); sp(camera.position.z);
+	sp(camera.yaw); sp(camera.pitch); sp(camera.fov); text("\n");
 	// Lights
-	f << "LIGHTS " << lights.size() << "\n";
+	text("LIGHTS "); count(lights.size()); text("\n");
 	for(const auto& lp : lights){ const Light* l = lp.get(); if(!l) continue;
 		int t = (l->type == Light::Type::Directional) ? 1 : 0;
-		f << "LIGHT " << t << ' ' << l->position.x << ' ' << l->position.y << ' ' << l->position.z
-		  << ' ' << l->direction.x << ' ' << l->direction.y << ' ' << l->direction.z
-		  << ' ' << l->color.r << ' ' << l->color.g << ' ' << l->color.b << ' ' << l->color.a
-		  << ' ' << l->intensity << "\n";
+		text(t ? "LIGHT 1" : "LIGHT 0"); sp(l->position.x); sp(l->position.y); sp(l->position.z);
+		sp(l->direction.x); sp(l->direction.y); sp(l->direction.z);
+		sp(l->color.r); sp(l->color.g); sp(l->color.b); sp(l->color.a);
+		sp(l->intensity); text("\n");
 	}
 	// Models
-	f << "MODELS " << models.size() << "\n";
+	static const std::array<float,16> kIdentity = Model().transform;
+	text("MODELS "); count(models.size()); text("\n");
 	for(const auto& mp : models){ const Model* m = mp.get(); if(!m) continue;
-		f << "NAME " << m->name << "\n";
-		f << "TEXTURE " << (m->texture.file.empty() ? "-" : m->texture.file) << "\n";
-		f << "MATERIAL " << m->material.diffuse.r << ' ' << m->material.diffuse.g << ' ' << m->material.diffuse.b << ' ' << m->material.diffuse.a << "\n";
-		f << "MESHES " << m->meshes.size() << "\n";
+		text("NAME "); pieces.back().text += m->name; text("\n");
+		text("TEXTURE "); pieces.back().text += (m->texture.file.empty() ? "-" : m->texture.file); text("\n");
+		text("MATERIAL"); sp(m->material.diffuse.r); sp(m->material.diffuse.g); sp(m->material.diffuse.b); sp(m->material.diffuse.a); text("\n");
+		// Only when placed, so untransformed scenes still read in older versions
+		if(m->transform != kIdentity){ text("TRANSFORM"); for(float f : m->transform) sp(f); text("\n"); }
+		text("MESHES "); count(m->meshes.size()); text("\n");
 		for(const auto& mesh : m->meshes){
-			f << "VERTICES " << mesh.vertices.size() << "\n";
-			for(const auto& v : mesh.vertices){ f << 'v' << ' ' << v.x << ' ' << v.y << ' ' << v.z << "\n"; }
-			f << "INDICES " << mesh.indices.size() << "\n";
-			for(const auto& ii : mesh.indices){ f << 'i' << ' ' << ii << "\n"; }
+			text("VERTICES "); count(mesh.vertexCount()); text("\n");
+			SceneText::appendVertices(pieces, mesh.vertexData(), mesh.vertexCount());
+			if(mesh.vertexCount()) pieces.emplace_back();
+			text("INDICES "); count(mesh.indexCount()); text("\n");
+			SceneText::appendIndices(pieces, mesh.indexData(), mesh.indexCount());
+			if(mesh.indexCount()) pieces.emplace_back();
 		}
 	}
-	return true;
-}
\ No newline at end of file
+	return SceneText::writePieces(f, pieces);
+}
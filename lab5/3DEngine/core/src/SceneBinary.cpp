@@ -0,0 +1,424 @@
+#include "SceneBinary.h"
+#include "Scene.h"
+#include "SceneIndex.h"
+#include "GeometryCodec.h"
+#include "JobSystem.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QByteArray>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+static_assert(sizeof(Vec3) == 12, "Vec3 must be three packed floats");
+
+namespace SceneBinary {
+
+namespace {
+// Keeps the file mapped for as long as any Mesh view points into it
+struct MappedFile {
+	QByteArray fallback; // used if the platform refuses to map (e.g. some network shares)
+	const uchar* data{nullptr};
+	qint64 size{0};
+#ifdef _WIN32
+	// Mapped natively with delete sharing and the handles closed, so a save can rename the file
+	// aside while views still read it (writeFile); QFile's handle would forbid that
+	void* view{nullptr};
+	~MappedFile(){ if(view) UnmapViewOfFile(view); }
+	bool open(const std::string& path){
+		const std::wstring wpath = QString::fromStdString(path).toStdWString();
+		HANDLE f = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if(f == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER n{};
+		if(GetFileSizeEx(f, &n) && n.QuadPart > 0){
+			size = n.QuadPart;
+			// The view keeps the section alive once both handles are closed
+			if(HANDLE m = CreateFileMappingW(f, nullptr, PAGE_READONLY, 0, 0, nullptr)){ view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0); CloseHandle(m); }
+		}
+		CloseHandle(f);
+		if(size <= 0) return false;
+		if(view){ data = static_cast<const uchar*>(view); return true; }
+		QFile file(QString::fromStdString(path));
+		if(!file.open(QIODevice::ReadOnly)) return false;
+		fallback = file.readAll();
+		if(fallback.size() != size) return false;
+		data = reinterpret_cast<const uchar*>(fallback.constData());
+		return true;
+	}
+#else
+	QFile file;
+	bool mapped{false};
+	~MappedFile(){ if(mapped) file.unmap(const_cast<uchar*>(data)); }
+	bool open(const std::string& path){
+		file.setFileName(QString::fromStdString(path));
+		if(!file.open(QIODevice::ReadOnly)) return false;
+		size = file.size();
+		if(size <= 0) return false;
+		if(uchar* p = file.map(0, size)){ data = p; mapped = true; return true; }
+		fallback = file.readAll();
+		if(fallback.size() != size) return false;
+		data = reinterpret_cast<const uchar*>(fallback.constData());
+		return true;
+	}
+#endif
+};
+
+bool inRange(std::uint64_t offset, std::uint64_t count, std::uint64_t elemSize, std::uint64_t fileSize){
+	if(offset > fileSize) return false;
+	if(elemSize && count > (fileSize - offset) / elemSize) return false;
+	return true;
+}
+
+template <class T> T readAt(const uchar* base, std::uint64_t offset){ T v; std::memcpy(&v, base + offset, sizeof(T)); return v; }
+
+std::uint64_t alignUp(std::uint64_t v){ return (v + kAlign - 1) & ~(kAlign - 1); }
+
+template <class Job> void runParallel(std::size_t count, const Job& job){ JobSystem::instance().parallelFor(count, job); }
+}
+
+bool supportedVersion(const FileHeader& h){
+	return (h.version == kVersionRaw || h.version == kVersion) && h.byteOrder == kByteOrder;
+}
+
+MeshRecord readMeshRecord(const char* data, const FileHeader& h, std::uint64_t i){
+	MeshRecord r{};
+	std::memcpy(&r, data + h.meshesOffset + i * meshRecordSize(h.version), static_cast<std::size_t>(meshRecordSize(h.version)));
+	if(h.version == kVersionRaw){
+		r.verticesBytes = r.vertexCount * sizeof(Vec3); r.indicesBytes = r.indexCount * sizeof(unsigned);
+		r.vertexCodec = GeometryCodec::RawVertices; r.indexCodec = GeometryCodec::RawIndices;
+	}
+	return r;
+}
+
+bool isBinaryFile(const std::string& path){
+	std::ifstream in(path, std::ios::binary);
+	char magic[sizeof(kMagic)] = {};
+	if(!in.read(magic, sizeof(magic))) return false;
+	return std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+// Shared by the mapped-file and in-memory paths; 'keep' owns the bytes the views point into.
+// Nothing is output unless the whole selection validates and decodes.
+static bool readFrom(std::shared_ptr<const void> keep, const uchar* base, std::uint64_t size, const std::vector<std::size_t>* only, bool withLights,
+                     std::vector<std::unique_ptr<Light>>& lightsOut, std::vector<std::unique_ptr<Model>>& modelsOut){
+	if(size < sizeof(FileHeader)) return false;
+	const FileHeader h = readAt<FileHeader>(base, 0);
+	if(std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || !supportedVersion(h)) return false;
+	if(h.fileSize != size) return false;
+	if(!inRange(h.lightsOffset, h.lightCount, sizeof(LightRecord), size)
+	   || !inRange(h.modelsOffset, h.modelCount, sizeof(ModelRecord), size)
+	   || !inRange(h.meshesOffset, h.meshCount, meshRecordSize(h.version), size)
+	   || !inRange(h.stringsOffset, h.stringsSize, 1, size)) return false;
+	auto str = [&](std::uint64_t off, std::uint32_t len, std::string& out){
+		if(off > h.stringsSize || len > h.stringsSize - off) return false;
+		out.assign(reinterpret_cast<const char*>(base + h.stringsOffset + off), len);
+		return true;
+	};
+
+	// Validate and decode everything first, so a bad file leaves the caller's scene as it was
+	std::vector<char> wanted(h.modelCount, only ? 0 : 1);
+	if(only) for(std::size_t i : *only){ if(i >= h.modelCount) return false; wanted[i] = 1; }
+	std::vector<std::unique_ptr<Model>> models;
+	struct Encoded { Mesh* mesh; MeshRecord record; };
+	std::vector<Encoded> encoded;
+	for(std::uint32_t i=0;i<h.modelCount;i++){
+		if(!wanted[i]) continue;
+		const ModelRecord r = readAt<ModelRecord>(base, h.modelsOffset + std::uint64_t(i)*sizeof(ModelRecord));
+		auto md = std::make_unique<Model>();
+		std::string texture;
+		if(!str(r.nameOffset, r.nameSize, md->name) || !str(r.textureOffset, r.textureSize, texture)) return false;
+		if(!texture.empty()){ md->texture.file = texture; md->texture.loaded = true; }
+		md->material.diffuse = {r.diffuse[0], r.diffuse[1], r.diffuse[2], r.diffuse[3]};
+		std::copy(r.transform, r.transform + 16, md->transform.begin());
+		if(r.firstMesh > h.meshCount || r.meshCount > h.meshCount - r.firstMesh) return false;
+		md->meshes.resize(r.meshCount);
+		std::copy(r.boundsMin, r.boundsMin + 3, md->boundsMin.begin());
+		std::copy(r.boundsMax, r.boundsMax + 3, md->boundsMax.begin());
+		for(std::uint32_t k=0;k<r.meshCount;k++){
+			const MeshRecord mr = readMeshRecord(reinterpret_cast<const char*>(base), h, std::uint64_t(r.firstMesh) + k);
+			md->fileBounds = md->fileBounds || mr.vertexCount > 0;
+			if(!inRange(mr.verticesOffset, mr.verticesBytes, 1, size) || !inRange(mr.indicesOffset, mr.indicesBytes, 1, size)) return false;
+			Mesh& m = md->meshes[k];
+			if(mr.vertexCodec != GeometryCodec::RawVertices || mr.indexCodec != GeometryCodec::RawIndices){
+				// Decoded below; the counts are capped by what the streams could possibly hold
+				if(mr.vertexCodec > GeometryCodec::QuantDelta || mr.indexCodec > GeometryCodec::IndexFifo) return false;
+				const std::uint64_t maxVertices = mr.vertexCodec == GeometryCodec::RawVertices ? mr.verticesBytes / sizeof(Vec3) : mr.verticesBytes * 128;
+				const std::uint64_t maxIndices = mr.indexCodec == GeometryCodec::RawIndices ? mr.indicesBytes / sizeof(unsigned) : mr.indicesBytes;
+				if(mr.vertexCount > maxVertices || mr.indexCount > maxIndices) return false;
+				encoded.push_back({&m, mr});
+				continue;
+			}
+			if(mr.verticesOffset % alignof(Vec3) || mr.indicesOffset % alignof(unsigned)) return false;
+			if(mr.verticesBytes != mr.vertexCount * sizeof(Vec3) || mr.indicesBytes != mr.indexCount * sizeof(unsigned)) return false;
+			m.backing = keep;
+			m.viewVertices = reinterpret_cast<const Vec3*>(base + mr.verticesOffset);
+			m.viewVertexCount = static_cast<std::size_t>(mr.vertexCount);
+			m.viewIndices = reinterpret_cast<const unsigned*>(base + mr.indicesOffset);
+			m.viewIndexCount = static_cast<std::size_t>(mr.indexCount);
+		}
+		models.push_back(std::move(md));
+	}
+	// Meshes are independent, so they decode in parallel
+	std::atomic<bool> failed{false};
+	runParallel(encoded.size(), [&](std::size_t i){
+		const MeshRecord& mr = encoded[i].record;
+		Mesh& m = *encoded[i].mesh;
+		const char* bytes = reinterpret_cast<const char*>(base);
+		m.vertices.resize(static_cast<std::size_t>(mr.vertexCount));
+		m.indices.resize(static_cast<std::size_t>(mr.indexCount));
+		bool ok = true;
+		if(mr.vertexCodec == GeometryCodec::QuantDelta){
+			GeometryCodec::Quantization q;
+			std::copy(mr.quantOrigin, mr.quantOrigin + 3, q.origin); q.step = mr.quantStep;
+			ok = GeometryCodec::decodePositions(bytes + mr.verticesOffset, mr.verticesBytes, m.vertices.size(), q, m.vertices.data());
+		} else if(mr.vertexCount) std::memcpy(m.vertices.data(), bytes + mr.verticesOffset, m.vertices.size() * sizeof(Vec3));
+		if(mr.indexCodec == GeometryCodec::IndexFifo)
+			ok = ok && GeometryCodec::decodeIndices(bytes + mr.indicesOffset, mr.indicesBytes, m.indices.size(), m.indices.data());
+		else if(mr.indexCount) std::memcpy(m.indices.data(), bytes + mr.indicesOffset, m.indices.size() * sizeof(unsigned));
+		if(!ok) failed = true;
+	});
+	if(failed) return false;
+
+	for(std::uint32_t i=0; withLights && i<h.lightCount; i++){
+		const LightRecord r = readAt<LightRecord>(base, h.lightsOffset + std::uint64_t(i)*sizeof(LightRecord));
+		auto lt = std::make_unique<Light>();
+		lt->type = (r.type==1) ? Light::Type::Directional : Light::Type::Point;
+		lt->position = {r.position[0], r.position[1], r.position[2]};
+		lt->direction = {r.direction[0], r.direction[1], r.direction[2]};
+		lt->color = {r.color[0], r.color[1], r.color[2], r.color[3]};
+		lt->intensity = r.intensity;
+		lightsOut.push_back(std::move(lt));
+	}
+	for(auto& md : models) modelsOut.push_back(std::move(md));
+	return true;
+}
+
+static bool readFile(const std::string& path, const std::vector<std::size_t>* only, bool withLights,
+                     std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models){
+	auto file = std::make_shared<MappedFile>();
+	if(!file->open(path)) return false;
+	return readFrom(file, file->data, static_cast<std::uint64_t>(file->size), only, withLights, lights, models);
+}
+
+static bool readImageFrom(std::shared_ptr<const std::string> image, const std::vector<std::size_t>* only, bool withLights,
+                          std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models){
+	if(!image) return false;
+	const uchar* base = reinterpret_cast<const uchar*>(image->data());
+	const std::uint64_t size = image->size();
+	return readFrom(std::move(image), base, size, only, withLights, lights, models);
+}
+
+// Camera is kept, as with the text format; 'append' also keeps the scene's lights
+static void apply(Scene& scene, bool append, std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models){
+	if(!append) scene.clear();
+	for(auto& lt : lights) scene.addLight(std::move(lt));
+	for(auto& md : models) scene.addModel(std::move(md));
+}
+
+bool load(const std::string& path, Scene& scene, const std::vector<std::size_t>* only, bool append){
+	std::vector<std::unique_ptr<Light>> lights; std::vector<std::unique_ptr<Model>> models;
+	if(!readFile(path, only, !append, lights, models)) return false;
+	apply(scene, append, lights, models);
+	return true;
+}
+
+bool loadImage(std::shared_ptr<const std::string> image, Scene& scene, const std::vector<std::size_t>* only, bool append){
+	std::vector<std::unique_ptr<Light>> lights; std::vector<std::unique_ptr<Model>> models;
+	if(!readImageFrom(std::move(image), only, !append, lights, models)) return false;
+	apply(scene, append, lights, models);
+	return true;
+}
+
+bool read(const std::string& path, std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models){
+	return readFile(path, nullptr, true, lights, models);
+}
+
+bool readImage(std::shared_ptr<const std::string> image, std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models){
+	return readImageFrom(std::move(image), nullptr, true, lights, models);
+}
+
+bool isBinaryImage(const char* data, std::size_t size){
+	return size >= sizeof(kMagic) && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+// Streams the image through 'put'; used for files and for in-memory images
+static bool writeImage(const Camera& cam, const std::vector<const Light*>& sceneLights, const std::vector<const Model*>& sceneModels,
+                       const Encoding& encoding, const std::function<bool(const void*, std::uint64_t)>& write){
+	FileHeader h{};
+	std::memcpy(h.magic, kMagic, sizeof(kMagic));
+	h.byteOrder = kByteOrder;
+	const float camera[6] = {cam.position.x, cam.position.y, cam.position.z, cam.yaw, cam.pitch, cam.fov};
+	std::copy(camera, camera + 6, h.camera);
+
+	std::vector<LightRecord> lights;
+	for(const Light* l : sceneLights){ if(!l) continue;
+		LightRecord r{};
+		r.type = (l->type == Light::Type::Directional) ? 1 : 0;
+		r.position[0] = l->position.x; r.position[1] = l->position.y; r.position[2] = l->position.z;
+		r.direction[0] = l->direction.x; r.direction[1] = l->direction.y; r.direction[2] = l->direction.z;
+		r.color[0] = l->color.r; r.color[1] = l->color.g; r.color[2] = l->color.b; r.color[3] = l->color.a;
+		r.intensity = l->intensity;
+		lights.push_back(r);
+	}
+
+	std::vector<ModelRecord> models;
+	std::vector<MeshRecord> meshes;
+	std::vector<const Mesh*> meshSources;
+	std::string strings;
+	for(const Model* m : sceneModels){ if(!m) continue;
+		ModelRecord r{};
+		r.nameOffset = strings.size(); r.nameSize = static_cast<std::uint32_t>(m->name.size()); strings += m->name;
+		r.textureOffset = strings.size(); r.textureSize = static_cast<std::uint32_t>(m->texture.file.size()); strings += m->texture.file;
+		r.diffuse[0] = m->material.diffuse.r; r.diffuse[1] = m->material.diffuse.g; r.diffuse[2] = m->material.diffuse.b; r.diffuse[3] = m->material.diffuse.a;
+		std::copy(m->transform.begin(), m->transform.end(), r.transform);
+		r.firstMesh = static_cast<std::uint32_t>(meshes.size());
+		r.meshCount = static_cast<std::uint32_t>(m->meshes.size());
+		for(const auto& mesh : m->meshes){
+			MeshRecord mr{};
+			mr.vertexCount = mesh.vertexCount(); mr.indexCount = mesh.indexCount();
+			meshes.push_back(mr);
+			meshSources.push_back(&mesh);
+		}
+		modelBounds(*m, r.boundsMin, r.boundsMax);
+		models.push_back(r);
+	}
+
+	// Encoded streams are kept only where they beat the raw array
+	std::vector<std::string> packedVertices(meshes.size()), packedIndices(meshes.size());
+	runParallel(meshes.size(), [&](std::size_t i){
+		MeshRecord& mr = meshes[i];
+		const Mesh& mesh = *meshSources[i];
+		mr.verticesBytes = mr.vertexCount * sizeof(Vec3); mr.indicesBytes = mr.indexCount * sizeof(unsigned);
+		GeometryCodec::Quantization q;
+		if(encoding.positionError > 0.f && mr.vertexCount
+		   && GeometryCodec::encodePositions(mesh.vertexData(), mesh.vertexCount(), encoding.positionError, q, packedVertices[i])
+		   && packedVertices[i].size() < mr.verticesBytes){
+			mr.vertexCodec = GeometryCodec::QuantDelta; mr.verticesBytes = packedVertices[i].size();
+			std::copy(q.origin, q.origin + 3, mr.quantOrigin); mr.quantStep = q.step;
+		} else std::string().swap(packedVertices[i]);
+		if(encoding.packIndices && mr.indexCount){
+			GeometryCodec::encodeIndices(mesh.indexData(), mesh.indexCount(), packedIndices[i]);
+			if(packedIndices[i].size() < mr.indicesBytes){ mr.indexCodec = GeometryCodec::IndexFifo; mr.indicesBytes = packedIndices[i].size(); }
+			else std::string().swap(packedIndices[i]);
+		}
+	});
+	const bool anyCodec = std::any_of(meshes.begin(), meshes.end(), [](const MeshRecord& mr){
+		return mr.vertexCodec != GeometryCodec::RawVertices || mr.indexCodec != GeometryCodec::RawIndices;
+	});
+	h.version = anyCodec ? kVersion : kVersionRaw;
+	const std::uint64_t recordSize = meshRecordSize(h.version);
+
+	// Layout: tables are 8-byte multiples, arrays start on kAlign boundaries
+	h.lightCount = static_cast<std::uint32_t>(lights.size());
+	h.modelCount = static_cast<std::uint32_t>(models.size());
+	h.meshCount = static_cast<std::uint32_t>(meshes.size());
+	h.lightsOffset = sizeof(FileHeader);
+	h.modelsOffset = h.lightsOffset + lights.size() * sizeof(LightRecord);
+	h.meshesOffset = h.modelsOffset + models.size() * sizeof(ModelRecord);
+	h.stringsOffset = h.meshesOffset + meshes.size() * recordSize;
+	h.stringsSize = strings.size();
+	h.dataOffset = alignUp(h.stringsOffset + h.stringsSize);
+	std::uint64_t cursor = h.dataOffset;
+	for(auto& mr : meshes){
+		mr.verticesOffset = cursor; cursor = alignUp(cursor + mr.verticesBytes);
+		mr.indicesOffset = cursor;  cursor = alignUp(cursor + mr.indicesBytes);
+	}
+	h.fileSize = cursor;
+
+	std::uint64_t written = 0;
+	auto put = [&](const void* p, std::uint64_t n){
+		if(n && !write(p, n)) return false;
+		written += n; return true;
+	};
+	auto pad = [&](std::uint64_t to){ static const char zeros[kAlign] = {}; return put(zeros, to - written); };
+	bool ok = put(&h, sizeof(h)) && put(lights.data(), lights.size()*sizeof(LightRecord))
+	       && put(models.data(), models.size()*sizeof(ModelRecord));
+	for(std::size_t i=0; ok && i<meshes.size(); i++) ok = put(&meshes[i], recordSize);
+	ok = ok && put(strings.data(), strings.size());
+	for(std::size_t i=0; ok && i<meshes.size(); i++){
+		const void* vertices = meshes[i].vertexCodec != GeometryCodec::RawVertices ? static_cast<const void*>(packedVertices[i].data()) : meshSources[i]->vertexData();
+		const void* indices = meshes[i].indexCodec != GeometryCodec::RawIndices ? static_cast<const void*>(packedIndices[i].data()) : meshSources[i]->indexData();
+		ok = pad(meshes[i].verticesOffset) && put(vertices, meshes[i].verticesBytes)
+		  && pad(meshes[i].indicesOffset) && put(indices, meshes[i].indicesBytes);
+	}
+	return ok && pad(h.fileSize);
+}
+
+#ifdef _WIN32
+// Windows won't replace a file that is still mapped, but lets a mapped file (opened with delete
+// sharing) be renamed. The old file moves to "<path>.old<n>" and is deleted as soon as nothing
+// maps it; asides left over from earlier saves are cleared here too. Empty if 'path' is absent.
+static std::string moveAside(const std::string& path){
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	if(!fs::exists(path, ec)) return {};
+	for(int i=0;i<100;i++){
+		const std::string aside = path + ".old" + std::to_string(i);
+		if(fs::exists(aside, ec) && !fs::remove(aside, ec)) continue; // still mapped by an older save's views
+		fs::rename(path, aside, ec);
+		if(!ec) return aside;
+	}
+	return {};
+}
+#endif
+
+static bool writeFile(const Camera& cam, const std::vector<const Light*>& lights, const std::vector<const Model*>& models,
+                      const std::string& path, const Encoding& encoding){
+	// Written next to the target and renamed over it, so a failed save leaves the old file intact.
+	// Views may still map the old file (this save's snapshot among them): POSIX replaces it all
+	// the same and the mapping keeps the old contents; Windows needs it moved aside first.
+	QSaveFile out(QString::fromStdString(path));
+	if(!out.open(QIODevice::WriteOnly)) return false;
+	const bool ok = writeImage(cam, lights, models, encoding, [&](const void* p, std::uint64_t n){
+		return out.write(static_cast<const char*>(p), static_cast<qint64>(n)) == static_cast<qint64>(n);
+	});
+	if(!ok){ out.cancelWriting(); return false; }
+#ifdef _WIN32
+	const std::string aside = moveAside(path);
+	std::error_code ec;
+	if(!out.commit()){ if(!aside.empty()) std::filesystem::rename(aside, path, ec); return false; }
+	// Fails while views are alive; the next save to this path retries
+	if(!aside.empty()) std::filesystem::remove(aside, ec);
+	return true;
+#else
+	return out.commit();
+#endif
+}
+
+static std::vector<const Light*> lightsOf(const Scene& scene){
+	std::vector<const Light*> out;
+	for(const auto& l : scene.lights) out.push_back(l.get());
+	return out;
+}
+
+static std::vector<const Model*> modelsOf(const Scene& scene){
+	std::vector<const Model*> out;
+	for(const auto& m : scene.models) out.push_back(m.get());
+	return out;
+}
+
+bool save(const Scene& scene, const std::string& path, const Encoding& encoding){
+	return writeFile(scene.camera, lightsOf(scene), modelsOf(scene), path, encoding);
+}
+
+bool saveModels(const std::vector<const Model*>& models, const std::string& path, const Encoding& encoding){
+	return writeFile(Camera(), {}, models, path, encoding);
+}
+
+bool saveImage(const Scene& scene, std::string& out, const Encoding& encoding){
+	out.clear();
+	return writeImage(scene.camera, lightsOf(scene), modelsOf(scene), encoding,
+	                  [&](const void* p, std::uint64_t n){ out.append(static_cast<const char*>(p), static_cast<std::size_t>(n)); return true; });
+}
+
+}
@@ -0,0 +1,101 @@
+#include "SceneContainer.h"
+#include "JobSystem.h"
+#include <QByteArray>
+#include <QSaveFile>
+#include <QString>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace SceneContainer {
+
+bool isContainer(const std::string& path){
+	std::ifstream in(path, std::ios::binary);
+	char magic[sizeof(kMagic)] = {};
+	if(!in.read(magic, sizeof(magic))) return false;
+	return std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+int levelOf(const std::string& path){
+	std::ifstream in(path, std::ios::binary);
+	Header h{};
+	if(!in.read(reinterpret_cast<char*>(&h), sizeof(h)) || std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) return 0;
+	return std::clamp(h.level, 1, 9);
+}
+
+bool read(const std::string& path, std::string& image){
+	std::ifstream in(path, std::ios::binary);
+	if(!in) return false;
+	in.seekg(0, std::ios::end);
+	const std::uint64_t fileSize = static_cast<std::uint64_t>(in.tellg());
+	in.seekg(0);
+	Header h{};
+	if(!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+	if(std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion || h.chunkSize == 0) return false;
+	if(h.chunkCount != (h.rawSize + h.chunkSize - 1) / h.chunkSize) return false;
+	if(h.chunkCount > (fileSize - sizeof(h)) / sizeof(ChunkEntry)) return false;
+	std::vector<ChunkEntry> table(h.chunkCount);
+	if(!table.empty() && !in.read(reinterpret_cast<char*>(table.data()), static_cast<std::streamsize>(table.size()*sizeof(ChunkEntry)))) return false;
+	for(std::uint32_t i=0;i<h.chunkCount;i++){
+		const ChunkEntry& e = table[i];
+		const std::uint64_t expect = std::min<std::uint64_t>(h.chunkSize, h.rawSize - std::uint64_t(i)*h.chunkSize);
+		if(e.rawSize != expect || e.offset > fileSize || e.packedSize > fileSize - e.offset) return false;
+	}
+	image.resize(static_cast<std::size_t>(h.rawSize));
+
+	// This thread reads ahead (bounded) and helps; pool jobs inflate and checksum straight into 'image'
+	JobSystem& jobs = JobSystem::instance();
+	const int maxQueued = static_cast<int>(jobs.threadCount()) * 2;
+	JobSystem::Counter inflating;
+	std::atomic<bool> failed{false};
+	for(std::uint32_t i=0; i<h.chunkCount && !failed.load(); i++){
+		const ChunkEntry& e = table[i];
+		QByteArray packed(static_cast<qsizetype>(e.packedSize), Qt::Uninitialized);
+		in.seekg(static_cast<std::streamoff>(e.offset));
+		if(!in.read(packed.data(), e.packedSize)){ failed.store(true); break; }
+		jobs.wait(inflating, maxQueued - 1);
+		jobs.run([&, i, packed = std::move(packed)]{
+			const ChunkEntry& e = table[i];
+			if(failed.load()) return;
+			const QByteArray raw = qUncompress(packed);
+			if(raw.size() != static_cast<qsizetype>(e.rawSize) || qChecksum(QByteArrayView(raw)) != e.checksum){ failed.store(true); return; }
+			std::memcpy(&image[std::size_t(i) * h.chunkSize], raw.constData(), e.rawSize);
+		}, &inflating);
+	}
+	jobs.wait(inflating);
+	if(failed.load()){ image.clear(); return false; }
+	return true;
+}
+
+bool write(const std::string& path, const char* data, std::size_t size, int level){
+	Header h{};
+	std::memcpy(h.magic, kMagic, sizeof(kMagic));
+	h.version = kVersion; h.chunkSize = kChunkSize; h.level = std::clamp(level, 1, 9);
+	h.rawSize = size;
+	h.chunkCount = static_cast<std::uint32_t>((size + kChunkSize - 1) / kChunkSize);
+	std::vector<ChunkEntry> table(h.chunkCount);
+	std::vector<QByteArray> packed(h.chunkCount);
+	JobSystem::instance().parallelFor(h.chunkCount, [&](std::size_t i){
+		const std::size_t off = i * kChunkSize;
+		const std::size_t len = std::min<std::size_t>(kChunkSize, size - off);
+		packed[i] = qCompress(reinterpret_cast<const uchar*>(data + off), static_cast<qsizetype>(len), h.level);
+		table[i].rawSize = static_cast<std::uint32_t>(len);
+		table[i].packedSize = static_cast<std::uint32_t>(packed[i].size());
+		table[i].checksum = qChecksum(QByteArrayView(data + off, static_cast<qsizetype>(len)));
+	});
+	std::uint64_t offset = sizeof(Header) + std::uint64_t(h.chunkCount) * sizeof(ChunkEntry);
+	for(auto& e : table){ e.offset = offset; offset += e.packedSize; }
+
+	QSaveFile out(QString::fromStdString(path));
+	if(!out.open(QIODevice::WriteOnly)) return false;
+	bool ok = out.write(reinterpret_cast<const char*>(&h), sizeof(h)) == static_cast<qint64>(sizeof(h));
+	const qint64 tableBytes = static_cast<qint64>(table.size() * sizeof(ChunkEntry));
+	ok = ok && (table.empty() || out.write(reinterpret_cast<const char*>(table.data()), tableBytes) == tableBytes);
+	for(std::size_t i=0; ok && i<packed.size(); i++) ok = out.write(packed[i]) == packed[i].size();
+	if(!ok){ out.cancelWriting(); return false; }
+	return out.commit();
+}
+
+}
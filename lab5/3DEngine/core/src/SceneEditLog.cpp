@@ -0,0 +1,246 @@
+#include "SceneEditLog.h"
+#include <QByteArray>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace SceneEditLog {
+
+bool stampOf(const std::string& path, Stamp& s){
+	std::error_code ec;
+	const auto size = std::filesystem::file_size(path, ec); if(ec) return false;
+	const auto time = std::filesystem::last_write_time(path, ec); if(ec) return false;
+	s.size = size; s.mtime = static_cast<std::int64_t>(time.time_since_epoch().count());
+	return true;
+}
+
+namespace {
+template<typename T> void put(std::string& out, const T& v){ out.append(reinterpret_cast<const char*>(&v), sizeof(T)); }
+void putString(std::string& out, const std::string& s){ put(out, static_cast<std::uint32_t>(s.size())); out += s; }
+void putFloats(std::string& out, const float* v, std::size_t n){ out.append(reinterpret_cast<const char*>(v), n * sizeof(float)); }
+void putColor(std::string& out, const Color& c){ const float v[4] = {c.r, c.g, c.b, c.a}; putFloats(out, v, 4); }
+
+// Bounds-checked reads over one record's payload
+class Cursor {
+public:
+	Cursor(const char* begin, const char* end) : p(begin), e(end) {}
+	bool bytes(void* dst, std::size_t n){ if(std::size_t(e - p) < n) return false; std::memcpy(dst, p, n); p += n; return true; }
+	template<typename T> bool get(T& v){ return bytes(&v, sizeof(T)); }
+	bool string(std::string& s){
+		std::uint32_t n = 0;
+		if(!get(n) || std::size_t(e - p) < n) return false;
+		s.assign(p, n); p += n; return true;
+	}
+	bool color(Color& c){ float v[4]; if(!bytes(v, sizeof(v))) return false; c = {v[0], v[1], v[2], v[3]}; return true; }
+	std::size_t left() const { return std::size_t(e - p); }
+private:
+	const char* p;
+	const char* e;
+};
+
+void frame(std::string& out, Op op, std::uint32_t index, const std::string& payload){
+	RecordHeader r{};
+	r.payloadSize = static_cast<std::uint32_t>(payload.size());
+	r.op = static_cast<std::uint8_t>(op); r.index = index;
+	r.checksum = qChecksum(QByteArrayView(payload.data(), static_cast<qsizetype>(payload.size())));
+	put(out, r);
+	out += payload;
+}
+
+bool readHeader(std::istream& in, Header& h){
+	return static_cast<bool>(in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+	    && std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kVersion;
+}
+bool matches(const Header& h, const Stamp& base){ return h.baseSize == base.size && h.baseMtime == base.mtime; }
+
+// Walks the intact records of 'data' (header included); returns the byte length they cover
+template<typename F> std::size_t walk(const std::string& data, F&& visit){
+	std::size_t at = sizeof(Header);
+	while(data.size() - at >= sizeof(RecordHeader)){
+		RecordHeader r; std::memcpy(&r, data.data() + at, sizeof(r));
+		if(r.payloadSize > data.size() - at - sizeof(r)) break;
+		const char* payload = data.data() + at + sizeof(r);
+		if(qChecksum(QByteArrayView(payload, static_cast<qsizetype>(r.payloadSize))) != r.checksum) break;
+		if(!visit(r, payload, payload + r.payloadSize)) break;
+		at += sizeof(r) + r.payloadSize;
+	}
+	return at;
+}
+
+bool readJournal(const std::string& scenePath, std::string& data){
+	Stamp base;
+	if(!stampOf(scenePath, base)) return false;
+	std::ifstream in(pathFor(scenePath), std::ios::binary);
+	Header h;
+	if(!in || !readHeader(in, h) || !matches(h, base)) return false;
+	in.seekg(0, std::ios::end);
+	data.resize(static_cast<std::size_t>(in.tellg()));
+	in.seekg(0);
+	return static_cast<bool>(in.read(&data[0], static_cast<std::streamsize>(data.size())));
+}
+
+std::unique_ptr<Model> decodeModel(Cursor& c){
+	auto m = std::make_unique<Model>();
+	std::uint8_t textureLoaded = 0;
+	std::uint32_t meshCount = 0;
+	if(!c.string(m->name) || !c.string(m->texture.file) || !c.get(textureLoaded) || !c.color(m->material.diffuse)
+	   || !c.bytes(m->transform.data(), sizeof(m->transform)) || !c.get(meshCount)) return nullptr;
+	m->texture.loaded = textureLoaded != 0;
+	if(meshCount > c.left() / (2 * sizeof(std::uint64_t))) return nullptr;
+	m->meshes.resize(meshCount);
+	for(auto& mesh : m->meshes){
+		std::uint64_t vertexCount = 0, indexCount = 0;
+		if(!c.get(vertexCount) || !c.get(indexCount)) return nullptr;
+		if(vertexCount > c.left() / sizeof(Vec3)) return nullptr;
+		mesh.vertices.resize(static_cast<std::size_t>(vertexCount));
+		if(!c.bytes(mesh.vertices.data(), mesh.vertices.size() * sizeof(Vec3))) return nullptr;
+		if(indexCount > c.left() / sizeof(unsigned)) return nullptr;
+		mesh.indices.resize(static_cast<std::size_t>(indexCount));
+		if(!c.bytes(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned))) return nullptr;
+	}
+	return m;
+}
+
+std::unique_ptr<Light> decodeLight(Cursor& c){
+	auto l = std::make_unique<Light>();
+	std::uint32_t type = 0;
+	float v[6];
+	if(!c.get(type) || !c.bytes(v, sizeof(v)) || !c.color(l->color) || !c.get(l->intensity)) return nullptr;
+	l->type = type == 1 ? Light::Type::Directional : Light::Type::Point;
+	l->position = {v[0], v[1], v[2]}; l->direction = {v[3], v[4], v[5]};
+	return l;
+}
+}
+
+void recordClear(std::string& out){ frame(out, Op::Clear, 0, std::string()); }
+
+void recordModel(std::string& out, Op op, std::uint32_t index, const Model& m){
+	std::string p;
+	std::size_t bytes = 0;
+	for(const auto& mesh : m.meshes) bytes += 16 + mesh.vertexCount()*sizeof(Vec3) + mesh.indexCount()*sizeof(unsigned);
+	p.reserve(m.name.size() + m.texture.file.size() + 100 + bytes);
+	putString(p, m.name); putString(p, m.texture.file); put(p, static_cast<std::uint8_t>(m.texture.loaded));
+	putColor(p, m.material.diffuse);
+	putFloats(p, m.transform.data(), m.transform.size());
+	put(p, static_cast<std::uint32_t>(m.meshes.size()));
+	for(const auto& mesh : m.meshes){
+		put(p, static_cast<std::uint64_t>(mesh.vertexCount())); put(p, static_cast<std::uint64_t>(mesh.indexCount()));
+		p.append(reinterpret_cast<const char*>(mesh.vertexData()), mesh.vertexCount()*sizeof(Vec3));
+		p.append(reinterpret_cast<const char*>(mesh.indexData()), mesh.indexCount()*sizeof(unsigned));
+	}
+	frame(out, op, index, p);
+}
+
+void recordTransform(std::string& out, std::uint32_t index, const std::array<float,16>& transform){
+	std::string p; putFloats(p, transform.data(), transform.size());
+	frame(out, Op::ModelTransform, index, p);
+}
+
+void recordLook(std::string& out, std::uint32_t index, const Material& material, const Texture& texture){
+	std::string p;
+	putString(p, texture.file); put(p, static_cast<std::uint8_t>(texture.loaded)); putColor(p, material.diffuse);
+	frame(out, Op::ModelLook, index, p);
+}
+
+void recordLight(std::string& out, Op op, std::uint32_t index, const Light& l){
+	std::string p;
+	put(p, static_cast<std::uint32_t>(l.type == Light::Type::Directional ? 1 : 0));
+	const float v[6] = {l.position.x, l.position.y, l.position.z, l.direction.x, l.direction.y, l.direction.z};
+	putFloats(p, v, 6); putColor(p, l.color); put(p, l.intensity);
+	frame(out, op, index, p);
+}
+
+void recordRemove(std::string& out, Op op, std::uint32_t index){ frame(out, op, index, std::string()); }
+
+std::uint64_t prepare(const std::string& scenePath, const Stamp& base){
+	const std::string path = pathFor(scenePath);
+	std::error_code ec;
+	if(!std::filesystem::exists(path, ec)) return 0;
+	std::string data;
+	if(!readJournal(scenePath, data)){ remove(scenePath); return 0; }
+	Header h; std::memcpy(&h, data.data(), sizeof(h));
+	if(!matches(h, base)){ remove(scenePath); return 0; }
+	const std::size_t valid = walk(data, [](const RecordHeader&, const char*, const char*){ return true; });
+	if(valid < data.size()) std::filesystem::resize_file(path, valid, ec);
+	return ec ? 0 : valid;
+}
+
+bool append(const std::string& scenePath, const Stamp& base, const std::string& records, std::uint64_t& journalSize){
+	const std::string path = pathFor(scenePath);
+	std::error_code ec;
+	const bool fresh = !std::filesystem::exists(path, ec) || std::filesystem::file_size(path, ec) == 0;
+	std::ofstream out(path, std::ios::binary | std::ios::app);
+	if(!out) return false;
+	if(fresh){
+		Header h{};
+		std::memcpy(h.magic, kMagic, sizeof(kMagic));
+		h.version = kVersion; h.baseSize = base.size; h.baseMtime = base.mtime;
+		out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	}
+	out.write(records.data(), static_cast<std::streamsize>(records.size()));
+	out.flush();
+	if(!out) return false;
+	out.close();
+	journalSize = std::filesystem::file_size(path, ec);
+	return !ec;
+}
+
+void remove(const std::string& scenePath){
+	std::error_code ec;
+	std::filesystem::remove(pathFor(scenePath), ec);
+}
+
+bool pending(const std::string& scenePath){
+	Stamp base;
+	std::ifstream in(pathFor(scenePath), std::ios::binary);
+	Header h;
+	return in && stampOf(scenePath, base) && readHeader(in, h) && matches(h, base);
+}
+
+bool read(const std::string& scenePath, std::vector<Edit>& out){
+	std::string data;
+	if(!readJournal(scenePath, data)) return false;
+	// A record that fails to decode ends the journal, like a torn one
+	walk(data, [&](const RecordHeader& r, const char* begin, const char* end){
+		if(r.op > static_cast<std::uint8_t>(Op::LightRemove)) return false;
+		Edit e;
+		e.op = static_cast<Op>(r.op); e.index = r.index;
+		Cursor c(begin, end);
+		switch(e.op){
+		case Op::ModelAdd: case Op::ModelReplace: e.model = decodeModel(c); if(!e.model) return false; break;
+		case Op::LightAdd: case Op::LightSet: e.light = decodeLight(c); if(!e.light) return false; break;
+		case Op::ModelTransform: if(!c.bytes(e.transform.data(), sizeof(e.transform))) return false; break;
+		case Op::ModelLook: {
+			std::uint8_t loaded = 0;
+			if(!c.string(e.texture.file) || !c.get(loaded) || !c.color(e.material.diffuse)) return false;
+			e.texture.loaded = loaded != 0;
+			break;
+		}
+		default: break;
+		}
+		out.push_back(std::move(e));
+		return true;
+	});
+	return true;
+}
+
+void apply(std::vector<Edit>& edits, std::vector<std::unique_ptr<Light>>& lights, std::vector<std::unique_ptr<Model>>& models){
+	for(auto& e : edits){
+		const bool model = e.index < models.size() && models[e.index];
+		const bool light = e.index < lights.size() && lights[e.index];
+		switch(e.op){
+		case Op::Clear: lights.clear(); models.clear(); break;
+		case Op::ModelAdd: models.push_back(std::move(e.model)); break;
+		case Op::ModelReplace: if(model) models[e.index] = std::move(e.model); break;
+		case Op::ModelRemove: if(e.index < models.size()) models.erase(models.begin() + static_cast<std::ptrdiff_t>(e.index)); break;
+		case Op::ModelTransform: if(model) models[e.index]->transform = e.transform; break;
+		case Op::ModelLook: if(model){ models[e.index]->material = e.material; models[e.index]->texture = e.texture; } break;
+		case Op::LightAdd: lights.push_back(std::move(e.light)); break;
+		case Op::LightSet: if(light) lights[e.index] = std::move(e.light); break;
+		case Op::LightRemove: if(e.index < lights.size()) lights.erase(lights.begin() + static_cast<std::ptrdiff_t>(e.index)); break;
+		}
+	}
+	edits.clear();
+}
+
+}
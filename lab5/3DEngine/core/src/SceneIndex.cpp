@@ -0,0 +1,187 @@
+#include "SceneIndex.h"
+#include "SceneBinary.h"
+#include "SceneContainer.h"
+#include "Model.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+bool modelBounds(const Model& m, float lo[3], float hi[3]){
+	if(m.fileBounds && std::all_of(m.meshes.begin(), m.meshes.end(), [](const Mesh& mesh){ return mesh.isView(); })){
+		for(int a=0;a<3;a++){ lo[a] = m.boundsMin[a]; hi[a] = m.boundsMax[a]; }
+		return true;
+	}
+	for(int a=0;a<3;a++){ lo[a] = std::numeric_limits<float>::max(); hi[a] = -std::numeric_limits<float>::max(); }
+	bool any = false;
+	for(const auto& mesh : m.meshes){
+		const Vec3* v = mesh.vertexData();
+		for(std::size_t i=0;i<mesh.vertexCount();i++){
+			lo[0] = std::min(lo[0], v[i].x); lo[1] = std::min(lo[1], v[i].y); lo[2] = std::min(lo[2], v[i].z);
+			hi[0] = std::max(hi[0], v[i].x); hi[1] = std::max(hi[1], v[i].y); hi[2] = std::max(hi[2], v[i].z);
+		}
+		any = any || mesh.vertexCount() > 0;
+	}
+	if(m.points) for(const auto& cell : m.points->cells){
+		for(int a=0;a<3;a++){ lo[a] = std::min(lo[a], cell.boundsMin[a]); hi[a] = std::max(hi[a], cell.boundsMax[a]); }
+		any = true;
+	}
+	if(!any) for(int a=0;a<3;a++){ lo[a] = hi[a] = 0.f; }
+	return any;
+}
+
+void SceneIndex::ModelEntry::worldBounds(float lo[3], float hi[3]) const{
+	// Each output axis spans the translation plus the extremes of every rotated/scaled input axis
+	for(int r=0;r<3;r++){
+		lo[r] = hi[r] = transform[12 + r];
+		for(int c=0;c<3;c++){
+			const float a = transform[c*4 + r] * boundsMin[c], b = transform[c*4 + r] * boundsMax[c];
+			lo[r] += std::min(a, b); hi[r] += std::max(a, b);
+		}
+	}
+}
+
+namespace {
+// Identifies the scene file version the sidecar was built from
+struct Stamp { std::uint64_t size{0}; long long mtime{0}; };
+bool stampOf(const std::string& path, Stamp& s){
+	std::error_code ec;
+	const auto size = std::filesystem::file_size(path, ec); if(ec) return false;
+	const auto time = std::filesystem::last_write_time(path, ec); if(ec) return false;
+	s.size = size; s.mtime = static_cast<long long>(time.time_since_epoch().count());
+	return true;
+}
+
+// Sidecar (text):
+//   SCENEIDX 2 <size> <mtime>
+//   LIGHTS <begin> <end>
+//   MODEL <begin> <end> <ordinal> <meshes> <vertices> <indices> <min xyz> <max xyz> <transform x16> <name>
+bool readSidecar(const std::string& path, const Stamp& stamp, SceneIndex& idx){
+	std::ifstream in(SceneIndex::sidecarPath(path));
+	if(!in) return false;
+	std::string line, key;
+	int version = 0; Stamp s;
+	if(!std::getline(in, line)) return false;
+	std::istringstream hs(line);
+	if(!(hs >> key >> version >> s.size >> s.mtime) || key != "SCENEIDX" || version != 2) return false;
+	if(s.size != stamp.size || s.mtime != stamp.mtime) return false;
+	while(std::getline(in, line)){
+		std::istringstream ls(line);
+		if(!(ls >> key)) continue;
+		if(key == "LIGHTS"){
+			SceneText::Span r;
+			if(!(ls >> r.begin >> r.end)) return false;
+			idx.lightSections.push_back(r);
+		} else if(key == "MODEL"){
+			SceneIndex::ModelEntry e;
+			if(!(ls >> e.begin >> e.end >> e.ordinal >> e.meshCount >> e.vertexCount >> e.indexCount
+			        >> e.boundsMin[0] >> e.boundsMin[1] >> e.boundsMin[2] >> e.boundsMax[0] >> e.boundsMax[1] >> e.boundsMax[2])) return false;
+			for(float& f : e.transform) if(!(ls >> f)) return false;
+			if(ls.peek() == ' ') ls.get();
+			std::getline(ls, e.name);
+			idx.models.push_back(std::move(e));
+		}
+	}
+	return true;
+}
+
+void writeSidecar(const std::string& path, const Stamp& stamp, const SceneIndex& idx){
+	std::string out = "SCENEIDX 2 " + std::to_string(stamp.size) + " " + std::to_string(stamp.mtime) + "\n";
+	for(const auto& r : idx.lightSections) out += "LIGHTS " + std::to_string(r.begin) + " " + std::to_string(r.end) + "\n";
+	for(const auto& e : idx.models){
+		out += "MODEL " + std::to_string(e.begin) + " " + std::to_string(e.end) + " " + std::to_string(e.ordinal)
+		     + " " + std::to_string(e.meshCount) + " " + std::to_string(e.vertexCount) + " " + std::to_string(e.indexCount);
+		for(float f : e.boundsMin){ out += ' '; SceneText::appendFloat(out, f); }
+		for(float f : e.boundsMax){ out += ' '; SceneText::appendFloat(out, f); }
+		for(float f : e.transform){ out += ' '; SceneText::appendFloat(out, f); }
+		out += " " + e.name + "\n";
+	}
+	// Best effort: a read-only folder just means the index is rebuilt next time
+	std::ofstream f(SceneIndex::sidecarPath(path), std::ios::binary);
+	if(f) f.write(out.data(), static_cast<std::streamsize>(out.size()));
+}
+
+void indexFromText(const std::string& buffer, SceneIndex& idx){
+	std::vector<SceneText::Parsed> parsed;
+	SceneText::parse(buffer.data(), buffer.data() + buffer.size(), parsed, &idx.lightSections);
+	for(const auto& p : parsed){
+		if(!p.model) continue;
+		SceneIndex::ModelEntry e;
+		e.name = p.model->name; e.begin = p.begin; e.end = p.end; e.ordinal = p.ordinal;
+		e.meshCount = static_cast<std::uint32_t>(p.model->meshes.size());
+		for(const auto& m : p.model->meshes){ e.vertexCount += m.vertexCount(); e.indexCount += m.indexCount(); }
+		modelBounds(*p.model, e.boundsMin, e.boundsMax);
+		e.transform = p.model->transform;
+		idx.models.push_back(std::move(e));
+	}
+}
+
+// 'data' must hold at least everything before the first mesh array (header, tables, strings)
+bool indexFromBinary(const char* data, std::uint64_t size, SceneIndex& idx){
+	using namespace SceneBinary;
+	if(size < sizeof(FileHeader)) return false;
+	FileHeader h; std::memcpy(&h, data, sizeof(h));
+	if(!supportedVersion(h)) return false;
+	if(h.modelsOffset > size || h.modelCount > (size - h.modelsOffset) / sizeof(ModelRecord)) return false;
+	if(h.meshesOffset > size || h.meshCount > (size - h.meshesOffset) / meshRecordSize(h.version)) return false;
+	if(h.stringsOffset > size || h.stringsSize > size - h.stringsOffset) return false;
+	idx.binary = true;
+	for(std::uint32_t i=0;i<h.modelCount;i++){
+		ModelRecord r; std::memcpy(&r, data + h.modelsOffset + std::uint64_t(i)*sizeof(ModelRecord), sizeof(r));
+		if(r.nameOffset > h.stringsSize || r.nameSize > h.stringsSize - r.nameOffset) return false;
+		if(r.firstMesh > h.meshCount || r.meshCount > h.meshCount - r.firstMesh) return false;
+		SceneIndex::ModelEntry e;
+		e.name.assign(data + h.stringsOffset + r.nameOffset, r.nameSize);
+		e.ordinal = i; e.meshCount = r.meshCount;
+		e.begin = std::numeric_limits<std::uint64_t>::max();
+		for(std::uint32_t k=0;k<r.meshCount;k++){
+			const MeshRecord m = readMeshRecord(data, h, std::uint64_t(r.firstMesh) + k);
+			e.vertexCount += m.vertexCount; e.indexCount += m.indexCount;
+			e.begin = std::min(e.begin, m.verticesOffset);
+			e.end = std::max(e.end, m.indicesOffset + m.indicesBytes);
+		}
+		if(!r.meshCount) e.begin = 0;
+		std::copy(r.boundsMin, r.boundsMin + 3, e.boundsMin);
+		std::copy(r.boundsMax, r.boundsMax + 3, e.boundsMax);
+		std::copy(r.transform, r.transform + 16, e.transform.begin());
+		idx.models.push_back(std::move(e));
+	}
+	return true;
+}
+
+bool readBinaryIndex(const std::string& path, SceneIndex& idx){
+	// Header, tables and strings all sit before the mesh arrays; only that prefix is read
+	std::ifstream in(path, std::ios::binary);
+	SceneBinary::FileHeader h{};
+	if(!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+	if(h.dataOffset < sizeof(h) || h.dataOffset > h.fileSize) return false;
+	std::string prefix(static_cast<std::size_t>(h.dataOffset), '\0');
+	in.seekg(0);
+	if(!in.read(&prefix[0], static_cast<std::streamsize>(prefix.size()))) return false;
+	return indexFromBinary(prefix.data(), prefix.size(), idx);
+}
+}
+
+bool SceneIndex::read(const std::string& scenePath){
+	*this = SceneIndex();
+	if(SceneContainer::isContainer(scenePath)){
+		// Offsets refer to the decoded image; compressed scenes are always decoded whole
+		std::string image;
+		if(!SceneContainer::read(scenePath, image)) return false;
+		if(SceneBinary::isBinaryImage(image.data(), image.size())) return indexFromBinary(image.data(), image.size(), *this);
+		indexFromText(image, *this);
+		return true;
+	}
+	if(SceneBinary::isBinaryFile(scenePath)) return readBinaryIndex(scenePath, *this);
+	Stamp stamp;
+	if(!stampOf(scenePath, stamp)) return false;
+	if(readSidecar(scenePath, stamp, *this)) return true;
+	*this = SceneIndex();
+	std::string buffer;
+	if(!SceneText::readFile(scenePath, buffer)) return false;
+	indexFromText(buffer, *this);
+	writeSidecar(scenePath, stamp, *this);
+	return true;
+}
@@ -0,0 +1,296 @@
+#include "SceneText.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace SceneText {
+
+bool readFile(const std::string& path, std::string& out){
+	std::ifstream in(path, std::ios::binary);
+	if(!in) return false;
+	in.seekg(0, std::ios::end);
+	const std::streamoff size = in.tellg();
+	if(size < 0) return false;
+	in.seekg(0, std::ios::beg);
+	out.resize(static_cast<std::size_t>(size));
+	if(size > 0 && !in.read(&out[0], size)) return false;
+	return true;
+}
+
+const char* LineCursor::lineEnd(const char*& next) const{
+	const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(e - p)));
+	if(!nl){ next = e; return e; }
+	next = nl + 1;
+#ifdef _WIN32
+	// The old loader read in text mode, where CRLF arrives as LF
+	if(nl > p && nl[-1] == '\r') --nl;
+#endif
+	return nl;
+}
+
+bool LineCursor::getline(std::string& line){
+	if(p >= e) return false;
+	const char* next = nullptr;
+	const char* end = lineEnd(next);
+	line.assign(p, end);
+	p = next;
+	return true;
+}
+
+std::size_t LineCursor::skip(std::size_t count){
+	std::size_t n = 0;
+	const char* next = nullptr;
+	for(; n < count && p < e; ++n){ lineEnd(next); p = next; }
+	return n;
+}
+
+std::size_t collect(LineCursor& in, std::size_t count, std::vector<Chunk>& out){
+	std::size_t total = 0;
+	while(total < count){
+		Chunk c; c.begin = in.pos(); c.first = total;
+		c.lines = in.skip(std::min(kChunkLines, count - total));
+		if(c.lines == 0) break;
+		c.end = in.pos();
+		total += c.lines;
+		out.push_back(c);
+	}
+	return total;
+}
+
+// Whitespace as seen by operator>> in the "C" locale
+static inline bool isWs(char c){ return c==' ' || c=='\t' || c=='\n' || c=='\v' || c=='\f' || c=='\r'; }
+static inline bool isDigit(char c){ return c>='0' && c<='9'; }
+static inline void skipWs(const char*& p, const char* e){ while(p<e && isWs(*p)) ++p; }
+
+// Plain decimal float ([-]digits[.digits][e[+-]digits]) followed by whitespace or end of line.
+// Anything else (signs, hex, inf, overflow...) returns false and the caller takes the slow path.
+static bool fastFloat(const char*& p, const char* e, float& v){
+	skipWs(p, e);
+	const char* q = p;
+	if(q<e && *q=='-') ++q;
+	bool digits = false;
+	while(q<e && isDigit(*q)){ ++q; digits = true; }
+	if(q<e && *q=='.'){ ++q; while(q<e && isDigit(*q)){ ++q; digits = true; } }
+	if(!digits) return false;
+	if(q<e && (*q=='e' || *q=='E')){
+		++q; if(q<e && (*q=='+' || *q=='-')) ++q;
+		if(q>=e || !isDigit(*q)) return false;
+		while(q<e && isDigit(*q)) ++q;
+	}
+	if(q<e && !isWs(*q)) return false;
+	const auto r = std::from_chars(p, q, v);
+	if(r.ec != std::errc() || r.ptr != q) return false;
+	p = q;
+	return true;
+}
+
+static bool fastUnsigned(const char*& p, const char* e, unsigned& v){
+	skipWs(p, e);
+	const char* q = p;
+	while(q<e && isDigit(*q)) ++q;
+	if(q==p || (q<e && !isWs(*q))) return false;
+	const auto r = std::from_chars(p, q, v);
+	if(r.ec != std::errc() || r.ptr != q) return false;
+	p = q;
+	return true;
+}
+
+// Leading tag character ('v' / 'i'); like "char c; s >> c" it is not checked
+static bool fastTag(const char*& p, const char* e){ skipWs(p, e); if(p>=e) return false; ++p; return true; }
+
+static Vec3 parseVertex(const char* b, const char* e){
+	Vec3 v; const char* p = b;
+	if(fastTag(p, e) && fastFloat(p, e, v.x) && fastFloat(p, e, v.y) && fastFloat(p, e, v.z)) return v;
+	// Same extraction as the original line loader
+	std::istringstream vls(std::string(b, e)); char c; v = Vec3(); vls >> c >> v.x >> v.y >> v.z;
+	return v;
+}
+
+static unsigned parseIndex(const char* b, const char* e){
+	unsigned a = 0; const char* p = b;
+	if(fastTag(p, e) && fastUnsigned(p, e, a)) return a;
+	std::istringstream ils(std::string(b, e)); char c; a = 0; ils >> c >> a;
+	return a;
+}
+
+static void parseChunk(const Chunk& c){
+	const char* p = c.begin;
+	for(std::size_t i=0;i<c.lines;i++){
+		const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(c.end - p)));
+		const char* end = nl ? nl : c.end;
+		if(c.vertices) c.vertices[c.first + i] = parseVertex(p, end);
+		else c.indices[c.first + i] = parseIndex(p, end);
+		p = nl ? nl + 1 : c.end;
+	}
+}
+
+void parseChunks(const Chunk* chunks, std::size_t count){
+	JobSystem::instance().parallelFor(count, [chunks](std::size_t i){ parseChunk(chunks[i]); });
+}
+
+static std::string trimLeft(const std::string& s){ size_t i=0; while(i<s.size() && std::isspace(static_cast<unsigned char>(s[i]))) ++i; return s.substr(i); }
+
+// Sequential pass over one model record; same rules as the original getline loader, except
+// that vertex/index lines are only skipped and cut into chunks. Null if there is no NAME line.
+static std::unique_ptr<Model> readModel(LineCursor& in, int mi, std::vector<Chunk>& chunks, std::string& line){
+	auto md = std::make_unique<Model>();
+	// NAME line
+	if(!in.getline(line)) return nullptr; if(line.rfind("NAME",0)==0){ md->name = trimLeft(line.substr(4)); if(!md->name.empty() && md->name[0]==' ') md->name.erase(0,1);} else { md->name = "model"+std::to_string(mi); }
+	// TEXTURE line
+	if(in.getline(line) && line.rfind("TEXTURE",0)==0){ std::string pathPart = trimLeft(line.substr(7)); if(!pathPart.empty() && pathPart[0]==' ') pathPart.erase(0,1); if(pathPart != "-" && !pathPart.empty()){ md->texture.file = pathPart; md->texture.loaded = true; } }
+	// MATERIAL line
+	if(in.getline(line) && line.rfind("MATERIAL",0)==0){ std::istringstream ms(line.substr(8)); ms >> md->material.diffuse.r >> md->material.diffuse.g >> md->material.diffuse.b >> md->material.diffuse.a; }
+	// Optional TRANSFORM line (column-major), then MESHES; files without it stay identity
+	bool more = in.getline(line);
+	if(more && line.rfind("TRANSFORM",0)==0){ std::istringstream ts(line.substr(9)); for(float& f : md->transform) ts >> f; more = in.getline(line); }
+	int meshCount = 0; if(more && line.rfind("MESHES",0)==0){ std::istringstream mcs(line.substr(6)); mcs >> meshCount; }
+	for(int k=0;k<meshCount;k++){
+		// VERTICES
+		int vcount=0; if(!in.getline(line)) break; if(line.rfind("VERTICES",0)==0){ std::istringstream vs(line.substr(8)); vs >> vcount; }
+		std::size_t first = chunks.size();
+		std::vector<Vec3> verts(collect(in, static_cast<std::size_t>(std::max(vcount, 0)), chunks));
+		for(std::size_t c=first;c<chunks.size();c++) chunks[c].vertices = verts.data();
+		// INDICES
+		int icount=0; if(!in.getline(line)) break; if(line.rfind("INDICES",0)==0){ std::istringstream is(line.substr(7)); is >> icount; }
+		first = chunks.size();
+		std::vector<unsigned> idx(collect(in, static_cast<std::size_t>(std::max(icount, 0)), chunks));
+		for(std::size_t c=first;c<chunks.size();c++) chunks[c].indices = idx.data();
+		// Moving the vectors keeps their storage, so the chunk pointers stay valid
+		Mesh m; m.vertices = std::move(verts); m.indices = std::move(idx); md->meshes.push_back(std::move(m));
+	}
+	return md;
+}
+
+void scan(const char* begin, const char* end, std::vector<Parsed>& out, std::vector<Chunk>& chunks, std::vector<Span>* lightSections){
+	// Walk the structure, cutting data lines into chunks that point into sized arrays
+	LineCursor in(begin, end);
+	std::string line;
+	int expectLights = -1;
+	int expectModels = -1;
+	auto offset = [&]{ return static_cast<std::uint64_t>(in.pos() - begin); };
+	for(std::uint64_t lineStart = offset(); in.getline(line); lineStart = offset()){
+		if(line.empty()) continue;
+		std::istringstream ss(line);
+		std::string key; ss >> key;
+		if(key == "CAMERA"){
+			//keep current camera
+			continue;
+		} else if(key == "LIGHTS"){
+			ss >> expectLights;
+			for(int i=0;i<expectLights;i++){
+				if(!in.getline(line)) break; if(line.empty()){ --i; continue; }
+				std::istringstream ls(line); std::string lkey; ls >> lkey; if(lkey != "LIGHT"){ --i; continue; }
+				Parsed p; p.light = std::make_unique<Light>();
+				Light* lt = p.light.get();
+				int t=0; ls >> t;
+				lt->type = (t==1) ? Light::Type::Directional : Light::Type::Point;
+				ls >> lt->position.x >> lt->position.y >> lt->position.z;
+				ls >> lt->direction.x >> lt->direction.y >> lt->direction.z;
+				ls >> lt->color.r >> lt->color.g >> lt->color.b >> lt->color.a;
+				ls >> lt->intensity;
+				p.chunkEnd = chunks.size();
+				out.push_back(std::move(p));
+			}
+			if(lightSections) lightSections->push_back({lineStart, offset()});
+		} else if(key == "MODELS"){
+			ss >> expectModels;
+			for(int mi=0; mi<expectModels; ++mi){
+				Parsed p; p.begin = offset(); p.ordinal = static_cast<std::uint32_t>(mi);
+				p.model = readModel(in, mi, chunks, line);
+				if(!p.model) break;
+				p.end = offset();
+				p.chunkEnd = chunks.size();
+				out.push_back(std::move(p));
+			}
+		}
+	}
+}
+
+void parse(const char* begin, const char* end, std::vector<Parsed>& out, std::vector<Span>* lightSections){
+	// Pass 1 cuts the data into chunks, pass 2 parses them all in parallel
+	std::vector<Chunk> chunks;
+	scan(begin, end, out, chunks, lightSections);
+	parseChunks(chunks);
+}
+
+std::unique_ptr<Model> parseModel(const char* begin, const char* end, int ordinal){
+	LineCursor in(begin, end);
+	std::vector<Chunk> chunks;
+	std::string line;
+	auto md = readModel(in, ordinal, chunks, line);
+	parseChunks(chunks);
+	return md;
+}
+
+void appendFloat(std::string& out, float v){
+	char buf[32];
+	const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+	out.append(buf, r.ptr);
+}
+
+void appendUnsigned(std::string& out, std::size_t v){
+	char buf[24];
+	const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+	out.append(buf, r.ptr);
+}
+
+void appendVertices(std::vector<Piece>& pieces, const Vec3* v, std::size_t count){
+	for(std::size_t i=0;i<count;i+=kChunkLines){ Piece p; p.vertices = v + i; p.count = std::min(kChunkLines, count - i); pieces.push_back(std::move(p)); }
+}
+
+void appendIndices(std::vector<Piece>& pieces, const unsigned* idx, std::size_t count){
+	for(std::size_t i=0;i<count;i+=kChunkLines){ Piece p; p.indices = idx + i; p.count = std::min(kChunkLines, count - i); pieces.push_back(std::move(p)); }
+}
+
+// Longest lines: "v " + 3 floats (max 15 chars each, e.g. -1.1754944e-38) + separators, "i 4294967295"
+constexpr std::size_t kMaxVertexLine = 2 + 3*16 + 1;
+constexpr std::size_t kMaxIndexLine = 2 + 10 + 1;
+
+static std::size_t formatPiece(const Piece& p, std::vector<char>& buf){
+	const std::size_t need = p.count * (p.vertices ? kMaxVertexLine : kMaxIndexLine);
+	if(buf.size() < need) buf.resize(need);
+	char* o = buf.data();
+	char* const end = o + buf.size();
+	if(p.vertices){
+		for(std::size_t i=0;i<p.count;i++){
+			const Vec3& v = p.vertices[i];
+			*o++ = 'v'; *o++ = ' '; o = std::to_chars(o, end, v.x).ptr;
+			*o++ = ' '; o = std::to_chars(o, end, v.y).ptr;
+			*o++ = ' '; o = std::to_chars(o, end, v.z).ptr;
+			*o++ = '\n';
+		}
+	} else {
+		for(std::size_t i=0;i<p.count;i++){
+			*o++ = 'i'; *o++ = ' '; o = std::to_chars(o, end, p.indices[i]).ptr;
+			*o++ = '\n';
+		}
+	}
+	return static_cast<std::size_t>(o - buf.data());
+}
+
+bool writePieces(std::ostream& out, const std::vector<Piece>& pieces){
+	JobSystem& jobs = JobSystem::instance();
+	const std::size_t window = std::size_t(jobs.threadCount()) * 4;
+	std::vector<std::vector<char>> buffers(std::min(window, pieces.size()));
+	std::vector<std::size_t> lengths(buffers.size());
+	for(std::size_t base=0; base<pieces.size(); base+=window){
+		const std::size_t n = std::min(window, pieces.size() - base);
+		jobs.parallelFor(n, [&](std::size_t i){
+			const Piece& p = pieces[base + i];
+			lengths[i] = p.count ? formatPiece(p, buffers[i]) : 0;
+		});
+		for(std::size_t i=0;i<n;i++){
+			const Piece& p = pieces[base + i];
+			if(!p.text.empty()) out.write(p.text.data(), static_cast<std::streamsize>(p.text.size()));
+			if(lengths[i]) out.write(buffers[i].data(), static_cast<std::streamsize>(lengths[i]));
+		}
+		if(!out) return false;
+	}
+	out.flush();
+	return static_cast<bool>(out);
+}
+
+}
@@ -6,8 +6,19 @@ INCLUDEPATH += $$PWD/include \
                $$PWD/../../core/include \
                $$PWD/../../third_party/assimp \
                $$PWD/../../third_party/stb_image
-HEADERS += include/ModelManager.h
-SOURCES += src/ModelManager.cpp
+HEADERS += include/ModelManager.h \
+    include/ObjImporter.h \
+    include/GltfLoader.h \
+    include/StlImporter.h \
+    include/PlyLoader.h \
+    include/AssetCache.h \
+    src/ImportSupport.h
+SOURCES += src/ModelManager.cpp \
+    src/ObjImporter.cpp \
+    src/GltfLoader.cpp \
+    src/StlImporter.cpp \
+    src/PlyLoader.cpp \
+    src/AssetCache.cpp
 CONFIG(debug, debug|release) {
     LIBS += -L$$OUT_PWD/../../core/debug -lCore
 } else {
@@ -0,0 +1,20 @@
+#ifndef ASSETCACHE_H
+#define ASSETCACHE_H
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../core/include/Model.h"
+// Cooked imports: the finished models of a source file, stored under a key derived from the
+// source bytes and the import settings (importer version included), so any change to either
+// simply misses and the file is imported again. An entry in the cache directory is
+//   <key>.sceneb        models and meshes as SceneBinary, mapped on load like a .sceneb scene
+//   <key>.<i>.points    point cloud of model i, when it has one
+// The .sceneb is written last, so an entry without it is incomplete and ignored.
+namespace AssetCache {
+    // Hex digest of the file contents plus 'settings'; empty if the file can't be read
+    std::string key(const std::string& sourcePath, const std::string& settings);
+    // False (and 'out' untouched) on a miss or an unreadable entry
+    bool load(const std::string& dir, const std::string& key, std::vector<std::unique_ptr<Model>>& out);
+    bool store(const std::string& dir, const std::string& key, const std::vector<std::unique_ptr<Model>>& models);
+}
+#endif // ASSETCACHE_H
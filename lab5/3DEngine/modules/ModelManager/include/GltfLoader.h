@@ -0,0 +1,18 @@
+#ifndef GLTFLOADER_H
+#define GLTFLOADER_H
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../core/include/Model.h"
+// glTF 2.0: .glb, or .gltf with its buffers in separate files. Buffers are mapped, and when an
+// accessor already has Mesh's layout (packed float VEC3 positions, 32-bit indices) the Mesh is
+// a view into the mapping, so the renderer uploads straight from the file pages; any other
+// layout is converted once per primitive. Mesh::detach() makes a copy for CPU-side editing.
+// Every node with a mesh becomes a Model whose transform is the node's world matrix;
+// its triangle primitives become the Model's meshes.
+namespace GltfLoader {
+    // Revision of what load() produces; bumping it invalidates cooked imports (AssetCache)
+    constexpr int kVersion = 1;
+    bool load(const std::string& path, std::vector<std::unique_ptr<Model>>& out, std::string* error = nullptr);
+}
+#endif // GLTFLOADER_H
@@ -3,11 +3,25 @@
 #include <memory>
 #include <vector>
 #include "../../core/include/Model.h"
+class JobSystem;
 class ModelManager {
 public:
     std::vector<std::unique_ptr<Model>> owned;
+    // .glb / .gltf (GltfLoader, one model per mesh node), binary .stl (StlImporter), binary .ply
+    // point clouds (PlyLoader) or Wavefront .obj (ObjImporter);
+    // the first model, null if nothing could be imported
     Model* loadModel(const std::string& filename);
+    // Same import, handed to the caller (e.g. for Scene::addModel)
+    bool importModels(const std::string& filename, std::vector<std::unique_ptr<Model>>& out, std::string* error = nullptr);
     bool saveModel(Model* model,const std::string& filename);
     bool applyTexture(const std::string& textureFile, Model* model);
+    // Imports are cooked into 'dir' (AssetCache) and read back from there while the source and
+    // importer are unchanged; empty (the default) turns the cache off
+    void setCacheDirectory(const std::string& dir){ cacheDir = dir; }
+    const std::string& cacheDirectory() const { return cacheDir; }
+    // Imports run on 'jobs' instead of this module's own copy of JobSystem::instance()
+    static void shareJobSystem(JobSystem& jobs);
+private:
+    std::string cacheDir;
 };
 #endif // MODELMANAGER_H
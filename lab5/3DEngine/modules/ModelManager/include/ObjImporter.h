@@ -0,0 +1,19 @@
+#ifndef OBJIMPORTER_H
+#define OBJIMPORTER_H
+#include <memory>
+#include <string>
+#include "../../core/include/Model.h"
+// Wavefront .obj: the file is mapped and cut into line-aligned chunks that are parsed on all
+// cores with std::from_chars, then merged. Polygons are fan-triangulated and split into one
+// Mesh per "usemtl" group, each with its own compact vertex array. Mesh only carries
+// positions, so corners are deduplicated by their v index and vt/vn are skipped.
+namespace ObjImporter {
+    // Revision of what load() produces; bumping it invalidates cooked imports (AssetCache)
+    constexpr int kVersion = 1;
+    constexpr std::size_t kChunkBytes = 4u << 20;
+    // Null (with a reason in 'error') if the file can't be read or a face refers to a missing vertex
+    std::unique_ptr<Model> load(const std::string& path, std::string* error = nullptr);
+    // Positions and triangles; each mesh becomes its own "usemtl" group
+    bool save(const Model& model, const std::string& path);
+}
+#endif // OBJIMPORTER_H
@@ -0,0 +1,15 @@
+#ifndef PLYLOADER_H
+#define PLYLOADER_H
+#include <memory>
+#include <string>
+#include "../../core/include/Model.h"
+// Binary PLY (either byte order) as a point-cloud Model. The vertex element's x/y/z and,
+// when present, red/green/blue/alpha are read from the mapped file and sorted into octree
+// cells (PointCloud) on all cores. Faces and other elements are ignored; points with
+// non-finite coordinates are dropped.
+namespace PlyLoader {
+    // Revision of what load() produces; bumping it invalidates cooked imports (AssetCache)
+    constexpr int kVersion = 1;
+    std::unique_ptr<Model> load(const std::string& path, std::string* error = nullptr);
+}
+#endif // PLYLOADER_H
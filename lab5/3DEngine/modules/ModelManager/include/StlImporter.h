@@ -0,0 +1,19 @@
+#ifndef STLIMPORTER_H
+#define STLIMPORTER_H
+#include <memory>
+#include <string>
+#include "../../core/include/Model.h"
+// Binary STL: the file is mapped and its three-corners-per-triangle soup welded on all cores
+// into one indexed Mesh. Positions are hashed by grid cell into a table shared by the
+// threads; a vertex is the first corner of its cell in file order, so the result doesn't
+// depend on the thread count. Triangles that collapse are dropped. Facet normals are not
+// kept: Mesh has no normal stream, and the renderer averages face normals over the shared
+// vertices, which welding is what makes possible.
+namespace StlImporter {
+    // Revision of what load() produces; bumping it invalidates cooked imports (AssetCache)
+    constexpr int kVersion = 1;
+    // Weld distance relative to the largest bounding-box extent; 0 welds equal positions only
+    constexpr float kDefaultTolerance = 1e-6f;
+    std::unique_ptr<Model> load(const std::string& path, float tolerance = kDefaultTolerance, std::string* error = nullptr);
+}
+#endif // STLIMPORTER_H
@@ -0,0 +1,110 @@
+#include "AssetCache.h"
+#include "ImportSupport.h"
+#include "../../core/include/Light.h"
+#include "../../core/include/SceneBinary.h"
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include <cstring>
+#include <filesystem>
+
+namespace AssetCache {
+
+namespace {
+constexpr std::uint64_t kHashBlock = 16u << 20;
+constexpr char kPointsMagic[8] = {'P','C','L','O','U','D','\0','\0'};
+
+// <key>.<i>.points: PointsHeader | PointCloud::Cell[cellCount] | PointCloud::Point[pointCount]
+struct PointsHeader {
+	char magic[8];
+	std::uint32_t hasColor, reserved;
+	std::uint64_t pointCount, cellCount;
+};
+static_assert(sizeof(PointsHeader) == 32, "PointsHeader layout");
+
+std::string scenePath(const std::string& dir, const std::string& key){ return (std::filesystem::path(dir) / (key + ".sceneb")).string(); }
+std::string pointsPath(const std::string& dir, const std::string& key, std::size_t model){
+	return (std::filesystem::path(dir) / (key + "." + std::to_string(model) + ".points")).string();
+}
+
+bool writePoints(const PointCloud& cloud, const std::string& path){
+	QSaveFile out(QString::fromStdString(path));
+	if(!out.open(QIODevice::WriteOnly)) return false;
+	PointsHeader h{};
+	std::memcpy(h.magic, kPointsMagic, sizeof(kPointsMagic));
+	h.hasColor = cloud.hasColor ? 1 : 0;
+	h.pointCount = cloud.points.size(); h.cellCount = cloud.cells.size();
+	auto put = [&](const void* p, std::uint64_t n){ return !n || out.write(static_cast<const char*>(p), static_cast<qint64>(n)) == static_cast<qint64>(n); };
+	if(!put(&h, sizeof(h)) || !put(cloud.cells.data(), h.cellCount * sizeof(PointCloud::Cell))
+	   || !put(cloud.points.data(), h.pointCount * sizeof(PointCloud::Point))){ out.cancelWriting(); return false; }
+	return out.commit();
+}
+
+std::shared_ptr<const PointCloud> readPoints(const std::string& path){
+	ImportSupport::MappedFile file;
+	if(!file.open(path) || file.size < sizeof(PointsHeader)) return nullptr;
+	PointsHeader h; std::memcpy(&h, file.data, sizeof(h));
+	if(std::memcmp(h.magic, kPointsMagic, sizeof(kPointsMagic)) != 0) return nullptr;
+	const std::uint64_t payload = file.size - sizeof(h);
+	if(h.cellCount > payload / sizeof(PointCloud::Cell)) return nullptr;
+	const std::uint64_t cellBytes = h.cellCount * sizeof(PointCloud::Cell);
+	if(h.pointCount != (payload - cellBytes) / sizeof(PointCloud::Point) || (payload - cellBytes) % sizeof(PointCloud::Point)) return nullptr;
+	auto cloud = std::make_shared<PointCloud>();
+	cloud->hasColor = h.hasColor != 0;
+	cloud->cells.resize(static_cast<std::size_t>(h.cellCount));
+	cloud->points.resize(static_cast<std::size_t>(h.pointCount));
+	if(cellBytes) std::memcpy(cloud->cells.data(), file.data + sizeof(h), cellBytes);
+	if(h.pointCount) std::memcpy(cloud->points.data(), file.data + sizeof(h) + cellBytes, h.pointCount * sizeof(PointCloud::Point));
+	for(const auto& c : cloud->cells) if(c.first > h.pointCount || c.count > h.pointCount - c.first) return nullptr;
+	return cloud;
+}
+}
+
+std::string key(const std::string& sourcePath, const std::string& settings){
+	ImportSupport::MappedFile file;
+	if(!file.open(sourcePath)) return {};
+	// Blocks are hashed on all cores; the key hashes their digests
+	const std::size_t blocks = static_cast<std::size_t>((file.size + kHashBlock - 1) / kHashBlock);
+	std::vector<QByteArray> digests(blocks);
+	ImportSupport::runParallel(blocks, [&](std::size_t b){
+		const std::uint64_t begin = b * kHashBlock, n = std::min(kHashBlock, file.size - begin);
+		digests[b] = QCryptographicHash::hash(QByteArray::fromRawData(reinterpret_cast<const char*>(file.data + begin), static_cast<int>(n)), QCryptographicHash::Md5);
+	});
+	QCryptographicHash h(QCryptographicHash::Md5);
+	for(const QByteArray& d : digests) h.addData(d);
+	h.addData(QByteArray::number(static_cast<qulonglong>(file.size)));
+	h.addData(QByteArray::fromStdString(settings));
+	return h.result().toHex().toStdString();
+}
+
+bool load(const std::string& dir, const std::string& key, std::vector<std::unique_ptr<Model>>& out){
+	const std::string path = scenePath(dir, key);
+	std::error_code ec;
+	if(!std::filesystem::exists(path, ec)) return false;
+	std::vector<std::unique_ptr<Light>> lights;
+	std::vector<std::unique_ptr<Model>> models;
+	if(!SceneBinary::read(path, lights, models) || models.empty()) return false;
+	for(std::size_t i=0;i<models.size();i++){
+		const std::string points = pointsPath(dir, key, i);
+		if(!std::filesystem::exists(points, ec)) continue;
+		if(!(models[i]->points = readPoints(points))) return false;
+	}
+	for(auto& m : models) out.push_back(std::move(m));
+	return true;
+}
+
+bool store(const std::string& dir, const std::string& key, const std::vector<std::unique_ptr<Model>>& models){
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+	if(ec) return false;
+	std::vector<const Model*> list;
+	for(std::size_t i=0;i<models.size();i++){
+		const Model* m = models[i].get();
+		if(!m) return false; // the model table must line up with the .points indices
+		if(m->points && !writePoints(*m->points, pointsPath(dir, key, i))) return false;
+		list.push_back(m);
+	}
+	// Written last: its presence marks the entry complete
+	return SceneBinary::saveModels(list, scenePath(dir, key));
+}
+
+}
@@ -0,0 +1,331 @@
+#include "GltfLoader.h"
+#include "ImportSupport.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+namespace GltfLoader {
+
+namespace {
+constexpr std::uint32_t kMagic = 0x46546C67;     // "glTF"
+constexpr std::uint32_t kChunkJson = 0x4E4F534A; // "JSON"
+constexpr std::uint32_t kChunkBin = 0x004E4942;  // "BIN\0"
+enum Component { Byte = 5120, UnsignedByte, Short, UnsignedShort, UnsignedInt = 5125, Float };
+
+// Converted data of one primitive, shared by every node instancing its mesh
+struct Converted {
+	// Mappings the views point into; positions and indices may come from different .bin files
+	std::shared_ptr<const void> positionFile, indexFile;
+	std::vector<Vec3> vertices;
+	std::vector<unsigned> indices;
+};
+
+struct Range { const uchar* data{nullptr}; std::uint64_t size{0}; std::shared_ptr<const void> keep; };
+struct Accessor {
+	const uchar* data{nullptr};
+	std::uint64_t count{0}, stride{0};
+	int component{0}, components{0};
+	bool normalized{false};
+	std::shared_ptr<const void> keep;
+};
+
+class Reader {
+public:
+	std::string error;
+	bool fail(const std::string& why){ if(error.empty()) error = why; return false; }
+
+	// Non-negative integer member, 'def' if absent
+	bool number(const QJsonObject& o, const char* key, std::uint64_t def, std::uint64_t& out){
+		const QJsonValue v = o.value(QString::fromLatin1(key));
+		if(v.isUndefined()){ out = def; return true; }
+		const double d = v.toDouble(-1.0);
+		if(!v.isDouble() || d < 0 || d > 9007199254740992.0 || std::floor(d) != d) return fail(std::string("bad '") + key + "'");
+		out = static_cast<std::uint64_t>(d);
+		return true;
+	}
+
+	bool buffers(const QJsonArray& list, const std::string& dir, const Range& glbBin){
+		for(int i=0;i<list.size();i++){
+			const QJsonObject b = list[i].toObject();
+			std::uint64_t length = 0;
+			if(!number(b, "byteLength", 0, length)) return false;
+			Range r;
+			if(!b.contains(QStringLiteral("uri"))){
+				if(i != 0 || !glbBin.data) return fail("buffer without data");
+				r = glbBin;
+			} else {
+				const QByteArray uri = QByteArray::fromPercentEncoding(b.value(QStringLiteral("uri")).toString().toUtf8());
+				if(uri.startsWith("data:")) return fail("embedded data URIs are not supported");
+				auto file = std::make_shared<ImportSupport::MappedFile>();
+				if(!file->open((std::filesystem::path(dir) / uri.toStdString()).string())) return fail("cannot read buffer " + uri.toStdString());
+				r.data = file->data; r.size = file->size; r.keep = file;
+			}
+			if(length > r.size) return fail("buffer shorter than its byteLength");
+			r.size = length;
+			bufferList.push_back(r);
+		}
+		return true;
+	}
+
+	bool views(const QJsonArray& list){
+		for(const auto& v : list){
+			const QJsonObject o = v.toObject();
+			std::uint64_t buffer = 0, offset = 0, length = 0, stride = 0;
+			if(!number(o, "buffer", ~0ull, buffer) || !number(o, "byteOffset", 0, offset) || !number(o, "byteLength", 0, length) || !number(o, "byteStride", 0, stride)) return false;
+			if(buffer >= bufferList.size()) return fail("bufferView refers to a missing buffer");
+			const Range& b = bufferList[buffer];
+			if(offset > b.size || length > b.size - offset) return fail("bufferView outside its buffer");
+			if(stride && (stride < 4 || stride > 252 || stride % 4)) return fail("bad byteStride");
+			viewList.push_back({{b.data + offset, length, b.keep}, stride});
+		}
+		return true;
+	}
+
+	bool accessor(const QJsonArray& list, std::uint64_t index, Accessor& a){
+		if(index >= static_cast<std::uint64_t>(list.size())) return fail("missing accessor");
+		const QJsonObject o = list[static_cast<int>(index)].toObject();
+		if(o.contains(QStringLiteral("sparse"))) return fail("sparse accessors are not supported");
+		std::uint64_t view = 0, offset = 0, component = 0;
+		if(!number(o, "bufferView", ~0ull, view) || !number(o, "byteOffset", 0, offset) || !number(o, "componentType", 0, component) || !number(o, "count", ~0ull, a.count)) return false;
+		if(view >= viewList.size()) return fail("accessor without bufferView");
+		static const char* types[] = {"SCALAR", "VEC2", "VEC3", "VEC4"};
+		const QString type = o.value(QStringLiteral("type")).toString();
+		a.components = 0;
+		for(int i=0;i<4;i++) if(type == QLatin1String(types[i])) a.components = i + 1;
+		const int size = componentSize(static_cast<int>(component));
+		if(!a.components || !size) return fail("unsupported accessor type");
+		a.component = static_cast<int>(component);
+		a.normalized = o.value(QStringLiteral("normalized")).toBool(false);
+		const View& v = viewList[view];
+		const std::uint64_t element = std::uint64_t(size) * a.components;
+		a.stride = v.stride ? v.stride : element;
+		if(a.stride < element || offset % size) return fail("misaligned accessor");
+		// Last element must end inside the view
+		if(a.count && (offset > v.range.size || element > v.range.size - offset || (a.count - 1) > (v.range.size - offset - element) / a.stride))
+			return fail("accessor outside its bufferView");
+		a.data = v.range.data + offset;
+		a.keep = v.range.keep;
+		return true;
+	}
+
+	static int componentSize(int c){
+		switch(c){
+		case Byte: case UnsignedByte: return 1;
+		case Short: case UnsignedShort: return 2;
+		case UnsignedInt: case Float: return 4;
+		default: return 0;
+		}
+	}
+
+private:
+	struct View { Range range; std::uint64_t stride; };
+	std::vector<Range> bufferList;
+	std::vector<View> viewList;
+};
+
+float component(const uchar* p, int type, bool normalized){
+	switch(type){
+	case Float: { float f; std::memcpy(&f, p, 4); return f; }
+	case Byte: { const auto v = static_cast<std::int8_t>(*p); return normalized ? std::max(v / 127.f, -1.f) : v; }
+	case UnsignedByte: return normalized ? *p / 255.f : *p;
+	case Short: { std::int16_t v; std::memcpy(&v, p, 2); return normalized ? std::max(v / 32767.f, -1.f) : v; }
+	case UnsignedShort: { std::uint16_t v; std::memcpy(&v, p, 2); return normalized ? v / 65535.f : v; }
+	default: { std::uint32_t v; std::memcpy(&v, p, 4); return static_cast<float>(v); }
+	}
+}
+
+bool aligned(const void* p, std::size_t a){ return reinterpret_cast<std::uintptr_t>(p) % a == 0; }
+
+// Column-major 4x4
+using Matrix = std::array<float,16>;
+Matrix multiply(const Matrix& a, const Matrix& b){
+	Matrix m{};
+	for(int c=0;c<4;c++) for(int r=0;r<4;r++){
+		float s = 0.f;
+		for(int k=0;k<4;k++) s += a[k*4+r] * b[c*4+k];
+		m[c*4+r] = s;
+	}
+	return m;
+}
+
+Matrix localMatrix(const QJsonObject& node){
+	auto floats = [&](const char* key, std::initializer_list<float> def){
+		std::vector<float> v(def);
+		const QJsonArray a = node.value(QString::fromLatin1(key)).toArray();
+		if(a.size() == static_cast<int>(v.size())) for(int i=0;i<a.size();i++) v[i] = static_cast<float>(a[i].toDouble());
+		return v;
+	};
+	Matrix m{1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
+	if(node.contains(QStringLiteral("matrix"))){
+		const auto v = floats("matrix", {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1});
+		std::copy(v.begin(), v.end(), m.begin());
+		return m;
+	}
+	const auto t = floats("translation", {0,0,0});
+	const auto q = floats("rotation", {0,0,0,1});
+	const auto s = floats("scale", {1,1,1});
+	const float x = q[0], y = q[1], z = q[2], w = q[3];
+	// T * R * S
+	const float r[9] = {1-2*(y*y+z*z), 2*(x*y+z*w), 2*(x*z-y*w),
+	                    2*(x*y-z*w), 1-2*(x*x+z*z), 2*(y*z+x*w),
+	                    2*(x*z+y*w), 2*(y*z-x*w), 1-2*(x*x+y*y)};
+	for(int c=0;c<3;c++) for(int k=0;k<3;k++) m[c*4+k] = r[c*3+k] * s[c];
+	m[12] = t[0]; m[13] = t[1]; m[14] = t[2];
+	return m;
+}
+}
+
+bool load(const std::string& path, std::vector<std::unique_ptr<Model>>& out, std::string* error){
+	Reader reader;
+	auto fail = [&](const std::string& why){ if(error) *error = why; return false; };
+	auto file = std::make_shared<ImportSupport::MappedFile>();
+	if(!file->open(path)) return fail("cannot read file");
+
+	// GLB: 12-byte header, then a JSON chunk and an optional BIN chunk
+	QByteArray json;
+	Range bin;
+	std::uint32_t header[3] = {};
+	if(file->size >= sizeof(header)) std::memcpy(header, file->data, sizeof(header));
+	if(header[0] == kMagic){
+		if(header[1] != 2) return fail("unsupported glTF version");
+		const std::uint64_t length = std::min<std::uint64_t>(header[2], file->size);
+		std::uint64_t at = sizeof(header);
+		for(int chunk=0; at + 8 <= length; chunk++){
+			std::uint32_t c[2]; std::memcpy(c, file->data + at, sizeof(c));
+			at += 8;
+			if(c[0] > length - at) return fail("truncated chunk");
+			if(chunk == 0 && c[1] == kChunkJson) json = QByteArray(reinterpret_cast<const char*>(file->data + at), static_cast<qsizetype>(c[0]));
+			else if(chunk == 1 && c[1] == kChunkBin){ bin.data = file->data + at; bin.size = c[0]; bin.keep = file; }
+			at += (std::uint64_t(c[0]) + 3) & ~std::uint64_t(3);
+		}
+		if(json.isEmpty()) return fail("no JSON chunk");
+	} else {
+		json = QByteArray(reinterpret_cast<const char*>(file->data), static_cast<qsizetype>(file->size));
+	}
+	const QJsonObject doc = QJsonDocument::fromJson(json).object();
+	if(doc.isEmpty()) return fail("malformed JSON");
+	const std::string dir = std::filesystem::path(path).parent_path().string();
+	if(!reader.buffers(doc.value(QStringLiteral("buffers")).toArray(), dir, bin) || !reader.views(doc.value(QStringLiteral("bufferViews")).toArray()))
+		return fail(reader.error);
+
+	// Meshes: each triangle primitive once, shared by the nodes that use it
+	const QJsonArray accessors = doc.value(QStringLiteral("accessors")).toArray();
+	const QJsonArray materials = doc.value(QStringLiteral("materials")).toArray();
+	const QJsonArray meshList = doc.value(QStringLiteral("meshes")).toArray();
+	std::vector<std::vector<Mesh>> meshes(static_cast<std::size_t>(meshList.size()));
+	std::vector<Color> meshColor(meshes.size(), Color::White());
+	for(int mi=0;mi<meshList.size();mi++){
+		const QJsonArray primitives = meshList[mi].toObject().value(QStringLiteral("primitives")).toArray();
+		for(const auto& pv : primitives){
+			const QJsonObject p = pv.toObject();
+			std::uint64_t mode = 4, positionIndex = 0, material = 0;
+			if(!reader.number(p, "mode", 4, mode)) return fail(reader.error);
+			const QJsonObject attributes = p.value(QStringLiteral("attributes")).toObject();
+			if(mode != 4 || !attributes.contains(QStringLiteral("POSITION"))) continue; // only triangle lists are drawn
+			Accessor pos, idx;
+			if(!reader.number(attributes, "POSITION", 0, positionIndex) || !reader.accessor(accessors, positionIndex, pos)) return fail(reader.error);
+			if(pos.components != 3) return fail("POSITION is not VEC3");
+			const bool indexed = p.contains(QStringLiteral("indices"));
+			std::uint64_t indicesIndex = 0;
+			if(indexed && (!reader.number(p, "indices", 0, indicesIndex) || !reader.accessor(accessors, indicesIndex, idx))) return fail(reader.error);
+			if(indexed && (idx.components != 1 || (idx.component != UnsignedByte && idx.component != UnsignedShort && idx.component != UnsignedInt)))
+				return fail("bad index accessor");
+			if(pos.count > std::numeric_limits<unsigned>::max()) return fail("too many vertices");
+
+			auto converted = std::make_shared<Converted>();
+			converted->positionFile = pos.keep;
+			if(indexed) converted->indexFile = idx.keep;
+			Mesh mesh;
+			mesh.viewVertexCount = static_cast<std::size_t>(pos.count);
+			if(pos.component == Float && !pos.normalized && pos.stride == sizeof(Vec3) && aligned(pos.data, alignof(float))){
+				mesh.viewVertices = reinterpret_cast<const Vec3*>(pos.data);
+			} else {
+				const int size = Reader::componentSize(pos.component);
+				converted->vertices.resize(mesh.viewVertexCount);
+				for(std::size_t i=0;i<converted->vertices.size();i++){
+					const uchar* e = pos.data + i * pos.stride;
+					converted->vertices[i] = {component(e, pos.component, pos.normalized), component(e + size, pos.component, pos.normalized), component(e + 2*size, pos.component, pos.normalized)};
+				}
+				mesh.viewVertices = converted->vertices.data();
+			}
+			if(!indexed){
+				converted->indices.resize(mesh.viewVertexCount);
+				for(std::size_t i=0;i<converted->indices.size();i++) converted->indices[i] = static_cast<unsigned>(i);
+				mesh.viewIndices = converted->indices.data();
+				mesh.viewIndexCount = converted->indices.size();
+			} else {
+				mesh.viewIndexCount = static_cast<std::size_t>(idx.count);
+				if(idx.component == UnsignedInt && idx.stride == sizeof(unsigned) && aligned(idx.data, alignof(unsigned))){
+					mesh.viewIndices = reinterpret_cast<const unsigned*>(idx.data);
+				} else {
+					converted->indices.resize(mesh.viewIndexCount);
+					for(std::size_t i=0;i<converted->indices.size();i++) converted->indices[i] = static_cast<unsigned>(component(idx.data + i * idx.stride, idx.component, false));
+					mesh.viewIndices = converted->indices.data();
+				}
+				// The GPU path trusts indices, so they are checked once here
+				for(std::size_t i=0;i<mesh.viewIndexCount;i++) if(mesh.viewIndices[i] >= mesh.viewVertexCount) return fail("index out of range");
+			}
+			// The converted arrays keep every buffer a zero-copy view still points into
+			mesh.backing = converted;
+			meshes[mi].push_back(std::move(mesh));
+			if(meshes[mi].size() == 1 && reader.number(p, "material", ~0ull, material) && material < static_cast<std::uint64_t>(materials.size())){
+				const QJsonArray c = materials[static_cast<int>(material)].toObject().value(QStringLiteral("pbrMetallicRoughness")).toObject().value(QStringLiteral("baseColorFactor")).toArray();
+				if(c.size() == 4) meshColor[mi] = {static_cast<float>(c[0].toDouble()), static_cast<float>(c[1].toDouble()), static_cast<float>(c[2].toDouble()), static_cast<float>(c[3].toDouble())};
+			}
+		}
+	}
+
+	// Nodes: world matrices down from the scene's roots (or every parentless node)
+	const QJsonArray nodes = doc.value(QStringLiteral("nodes")).toArray();
+	std::vector<int> roots;
+	std::uint64_t sceneIndex = 0;
+	const QJsonArray scenes = doc.value(QStringLiteral("scenes")).toArray();
+	if(!reader.number(doc, "scene", 0, sceneIndex)) return fail(reader.error);
+	if(sceneIndex < static_cast<std::uint64_t>(scenes.size())){
+		for(const auto& n : scenes[static_cast<int>(sceneIndex)].toObject().value(QStringLiteral("nodes")).toArray()) roots.push_back(n.toInt(-1));
+	} else {
+		std::vector<char> child(static_cast<std::size_t>(nodes.size()), 0);
+		for(const auto& n : nodes) for(const auto& c : n.toObject().value(QStringLiteral("children")).toArray()){ const int k = c.toInt(-1); if(k >= 0 && k < nodes.size()) child[k] = 1; }
+		for(int i=0;i<nodes.size();i++) if(!child[i]) roots.push_back(i);
+	}
+	const std::string stem = std::filesystem::path(path).stem().string();
+	std::vector<char> visited(static_cast<std::size_t>(nodes.size()), 0);
+	std::vector<std::unique_ptr<Model>> models;
+	std::vector<std::pair<int, Matrix>> stack;
+	for(auto it = roots.rbegin(); it != roots.rend(); ++it) stack.emplace_back(*it, Matrix{1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1});
+	while(!stack.empty()){
+		const auto [index, parent] = stack.back();
+		stack.pop_back();
+		if(index < 0 || index >= nodes.size() || visited[index]) return fail("node hierarchy is not a tree");
+		visited[index] = 1;
+		const QJsonObject node = nodes[index].toObject();
+		const Matrix world = multiply(parent, localMatrix(node));
+		std::uint64_t mesh = 0;
+		if(node.contains(QStringLiteral("mesh"))){
+			if(!reader.number(node, "mesh", 0, mesh) || mesh >= meshes.size()) return fail("node refers to a missing mesh");
+			if(!meshes[mesh].empty()){
+				auto m = std::make_unique<Model>();
+				m->name = node.value(QStringLiteral("name")).toString().toStdString();
+				if(m->name.empty()) m->name = meshList[static_cast<int>(mesh)].toObject().value(QStringLiteral("name")).toString().toStdString();
+				if(m->name.empty()) m->name = stem + "#" + std::to_string(index);
+				m->meshes = meshes[mesh];
+				m->material.diffuse = meshColor[mesh];
+				m->transform = world;
+				models.push_back(std::move(m));
+			}
+		}
+		const QJsonArray children = node.value(QStringLiteral("children")).toArray();
+		for(int c=children.size()-1;c>=0;c--) stack.emplace_back(children[c].toInt(-1), world);
+	}
+	for(auto& m : models) out.push_back(std::move(m));
+	return true;
+}
+
+}
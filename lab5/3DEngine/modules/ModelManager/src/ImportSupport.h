@@ -0,0 +1,40 @@
+#ifndef IMPORTSUPPORT_H
+#define IMPORTSUPPORT_H
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "JobSystem.h"
+// Shared by the importers in this module
+namespace ImportSupport {
+    // Read-only mapping of a whole file (read into memory where mapping is refused);
+    // held through a shared_ptr while Mesh views point into it
+    struct MappedFile {
+        QFile file;
+        QByteArray fallback;
+        const uchar* data{nullptr};
+        std::uint64_t size{0};
+        uchar* mapped{nullptr};
+        ~MappedFile(){ if(mapped) file.unmap(mapped); }
+        bool open(const std::string& path){
+            file.setFileName(QString::fromStdString(path));
+            if(!file.open(QIODevice::ReadOnly)) return false;
+            size = static_cast<std::uint64_t>(file.size());
+            if(!size) return true;
+            if((mapped = file.map(0, file.size()))){ data = mapped; return true; }
+            fallback = file.readAll();
+            data = reinterpret_cast<const uchar*>(fallback.constData());
+            return static_cast<std::uint64_t>(fallback.size()) == size;
+        }
+    };
+
+    // job(i) for i in [0, count) on the shared job pool
+    template <class Job> void runParallel(std::size_t count, const Job& job){ JobSystem::instance().parallelFor(count, job); }
+    // Blocks per pass: a few per thread, so stealing evens them out
+    inline std::size_t blocksPerPass(){ return std::size_t(JobSystem::instance().threadCount()) * 4; }
+}
+#endif // IMPORTSUPPORT_H
@@ -1,5 +1,57 @@
 #include "ModelManager.h"
-#include <fstream>
-Model* ModelManager::loadModel(const std::string& filename){ auto m = std::make_unique<Model>(); m->name = filename; owned.push_back(std::move(m)); return owned.back().get(); }
-bool ModelManager::saveModel(Model* model,const std::string& filename){ std::ofstream f(filename); if(!f) return false; f<<"MODEL "<<model->name; return true; }
+#include "ObjImporter.h"
+#include "GltfLoader.h"
+#include "StlImporter.h"
+#include "PlyLoader.h"
+#include "AssetCache.h"
+#include "../../core/include/JobSystem.h"
+#include <cctype>
+#include <filesystem>
+void ModelManager::shareJobSystem(JobSystem& jobs){ JobSystem::setInstance(jobs); }
+
+Model* ModelManager::loadModel(const std::string& filename){
+	std::vector<std::unique_ptr<Model>> models;
+	if(!importModels(filename, models) || models.empty()) return nullptr;
+	const std::size_t first = owned.size();
+	for(auto& m : models) owned.push_back(std::move(m));
+	return owned[first].get();
+}
+// Everything besides the source bytes that decides an import's output; empty if the result
+// also depends on other files (.gltf buffers), which the cache key wouldn't see
+static std::string cookSettings(const std::string& ext){
+	if(ext == ".gltf") return {};
+	if(ext == ".glb") return "glb/" + std::to_string(GltfLoader::kVersion);
+	if(ext == ".stl") return "stl/" + std::to_string(StlImporter::kVersion) + "/" + std::to_string(StlImporter::kDefaultTolerance);
+	if(ext == ".ply") return "ply/" + std::to_string(PlyLoader::kVersion);
+	if(ext == ".obj") return "obj/" + std::to_string(ObjImporter::kVersion);
+	return {};
+}
+static bool supported(const std::string& ext){ return ext == ".glb" || ext == ".gltf" || ext == ".stl" || ext == ".ply" || ext == ".obj"; }
+static bool importFile(const std::string& filename, const std::string& ext, std::vector<std::unique_ptr<Model>>& out, std::string* error){
+	if(ext == ".glb" || ext == ".gltf") return GltfLoader::load(filename, out, error);
+	auto m = ext == ".stl" ? StlImporter::load(filename, StlImporter::kDefaultTolerance, error)
+	       : ext == ".ply" ? PlyLoader::load(filename, error)
+	       : ObjImporter::load(filename, error);
+	if(!m) return false;
+	out.push_back(std::move(m));
+	return true;
+}
+bool ModelManager::importModels(const std::string& filename, std::vector<std::unique_ptr<Model>>& out, std::string* error){
+	std::string ext = std::filesystem::path(filename).extension().string();
+	for(char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	if(!supported(ext)){
+		if(error) *error = "unsupported file type" + (ext.empty() ? std::string() : " '" + ext + "'");
+		return false;
+	}
+	const std::string settings = cacheDir.empty() ? std::string() : cookSettings(ext);
+	const std::string key = settings.empty() ? std::string() : AssetCache::key(filename, settings);
+	if(!key.empty() && AssetCache::load(cacheDir, key, out)) return true;
+	std::vector<std::unique_ptr<Model>> models;
+	if(!importFile(filename, ext, models, error)) return false;
+	// A failed store only costs the next open a full import
+	if(!key.empty()) AssetCache::store(cacheDir, key, models);
+	for(auto& m : models) out.push_back(std::move(m));
+	return true;
+}
+bool ModelManager::saveModel(Model* model,const std::string& filename){ return model && ObjImporter::save(*model, filename); }
 bool ModelManager::applyTexture(const std::string& textureFile, Model* model){ model->texture.file = textureFile; model->texture.loaded = true; return true; }
@@ -0,0 +1,212 @@
+#include "ObjImporter.h"
+#include "ImportSupport.h"
+#include "../../core/include/SceneText.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace ObjImporter {
+
+using ImportSupport::runParallel;
+
+namespace {
+bool isSpace(char c){ return c==' ' || c=='\t' || c=='\r'; }
+void skipSpace(const char*& p, const char* e){ while(p<e && isSpace(*p)) ++p; }
+void skipToken(const char*& p, const char* e){ while(p<e && !isSpace(*p)) ++p; }
+
+bool parseFloat(const char*& p, const char* e, float& v){
+	skipSpace(p, e);
+	if(p<e && *p=='+') ++p; // from_chars takes no leading '+'
+	const auto r = std::from_chars(p, e, v);
+	if(r.ec != std::errc()) return false;
+	p = r.ptr;
+	return true;
+}
+
+// What one chunk of lines contributes; face corners are 0-based v indices
+struct Part {
+	std::vector<Vec3> positions;
+	std::vector<std::uint32_t> corners;     // three per triangle
+	std::vector<std::size_t> relative;      // corners given as negative (relative) indices: still chunk-local, mod 2^32
+	std::vector<std::pair<std::size_t, std::string>> materials; // usemtl: first corner it applies to
+	std::size_t badLine{0};                 // 1-based line within the chunk, 0 = all fine
+};
+
+void parsePart(const char* p, const char* e, Part& out){
+	std::vector<std::uint32_t> polygon;
+	std::vector<bool> polygonRelative;
+	std::size_t line = 0;
+	while(p < e){
+		++line;
+		const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(e - p)));
+		const char* end = nl ? nl : e;
+		skipSpace(p, end);
+		if(end - p >= 2 && p[0]=='v' && isSpace(p[1])){
+			Vec3 v; p += 2;
+			if(!parseFloat(p, end, v.x) || !parseFloat(p, end, v.y) || !parseFloat(p, end, v.z)){ out.badLine = line; return; }
+			out.positions.push_back(v);
+		} else if(end - p >= 2 && p[0]=='f' && isSpace(p[1])){
+			p += 2;
+			polygon.clear(); polygonRelative.clear();
+			for(skipSpace(p, end); p < end; skipSpace(p, end)){
+				long long idx = 0;
+				const auto r = std::from_chars(p, end, idx);
+				if(r.ec != std::errc() || idx == 0 || idx > 0xFFFFFFFFll || idx < -0xFFFFFFFFll){ out.badLine = line; return; }
+				p = r.ptr;
+				skipToken(p, end); // "/vt/vn"
+				// Negative indices count back from the vertices seen so far
+				if(idx < 0){ polygon.push_back(static_cast<std::uint32_t>(static_cast<long long>(out.positions.size()) + idx)); polygonRelative.push_back(true); }
+				else { polygon.push_back(static_cast<std::uint32_t>(idx - 1)); polygonRelative.push_back(false); }
+			}
+			for(std::size_t k=2;k<polygon.size();k++){
+				for(std::size_t c : {std::size_t(0), k-1, k}){
+					if(polygonRelative[c]) out.relative.push_back(out.corners.size());
+					out.corners.push_back(polygon[c]);
+				}
+			}
+		} else if(end - p >= 7 && std::memcmp(p, "usemtl", 6) == 0 && isSpace(p[6])){
+			p += 7; skipSpace(p, end);
+			const char* last = end;
+			while(last > p && isSpace(last[-1])) --last;
+			out.materials.emplace_back(out.corners.size(), std::string(p, last));
+		}
+		// vt, vn, o, g, s, mtllib, comments: not represented in Mesh
+		p = nl ? nl + 1 : e;
+	}
+}
+}
+
+std::unique_ptr<Model> load(const std::string& path, std::string* error){
+	auto fail = [&](const std::string& why){ if(error) *error = why; return std::unique_ptr<Model>(); };
+	ImportSupport::MappedFile file;
+	if(!file.open(path)) return fail("cannot read file");
+	const char* begin = reinterpret_cast<const char*>(file.data);
+	const char* end = begin + file.size;
+
+	// Line-aligned chunks of about kChunkBytes
+	std::vector<const char*> cuts{begin};
+	while(cuts.back() < end){
+		const char* at = cuts.back() + std::min<std::size_t>(kChunkBytes, static_cast<std::size_t>(end - cuts.back()));
+		if(at < end){
+			const char* nl = static_cast<const char*>(std::memchr(at, '\n', static_cast<std::size_t>(end - at)));
+			at = nl ? nl + 1 : end;
+		}
+		cuts.push_back(at);
+	}
+	std::vector<Part> parts(cuts.size() - 1);
+	runParallel(parts.size(), [&](std::size_t i){ parsePart(cuts[i], cuts[i+1], parts[i]); });
+	for(std::size_t i=0;i<parts.size();i++){
+		if(!parts[i].badLine) continue;
+		const std::size_t before = static_cast<std::size_t>(std::count(begin, cuts[i], '\n'));
+		return fail("malformed line " + std::to_string(before + parts[i].badLine));
+	}
+
+	// Merge: one position array, relative corners made absolute, every corner checked
+	std::vector<std::size_t> base(parts.size() + 1, 0);
+	for(std::size_t i=0;i<parts.size();i++) base[i+1] = base[i] + parts[i].positions.size();
+	const std::size_t vertexCount = base.back();
+	if(vertexCount >= 0xFFFFFFFFull) return fail("too many vertices");
+	std::vector<Vec3> positions(vertexCount);
+	std::atomic<bool> outOfRange{false};
+	runParallel(parts.size(), [&](std::size_t i){
+		Part& part = parts[i];
+		if(!part.positions.empty()) std::memcpy(positions.data() + base[i], part.positions.data(), part.positions.size() * sizeof(Vec3));
+		std::vector<Vec3>().swap(part.positions);
+		// Wraps around for references into earlier chunks; anything left out of range is caught below
+		for(std::size_t c : part.relative) part.corners[c] += static_cast<std::uint32_t>(base[i]);
+		for(std::uint32_t c : part.corners) if(c >= vertexCount){ outOfRange.store(true); break; }
+	});
+	if(outOfRange.load()) return fail("face refers to a missing vertex");
+
+	// Runs of corners per material, in file order
+	struct Run { std::size_t part, begin, end; };
+	std::vector<std::string> names;
+	std::vector<std::vector<Run>> groups;
+	std::unordered_map<std::string, std::size_t> groupOf;
+	std::size_t current = 0;
+	auto select = [&](const std::string& name){
+		auto it = groupOf.find(name);
+		if(it == groupOf.end()){ it = groupOf.emplace(name, names.size()).first; names.push_back(name); groups.emplace_back(); }
+		current = it->second;
+	};
+	select(std::string());
+	for(std::size_t i=0;i<parts.size();i++){
+		std::size_t from = 0;
+		for(const auto& m : parts[i].materials){
+			if(m.first > from) groups[current].push_back({i, from, m.first});
+			from = m.first;
+			select(m.second);
+		}
+		if(parts[i].corners.size() > from) groups[current].push_back({i, from, parts[i].corners.size()});
+	}
+
+	auto model = std::make_unique<Model>();
+	model->name = std::filesystem::path(path).stem().string();
+	// Dense v -> mesh vertex table; only the touched entries are reset between groups
+	constexpr unsigned kUnused = ~0u;
+	std::vector<unsigned> remap;
+	for(std::size_t g=0;g<groups.size();g++){
+		if(groups[g].empty()) continue;
+		if(remap.empty()) remap.assign(vertexCount, kUnused);
+		Mesh mesh;
+		std::size_t cornerCount = 0;
+		for(const Run& r : groups[g]) cornerCount += r.end - r.begin;
+		mesh.indices.reserve(cornerCount);
+		for(const Run& r : groups[g]){
+			const std::uint32_t* c = parts[r.part].corners.data();
+			for(std::size_t k=r.begin;k<r.end;k++){
+				unsigned& slot = remap[c[k]];
+				if(slot == kUnused){ slot = static_cast<unsigned>(mesh.vertices.size()); mesh.vertices.push_back(positions[c[k]]); }
+				mesh.indices.push_back(slot);
+			}
+		}
+		for(const Run& r : groups[g]){
+			const std::uint32_t* c = parts[r.part].corners.data();
+			for(std::size_t k=r.begin;k<r.end;k++) remap[c[k]] = kUnused;
+		}
+		model->meshes.push_back(std::move(mesh));
+	}
+	// Points only: keep them as an unindexed mesh
+	if(model->meshes.empty() && vertexCount){
+		Mesh mesh;
+		mesh.vertices = std::move(positions);
+		model->meshes.push_back(std::move(mesh));
+	}
+	return model;
+}
+
+bool save(const Model& model, const std::string& path){
+	std::ofstream f(path, std::ios::binary);
+	if(!f) return false;
+	std::string out = "o " + model.name + "\n";
+	std::size_t offset = 1;
+	auto flush = [&](bool force){ if(force || out.size() > (1u << 20)){ f.write(out.data(), static_cast<std::streamsize>(out.size())); out.clear(); } };
+	for(std::size_t i=0;i<model.meshes.size();i++){
+		const Mesh& mesh = model.meshes[i];
+		out += "usemtl mesh" + std::to_string(i) + "\n";
+		const Vec3* v = mesh.vertexData();
+		for(std::size_t k=0;k<mesh.vertexCount();k++){
+			out += "v "; SceneText::appendFloat(out, v[k].x);
+			out += ' '; SceneText::appendFloat(out, v[k].y);
+			out += ' '; SceneText::appendFloat(out, v[k].z);
+			out += '\n';
+			flush(false);
+		}
+		const unsigned* idx = mesh.indexData();
+		for(std::size_t k=0;k+2<mesh.indexCount();k+=3){
+			out += 'f';
+			for(std::size_t c=0;c<3;c++){ out += ' '; SceneText::appendUnsigned(out, offset + idx[k+c]); }
+			out += '\n';
+			flush(false);
+		}
+		offset += mesh.vertexCount();
+	}
+	flush(true);
+	return static_cast<bool>(f);
+}
+
+}
@@ -0,0 +1,311 @@
+#include "PlyLoader.h"
+#include "ImportSupport.h"
+#include <QSysInfo>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+namespace PlyLoader {
+
+using ImportSupport::runParallel;
+using Point = PointCloud::Point;
+using Cell = PointCloud::Cell;
+
+namespace {
+constexpr int kMaxDepth = 20;       // below that float positions stop separating anyway
+constexpr int kMaxTopLevels = 4;    // octree levels split by the parallel scatter (8^4 buckets)
+constexpr std::size_t kMaxHeaderBytes = 1 << 16;
+
+enum class Type { None, Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+Type typeOf(const std::string& t){
+	if(t == "char" || t == "int8") return Type::Int8;
+	if(t == "uchar" || t == "uint8") return Type::UInt8;
+	if(t == "short" || t == "int16") return Type::Int16;
+	if(t == "ushort" || t == "uint16") return Type::UInt16;
+	if(t == "int" || t == "int32") return Type::Int32;
+	if(t == "uint" || t == "uint32") return Type::UInt32;
+	if(t == "float" || t == "float32") return Type::Float32;
+	if(t == "double" || t == "float64") return Type::Float64;
+	return Type::None;
+}
+
+std::size_t sizeOf(Type t){
+	switch(t){
+	case Type::Int8: case Type::UInt8: return 1;
+	case Type::Int16: case Type::UInt16: return 2;
+	case Type::Int32: case Type::UInt32: case Type::Float32: return 4;
+	case Type::Float64: return 8;
+	default: return 0;
+	}
+}
+
+struct Field { std::size_t offset{0}; Type type{Type::None}; };
+
+// Where the vertices are and which of their properties are read
+struct Layout {
+	std::uint64_t offset{0}, count{0};
+	std::size_t stride{0};
+	bool swap{false};
+	Field position[3];
+	Field color[4]; // red, green, blue, alpha
+	bool hasColor() const { return color[0].type != Type::None && color[1].type != Type::None && color[2].type != Type::None; }
+};
+
+double readValue(const uchar* p, Type t, bool swap){
+	uchar b[8];
+	const std::size_t n = sizeOf(t);
+	for(std::size_t i=0;i<n;i++) b[i] = swap ? p[n - 1 - i] : p[i];
+	switch(t){
+	case Type::Int8: { std::int8_t v; std::memcpy(&v, b, 1); return v; }
+	case Type::UInt8: return b[0];
+	case Type::Int16: { std::int16_t v; std::memcpy(&v, b, 2); return v; }
+	case Type::UInt16: { std::uint16_t v; std::memcpy(&v, b, 2); return v; }
+	case Type::Int32: { std::int32_t v; std::memcpy(&v, b, 4); return v; }
+	case Type::UInt32: { std::uint32_t v; std::memcpy(&v, b, 4); return v; }
+	case Type::Float32: { float v; std::memcpy(&v, b, 4); return v; }
+	case Type::Float64: { double v; std::memcpy(&v, b, 8); return v; }
+	default: return 0;
+	}
+}
+
+// Colour channels to 0..255: floats are 0..1, 16-bit channels are scaled down
+std::uint32_t channel(const uchar* p, const Field& f, bool swap){
+	if(f.type == Type::None) return 255;
+	const double v = readValue(p + f.offset, f.type, swap);
+	const double scaled = f.type == Type::Float32 || f.type == Type::Float64 ? v * 255.0 : f.type == Type::UInt16 ? v / 257.0 : v;
+	return static_cast<std::uint32_t>(std::lround(std::min(255.0, std::max(0.0, scaled))));
+}
+
+bool parseHeader(const uchar* data, std::uint64_t size, Layout& out, std::string& error){
+	const std::string head(reinterpret_cast<const char*>(data), static_cast<std::size_t>(std::min<std::uint64_t>(size, kMaxHeaderBytes)));
+	const std::size_t end = head.find("end_header");
+	const std::size_t body = end == std::string::npos ? end : head.find('\n', end);
+	if(head.compare(0, 3, "ply") != 0 || body == std::string::npos){ error = "not a PLY file"; return false; }
+	struct Element { std::string name; std::uint64_t count{0}; std::size_t size{0}; bool variable{false}; };
+	std::vector<Element> elements;
+	std::istringstream lines(head.substr(0, end));
+	std::string line;
+	bool format = false;
+	while(std::getline(lines, line)){
+		std::istringstream in(line);
+		std::string word;
+		in >> word;
+		if(word == "format"){
+			std::string kind; in >> kind;
+			if(kind == "ascii"){ error = "ASCII PLY is not supported"; return false; }
+			if(kind != "binary_little_endian" && kind != "binary_big_endian"){ error = "unknown PLY format"; return false; }
+			out.swap = (kind == "binary_big_endian") != (QSysInfo::ByteOrder == QSysInfo::BigEndian);
+			format = true;
+		} else if(word == "element"){
+			Element e;
+			if(!(in >> e.name >> e.count)){ error = "bad element line"; return false; }
+			elements.push_back(e);
+		} else if(word == "property"){
+			if(elements.empty()){ error = "property outside an element"; return false; }
+			Element& e = elements.back();
+			std::string type, name; in >> type;
+			if(type == "list"){ e.variable = true; continue; }
+			in >> name;
+			const Type t = typeOf(type);
+			if(t == Type::None){ error = "unknown property type '" + type + "'"; return false; }
+			const Field f{e.size, t};
+			if(e.name == "vertex"){
+				if(name == "x") out.position[0] = f; else if(name == "y") out.position[1] = f; else if(name == "z") out.position[2] = f;
+				else if(name == "red" || name == "r" || name == "diffuse_red") out.color[0] = f;
+				else if(name == "green" || name == "g" || name == "diffuse_green") out.color[1] = f;
+				else if(name == "blue" || name == "b" || name == "diffuse_blue") out.color[2] = f;
+				else if(name == "alpha" || name == "a") out.color[3] = f;
+			}
+			e.size += sizeOf(t);
+		}
+	}
+	if(!format){ error = "missing format line"; return false; }
+	out.offset = body + 1;
+	std::size_t v = 0;
+	for(; v < elements.size() && elements[v].name != "vertex"; v++){
+		// Elements ahead of the vertices are skipped, which needs their size
+		if(elements[v].variable){ error = "variable-size element before the vertices"; return false; }
+		if(elements[v].size && elements[v].count > size / elements[v].size){ error = "truncated file"; return false; }
+		out.offset += elements[v].count * elements[v].size;
+	}
+	if(v == elements.size()){ error = "no vertex element"; return false; }
+	if(elements[v].variable){ error = "list properties on vertices are not supported"; return false; }
+	for(const Field& f : out.position) if(f.type == Type::None){ error = "vertices without x/y/z"; return false; }
+	out.count = elements[v].count;
+	out.stride = elements[v].size;
+	if(out.offset > size || out.count > (size - out.offset) / out.stride){ error = "truncated vertex data"; return false; }
+	return true;
+}
+
+// Splits [begin, end) of 'points' (already inside the cube at 'lo' with edge 'size') into
+// octants in place until cells are small enough; leaves are appended in depth-first order
+void split(Point* points, std::uint32_t begin, std::uint32_t end, const float lo[3], float size, int depth, std::vector<Cell>& cells){
+	if(begin == end) return;
+	if(end - begin <= PointCloud::kMaxCellPoints || depth >= kMaxDepth){
+		// Shuffled so that a prefix is an even subsample, then cut into cells of bounded size
+		std::uint64_t state = 0x9E3779B97F4A7C15ull ^ begin;
+		for(std::uint32_t i = end - 1; i > begin; --i){
+			state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+			std::swap(points[i], points[begin + state % (i - begin + 1)]);
+		}
+		for(std::uint32_t first = begin; first < end; first += PointCloud::kMaxCellPoints){
+			Cell c;
+			c.first = first;
+			c.count = std::min(end - first, PointCloud::kMaxCellPoints);
+			for(int a=0;a<3;a++){ c.boundsMin[a] = HUGE_VALF; c.boundsMax[a] = -HUGE_VALF; }
+			for(std::uint32_t i = first; i < first + c.count; i++){
+				const float p[3] = {points[i].position.x, points[i].position.y, points[i].position.z};
+				for(int a=0;a<3;a++){ c.boundsMin[a] = std::min(c.boundsMin[a], p[a]); c.boundsMax[a] = std::max(c.boundsMax[a], p[a]); }
+			}
+			cells.push_back(c);
+		}
+		return;
+	}
+	const float half = size / 2;
+	const float mid[3] = {lo[0] + half, lo[1] + half, lo[2] + half};
+	auto octant = [&](const Point& p){ return int(p.position.x >= mid[0]) | int(p.position.y >= mid[1]) << 1 | int(p.position.z >= mid[2]) << 2; };
+	std::uint32_t next[8] = {}, stop[8];
+	for(std::uint32_t i=begin;i<end;i++) ++next[octant(points[i])];
+	for(std::uint32_t k=0, at=begin;k<8;k++){ const std::uint32_t n = next[k]; next[k] = at; at += n; stop[k] = at; }
+	const std::array<std::uint32_t,8> starts{next[0], next[1], next[2], next[3], next[4], next[5], next[6], next[7]};
+	// In-place 8-way partition: each misplaced point is swapped straight into its octant
+	for(int k=0;k<8;k++){
+		while(next[k] < stop[k]){
+			const int o = octant(points[next[k]]);
+			if(o == k) ++next[k];
+			else std::swap(points[next[k]], points[next[o]++]);
+		}
+	}
+	for(int k=0;k<8;k++){
+		const float child[3] = {k & 1 ? mid[0] : lo[0], k & 2 ? mid[1] : lo[1], k & 4 ? mid[2] : lo[2]};
+		split(points, starts[k], stop[k], child, half, depth + 1, cells);
+	}
+}
+
+// Splits [0, count) into about 'blocks' contiguous ranges
+struct Blocks {
+	std::size_t count, size, n;
+	Blocks(std::size_t total, std::size_t blocks) : count(total), size(std::max<std::size_t>(1, (total + blocks - 1) / std::max<std::size_t>(1, blocks))), n((total + size - 1) / size) {}
+	std::size_t begin(std::size_t b) const { return b * size; }
+	std::size_t end(std::size_t b) const { return std::min(count, (b + 1) * size); }
+};
+}
+
+std::unique_ptr<Model> load(const std::string& path, std::string* error){
+	auto fail = [&](const std::string& why){ if(error) *error = why; return std::unique_ptr<Model>(); };
+	ImportSupport::MappedFile file;
+	if(!file.open(path)) return fail("cannot read file");
+	Layout layout;
+	std::string why;
+	if(!parseHeader(file.data, file.size, layout, why)) return fail(why);
+	if(layout.count >= 0xFFFFFFFFull) return fail("too many points");
+	const uchar* base = file.data + layout.offset;
+	// Native floats (by far the common case) are copied rather than converted
+	bool nativeFloats = !layout.swap;
+	for(const Field& f : layout.position) nativeFloats = nativeFloats && f.type == Type::Float32;
+	auto positionOf = [&](std::size_t i){
+		const uchar* v = base + i * layout.stride;
+		float q[3];
+		for(int a=0;a<3;a++){
+			if(nativeFloats) std::memcpy(&q[a], v + layout.position[a].offset, 4);
+			else q[a] = static_cast<float>(readValue(v + layout.position[a].offset, layout.position[a].type, layout.swap));
+		}
+		return Vec3{q[0], q[1], q[2]};
+	};
+	auto finite = [](const Vec3& p){ return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z); };
+	const Blocks blocks(layout.count, ImportSupport::blocksPerPass());
+
+	// Bounds of the finite points
+	std::vector<std::array<float,6>> bounds(blocks.n);
+	runParallel(blocks.n, [&](std::size_t b){
+		std::array<float,6> r{HUGE_VALF, HUGE_VALF, HUGE_VALF, -HUGE_VALF, -HUGE_VALF, -HUGE_VALF};
+		for(std::size_t i=blocks.begin(b);i<blocks.end(b);i++){
+			const Vec3 p = positionOf(i);
+			if(!finite(p)) continue;
+			r[0] = std::min(r[0], p.x); r[1] = std::min(r[1], p.y); r[2] = std::min(r[2], p.z);
+			r[3] = std::max(r[3], p.x); r[4] = std::max(r[4], p.y); r[5] = std::max(r[5], p.z);
+		}
+		bounds[b] = r;
+	});
+	std::array<float,6> all{HUGE_VALF, HUGE_VALF, HUGE_VALF, -HUGE_VALF, -HUGE_VALF, -HUGE_VALF};
+	for(const auto& r : bounds) for(int a=0;a<3;a++){ all[a] = std::min(all[a], r[a]); all[3+a] = std::max(all[3+a], r[3+a]); }
+	// The octree is a cube a little larger than the bounds, so the far faces fall inside it
+	const float lo[3] = {all[0], all[1], all[2]};
+	float size = 0.f;
+	for(int a=0;a<3;a++) size = std::max(size, all[3+a] - all[a]);
+	size = size > 0.f ? size * (1.f + 1e-5f) : 1.f;
+
+	// Scatter into the cells of the top levels, in Morton order; enough levels that
+	// there are several buckets per thread, but no more than the points can fill
+	int levels = 0;
+	while(levels < kMaxTopLevels && (std::uint64_t(PointCloud::kMaxCellPoints) << (3 * levels)) < layout.count) ++levels;
+	const std::size_t buckets = std::size_t(1) << (3 * levels);
+	const int grid = 1 << levels;
+	const float toGrid = grid / size;
+	std::uint32_t spread[1 << kMaxTopLevels] = {}; // bit l of g moved to bit 3l
+	for(int g=0;g<grid;g++) for(int l=0;l<levels;l++) spread[g] |= std::uint32_t(g >> l & 1) << (3 * l);
+	auto bucketOf = [&](const Vec3& p){
+		const float q[3] = {p.x, p.y, p.z};
+		std::size_t key = 0;
+		for(int a=0;a<3;a++) key |= std::size_t(spread[std::min(grid - 1, std::max(0, static_cast<int>((q[a] - lo[a]) * toGrid)))]) << a;
+		return key;
+	};
+	std::vector<std::uint32_t> counts(blocks.n * buckets, 0);
+	runParallel(blocks.n, [&](std::size_t b){
+		std::uint32_t* c = counts.data() + b * buckets;
+		for(std::size_t i=blocks.begin(b);i<blocks.end(b);i++){ const Vec3 p = positionOf(i); if(finite(p)) ++c[bucketOf(p)]; }
+	});
+	std::vector<std::uint32_t> bucketStart(buckets + 1, 0);
+	{
+		std::uint32_t at = 0;
+		for(std::size_t k=0;k<buckets;k++){
+			bucketStart[k] = at;
+			for(std::size_t b=0;b<blocks.n;b++){ std::uint32_t& c = counts[b * buckets + k]; const std::uint32_t n = c; c = at; at += n; }
+		}
+		bucketStart[buckets] = at;
+	}
+	auto cloud = std::make_shared<PointCloud>();
+	cloud->hasColor = layout.hasColor();
+	const bool byteColors = layout.color[0].type == Type::UInt8 && layout.color[1].type == Type::UInt8 && layout.color[2].type == Type::UInt8 && layout.color[3].type == Type::None;
+	cloud->points.resize(bucketStart[buckets]);
+	runParallel(blocks.n, [&](std::size_t b){
+		std::uint32_t* next = counts.data() + b * buckets;
+		for(std::size_t i=blocks.begin(b);i<blocks.end(b);i++){
+			const Vec3 p = positionOf(i);
+			if(!finite(p)) continue;
+			Point& out = cloud->points[next[bucketOf(p)]++];
+			out.position = p;
+			if(!cloud->hasColor) continue;
+			const uchar* v = base + i * layout.stride;
+			if(byteColors) out.color = std::uint32_t(v[layout.color[0].offset]) | std::uint32_t(v[layout.color[1].offset]) << 8
+			                         | std::uint32_t(v[layout.color[2].offset]) << 16 | 0xFF000000u;
+			else out.color = channel(v, layout.color[0], layout.swap) | channel(v, layout.color[1], layout.swap) << 8
+			               | channel(v, layout.color[2], layout.swap) << 16 | channel(v, layout.color[3], layout.swap) << 24;
+		}
+	});
+	std::vector<std::uint32_t>().swap(counts);
+
+	// Each bucket is split further on its own; cells are then joined in bucket order
+	std::vector<std::vector<Cell>> bucketCells(buckets);
+	runParallel(buckets, [&](std::size_t k){
+		int g[3] = {0, 0, 0};
+		for(int l=0;l<levels;l++) for(int a=0;a<3;a++) g[a] |= int(k >> (3 * l + a) & 1) << l;
+		const float edge = size / grid;
+		const float origin[3] = {lo[0] + g[0] * edge, lo[1] + g[1] * edge, lo[2] + g[2] * edge};
+		split(cloud->points.data(), bucketStart[k], bucketStart[k + 1], origin, edge, levels, bucketCells[k]);
+	});
+	std::size_t cellCount = 0;
+	for(const auto& c : bucketCells) cellCount += c.size();
+	cloud->cells.reserve(cellCount);
+	for(const auto& c : bucketCells) cloud->cells.insert(cloud->cells.end(), c.begin(), c.end());
+
+	auto model = std::make_unique<Model>();
+	model->name = std::filesystem::path(path).stem().string();
+	model->points = std::move(cloud);
+	return model;
+}
+
+}
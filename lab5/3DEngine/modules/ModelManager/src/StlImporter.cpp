@@ -0,0 +1,271 @@
+#include "StlImporter.h"
+#include "ImportSupport.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+namespace StlImporter {
+
+using ImportSupport::runParallel;
+
+namespace {
+constexpr std::uint64_t kHeaderBytes = 84;
+constexpr std::uint64_t kTriangleBytes = 50; // normal, three corners, attribute word
+constexpr std::uint32_t kRoot = 1u << 31; // marks a corner that may own its slot (slots stay below)
+constexpr std::uint32_t kMaxTriangles = 1u << 28;
+
+struct Key {
+	std::uint32_t c[3];
+	bool operator==(const Key& o) const { return c[0]==o.c[0] && c[1]==o.c[1] && c[2]==o.c[2]; }
+};
+
+// Corner i is vertex i%3 of triangle i/3, read straight from the mapping
+class Corners {
+public:
+	Corners(const uchar* triangles, const float lo[3], float cell) : tris(triangles), exact(cell <= 0.f), inv(exact ? 0.f : 1.f / cell) {
+		std::copy(lo, lo + 3, origin);
+	}
+	Vec3 position(std::uint64_t i) const {
+		Vec3 v; std::memcpy(&v, tris + (i / 3) * kTriangleBytes + 12 + (i % 3) * sizeof(Vec3), sizeof(Vec3));
+		return v;
+	}
+	// Grid cell of a position, or its bits (-0 as +0) without a tolerance
+	Key key(const Vec3& v) const {
+		const float p[3] = {v.x, v.y, v.z};
+		Key k;
+		for(int a=0;a<3;a++){
+			if(exact){ const float f = p[a] == 0.f ? 0.f : p[a]; std::memcpy(&k.c[a], &f, 4); }
+			else k.c[a] = static_cast<std::uint32_t>((p[a] - origin[a]) * inv);
+		}
+		return k;
+	}
+	// Per axis, -1 or +1 when the position is within a quarter cell of that border, else 0
+	void nearBorders(const Vec3& v, std::uint32_t step[3]) const {
+		const float p[3] = {v.x, v.y, v.z};
+		for(int a=0;a<3;a++){ const float g = (p[a] - origin[a]) * inv, f = g - std::floor(g); step[a] = f < 0.25f ? ~0u : f > 0.75f ? 1u : 0u; }
+	}
+private:
+	const uchar* tris;
+	bool exact;
+	float inv;
+	float origin[3];
+};
+
+// Open addressing, shared by all threads. A slot is claimed once and then keeps its key;
+// its owner only moves to earlier corners, so it ends as the first corner with that key
+// whatever the interleaving. Owners are stored +1 so zeroed memory is empty.
+class WeldTable {
+public:
+	static constexpr std::uint32_t kNone = ~0u;
+	explicit WeldTable(std::size_t capacity) : mask(capacity - 1), limit(capacity / 4 * 3), slots(capacity) {}
+	std::size_t capacity() const { return mask + 1; }
+	// Slot of the key | kRoot if the corner claimed it or took it over; kNone once the table is too full
+	std::uint32_t insert(const Key& key, std::uint32_t corner){
+		for(std::size_t s = hash(key) & mask;; s = (s + 1) & mask){
+			Slot& slot = slots[s];
+			std::uint32_t o = slot.owner.load(std::memory_order_acquire);
+			if(o == 0){
+				// Counted before claiming, so there are always empty slots to end a probe
+				if(used.fetch_add(1, std::memory_order_relaxed) >= limit) return kNone;
+				if(slot.owner.compare_exchange_strong(o, kBusy, std::memory_order_acquire)){
+					slot.key = key;
+					slot.owner.store(corner + 1, std::memory_order_release);
+					return static_cast<std::uint32_t>(s) | kRoot;
+				}
+			}
+			while(o == kBusy) o = slot.owner.load(std::memory_order_acquire);
+			if(!(slot.key == key)) continue;
+			while(corner + 1 < o) if(slot.owner.compare_exchange_weak(o, corner + 1, std::memory_order_relaxed)) return static_cast<std::uint32_t>(s) | kRoot;
+			return static_cast<std::uint32_t>(s);
+		}
+	}
+	// Only after all inserts have finished
+	std::uint32_t find(const Key& key) const {
+		for(std::size_t s = hash(key) & mask; slots[s].owner.load(std::memory_order_relaxed); s = (s + 1) & mask)
+			if(slots[s].key == key) return static_cast<std::uint32_t>(s);
+		return kNone;
+	}
+	std::uint32_t owner(std::size_t slot) const { return slots[slot].owner.load(std::memory_order_relaxed) - 1; }
+private:
+	static constexpr std::uint32_t kBusy = ~0u;
+	struct Slot {
+		std::atomic<std::uint32_t> owner;
+		Key key;
+	};
+	static std::uint64_t hash(const Key& k){
+		// Grid keys share low bits, so everything is mixed into the low (index) bits
+		std::uint64_t h = (std::uint64_t(k.c[0]) << 32 | k.c[1]) ^ std::uint64_t(k.c[2]) * 0x9E3779B97F4A7C15ull;
+		h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDull;
+		h = (h ^ (h >> 33)) * 0xC4CEB9FE1A85EC53ull;
+		return h ^ (h >> 33);
+	}
+	std::size_t mask, limit;
+	std::atomic<std::size_t> used{0};
+	std::vector<Slot> slots; // one cache line holds four, so a probe is usually one miss
+};
+
+// Splits [0, count) into about 'blocks' contiguous ranges
+struct Blocks {
+	std::size_t count, size, n;
+	Blocks(std::size_t total, std::size_t blocks) : count(total), size(std::max<std::size_t>(1, (total + blocks - 1) / std::max<std::size_t>(1, blocks))), n((total + size - 1) / size) {}
+	std::size_t begin(std::size_t b) const { return b * size; }
+	std::size_t end(std::size_t b) const { return std::min(count, (b + 1) * size); }
+};
+}
+
+std::unique_ptr<Model> load(const std::string& path, float tolerance, std::string* error){
+	auto fail = [&](const std::string& why){ if(error) *error = why; return std::unique_ptr<Model>(); };
+	ImportSupport::MappedFile file;
+	if(!file.open(path)) return fail("cannot read file");
+	std::uint32_t triangleCount = 0;
+	if(file.size >= kHeaderBytes) std::memcpy(&triangleCount, file.data + 80, 4);
+	// Some binary exporters start the header with "solid" too; their sizes add up
+	const std::uint64_t expected = kHeaderBytes + triangleCount * kTriangleBytes;
+	if(file.size >= 5 && std::memcmp(file.data, "solid", 5) == 0 && file.size != expected) return fail("ASCII STL is not supported");
+	if(file.size < kHeaderBytes || file.size < expected) return fail("truncated binary STL");
+	if(triangleCount > kMaxTriangles) return fail("too many triangles");
+	const std::size_t cornerCount = std::size_t(triangleCount) * 3;
+	const uchar* tris = file.data + kHeaderBytes;
+	// Whole triangles per block, so the degenerate check stays inside one
+	const Blocks blocks(triangleCount, ImportSupport::blocksPerPass());
+
+	// Bounds (the weld grid is laid over them) and a finiteness check
+	std::vector<std::array<float,6>> bounds(blocks.n);
+	std::vector<char> finite(blocks.n, 1);
+	const float zero[3] = {0.f, 0.f, 0.f};
+	const Corners raw(tris, zero, 0.f);
+	runParallel(blocks.n, [&](std::size_t b){
+		std::array<float,6> r{HUGE_VALF, HUGE_VALF, HUGE_VALF, -HUGE_VALF, -HUGE_VALF, -HUGE_VALF};
+		for(std::size_t i=blocks.begin(b)*3;i<blocks.end(b)*3;i++){
+			const Vec3 v = raw.position(i);
+			if(!std::isfinite(v.x) || !std::isfinite(v.y) || !std::isfinite(v.z)){ finite[b] = 0; break; }
+			r[0] = std::min(r[0], v.x); r[1] = std::min(r[1], v.y); r[2] = std::min(r[2], v.z);
+			r[3] = std::max(r[3], v.x); r[4] = std::max(r[4], v.y); r[5] = std::max(r[5], v.z);
+		}
+		bounds[b] = r;
+	});
+	if(std::find(finite.begin(), finite.end(), 0) != finite.end()) return fail("non-finite vertex");
+	float lo[3] = {0.f, 0.f, 0.f}, extent = 0.f;
+	if(!bounds.empty()){
+		std::array<float,6> all = bounds[0];
+		for(const auto& r : bounds) for(int a=0;a<3;a++){ all[a] = std::min(all[a], r[a]); all[3+a] = std::max(all[3+a], r[3+a]); }
+		for(int a=0;a<3;a++){ lo[a] = all[a]; extent = std::max(extent, all[3+a] - all[a]); }
+	}
+	// Cells are four tolerances wide; at most 2^22 per axis keeps grid coordinates exact in float
+	const float reach = tolerance > 0.f && extent > 0.f ? extent * std::max(tolerance, 1.f / (1 << 24)) : 0.f;
+	const float cell = 4 * reach;
+	// Shifted by half a cell: round coordinates land mid-cell rather than on borders
+	for(float& l : lo) l -= cell / 2;
+	const Corners corners(tris, lo, cell);
+
+	// Every corner records its slot in what becomes the index buffer. Closed meshes have about
+	// half as many vertices as triangles; a table that fills up is replaced by a larger one
+	Mesh mesh;
+	mesh.indices.resize(cornerCount);
+	std::size_t capacity = 64;
+	while(capacity < triangleCount) capacity <<= 1;
+	std::unique_ptr<WeldTable> table;
+	for(bool full = true; full; capacity <<= 2){
+		table = std::make_unique<WeldTable>(capacity);
+		std::atomic<bool> overflow{false};
+		runParallel(blocks.n, [&](std::size_t b){
+			for(std::size_t i=blocks.begin(b)*3;i<blocks.end(b)*3 && !overflow.load(std::memory_order_relaxed);i++){
+				const std::uint32_t s = table->insert(corners.key(corners.position(i)), static_cast<std::uint32_t>(i));
+				if(s == WeldTable::kNone) overflow = true;
+				mesh.indices[i] = s;
+			}
+		});
+		full = overflow;
+	}
+
+	// A corner that owns its slot becomes a vertex, unless the position lies within tolerance
+	// of a border and a neighbouring cell across it has an earlier owner close enough:
+	// then the whole cell joins that one. Cells being four tolerances wide, most positions
+	// are near no border and need no lookups
+	const std::size_t slotCount = table->capacity();
+	std::vector<std::uint32_t> slotMap(slotCount, 0); // joined cells: target slot | kRoot
+	std::vector<std::uint32_t> blockVertices(blocks.n + 1, 0);
+	runParallel(blocks.n, [&](std::size_t b){
+		std::uint32_t n = 0;
+		for(std::size_t i=blocks.begin(b)*3;i<blocks.end(b)*3;i++){
+			const std::uint32_t s = mesh.indices[i] & ~kRoot;
+			if(!(mesh.indices[i] & kRoot)) continue;
+			if(table->owner(s) != i){ mesh.indices[i] = s; continue; }
+			std::uint32_t best = static_cast<std::uint32_t>(i), target = s;
+			if(cell > 0.f){
+				const Vec3 p = corners.position(i);
+				std::uint32_t step[3];
+				corners.nearBorders(p, step);
+				for(int m=1;m<8;m++){
+					if((m & 1 && !step[0]) || (m & 2 && !step[1]) || (m & 4 && !step[2])) continue;
+					Key near = corners.key(p);
+					for(int a=0;a<3;a++) if(m >> a & 1) near.c[a] += step[a];
+					const std::uint32_t t = table->find(near);
+					if(t == WeldTable::kNone || table->owner(t) >= best) continue;
+					const Vec3 q = corners.position(table->owner(t));
+					if(std::fabs(p.x - q.x) <= reach && std::fabs(p.y - q.y) <= reach && std::fabs(p.z - q.z) <= reach){ best = table->owner(t); target = t; }
+				}
+			}
+			if(target != s) slotMap[s] = target | kRoot;
+			else ++n;
+		}
+		blockVertices[b + 1] = n;
+	});
+	table.reset();
+	// Targets always have earlier owners, so following them ends
+	if(cell > 0.f) for(std::size_t s=0;s<slotCount;s++){
+		if(!(slotMap[s] & kRoot)) continue;
+		std::uint32_t t = slotMap[s] & ~kRoot;
+		while(slotMap[t] & kRoot) t = slotMap[t] & ~kRoot;
+		slotMap[s] = t | kRoot;
+	}
+
+	// Vertex ids in order of first use
+	for(std::size_t b=0;b<blocks.n;b++) blockVertices[b + 1] += blockVertices[b];
+	mesh.vertices.resize(blockVertices[blocks.n]);
+	runParallel(blocks.n, [&](std::size_t b){
+		std::uint32_t id = blockVertices[b];
+		for(std::size_t i=blocks.begin(b)*3;i<blocks.end(b)*3;i++){
+			const std::uint32_t s = mesh.indices[i] & ~kRoot;
+			if(!(mesh.indices[i] & kRoot) || slotMap[s] & kRoot) continue;
+			slotMap[s] = id;
+			mesh.vertices[id++] = corners.position(i);
+		}
+	});
+	const Blocks slotBlocks(slotCount, blocks.n);
+	if(cell > 0.f) runParallel(slotBlocks.n, [&](std::size_t b){
+		for(std::size_t s=slotBlocks.begin(b);s<slotBlocks.end(b);s++) if(slotMap[s] & kRoot) slotMap[s] = slotMap[slotMap[s] & ~kRoot];
+	});
+	// ... and triangles welded down to a line or a point are counted for removal
+	std::vector<std::uint32_t> kept(blocks.n + 1, 0);
+	runParallel(blocks.n, [&](std::size_t b){
+		std::uint32_t n = 0;
+		for(std::size_t t=blocks.begin(b);t<blocks.end(b);t++){
+			unsigned* v = mesh.indices.data() + t * 3;
+			for(int k=0;k<3;k++) v[k] = slotMap[v[k] & ~kRoot];
+			n += v[0] != v[1] && v[1] != v[2] && v[0] != v[2];
+		}
+		kept[b + 1] = n;
+	});
+	std::vector<std::uint32_t>().swap(slotMap);
+	for(std::size_t b=0;b<blocks.n;b++) kept[b + 1] += kept[b];
+	if(kept[blocks.n] != triangleCount){
+		std::size_t at = 0;
+		for(std::size_t t=0;t<triangleCount;t++){
+			const unsigned* v = mesh.indices.data() + t * 3;
+			if(v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) continue;
+			if(at != t * 3) std::memmove(mesh.indices.data() + at, v, 3 * sizeof(unsigned));
+			at += 3;
+		}
+		mesh.indices.resize(at);
+		mesh.indices.shrink_to_fit();
+	}
+
+	auto model = std::make_unique<Model>();
+	model->name = std::filesystem::path(path).stem().string();
+	model->meshes.push_back(std::move(mesh));
+	return model;
+}
+
+}
@@ -7,8 +7,10 @@ INCLUDEPATH += $$PWD/include \
                $$PWD/../../third_party/assimp \
                $$PWD/../../third_party/stb_image
 DEFINES += RENDERMODULE_LIBRARY
-HEADERS += include/Renderer.h
-SOURCES += src/Renderer.cpp
+HEADERS += include/Renderer.h \
+           include/RenderGraph.h
+SOURCES += src/Renderer.cpp \
+           src/RenderGraph.cpp
 # Link against built core output (two levels up to build root)
 CONFIG(debug, debug|release) {
     LIBS += -L$$OUT_PWD/../../core/debug -lCore
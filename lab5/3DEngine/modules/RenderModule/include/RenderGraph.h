@@ -0,0 +1,83 @@
+#ifndef RENDERGRAPH_H
+#define RENDERGRAPH_H
+#include <QOpenGLExtraFunctions>
+#include <functional>
+#include <string>
+#include <vector>
+// Small frame graph: passes declare the attachments they read and write, compile()
+// orders them by those dependencies, culls passes that don't contribute to an imported
+// output, and lets transient textures with non-overlapping lifetimes share memory.
+// Build + compile only when the frame layout changes; execute() every frame.
+class RenderGraph {
+public:
+    using ResourceId = int;
+    enum class Format { RGBA8, Depth24Stencil8 };
+    struct TextureDesc {
+        int width{0}, height{0};
+        Format format{Format::RGBA8};
+        bool operator==(const TextureDesc& o) const { return width==o.width && height==o.height && format==o.format; }
+    };
+    // What a pass sees at execution time; drawFbo is already bound with the viewport set
+    struct PassContext { GLuint drawFbo{0}; GLuint readFbo{0}; int x{0}, y{0}, width{0}, height{0}; };
+    using Execute = std::function<void(const PassContext&)>;
+
+    class PassBuilder {
+    public:
+        void read(ResourceId r);
+        void write(ResourceId r);
+        void sideEffect(); // never culled (e.g. readbacks)
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& g, int p) : graph(g), pass(p) {}
+        RenderGraph& graph;
+        int pass;
+    };
+
+    // Forget declared passes/resources; physical textures are kept for reuse by the next compile
+    void reset();
+    ResourceId createTexture(const std::string& name, const TextureDesc& desc);
+    // External target (widget/thread FBO); x/y/width/height is the viewport passes draw into
+    ResourceId importFramebuffer(const std::string& name, GLuint fbo, int x, int y, int width, int height);
+    // Point an imported target at another FBO of the same size without recompiling
+    void setImportedFramebuffer(ResourceId r, GLuint fbo);
+    void addPass(const std::string& name, const std::function<void(PassBuilder&)>& setup, Execute exec);
+
+    bool compile(QOpenGLExtraFunctions* gl);
+    void execute(QOpenGLExtraFunctions* gl) const;
+    void release(QOpenGLExtraFunctions* gl); // delete all GL objects (context must be current)
+
+    std::string dump() const;
+    size_t transientBytes() const;   // after aliasing
+    size_t unaliasedBytes() const;   // if every transient had its own texture
+private:
+    struct Resource {
+        std::string name;
+        TextureDesc desc;
+        bool imported{false};
+        GLuint importedFbo{0};
+        int x{0}, y{0};
+        std::vector<int> writers, readers;
+        int firstUse{-1}, lastUse{-1}; // positions in 'order'
+        int physical{-1};
+    };
+    struct Pass {
+        std::string name;
+        std::vector<ResourceId> reads, writes;
+        bool sideEffect{false};
+        bool culled{false};
+        Execute exec;
+        GLuint drawFbo{0}, readFbo{0};
+        bool ownsDrawFbo{false};
+        int x{0}, y{0}, width{0}, height{0};
+    };
+    struct Physical { TextureDesc desc; GLuint texture{0}; int busyUntil{-1}; bool used{false}; };
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+    std::vector<int> order;
+    std::vector<Physical> physicals;
+    std::vector<GLuint> ownedFbos;
+    bool compiled{false};
+    static size_t bytesPerPixel(Format) { return 4; } // RGBA8 and D24S8 are both 32-bit
+    GLuint buildFbo(QOpenGLExtraFunctions* gl, const std::vector<ResourceId>& attachments);
+};
+#endif // RENDERGRAPH_H
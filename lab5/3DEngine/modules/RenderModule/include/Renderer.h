@@ -5,46 +5,184 @@
 #include <QOpenGLShaderProgram>
 #include <QOpenGLBuffer>
 #include <QOpenGLVertexArrayObject>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLTimerQuery>
 #include <QMatrix4x4>
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include <unordered_map>
 #include <string>
 #include <QString>
-class Model; class Camera; class Light;
-struct Mesh;
+#include "../../core/include/FrameArena.h"
+#include "../../core/include/Light.h"
+#include "../../core/include/Texture.h"
+#include "RenderGraph.h"
+class Model; class Camera; class FrameStats; class QImage;
+struct Mesh; struct FrameSnapshot; struct PointCloud; class JobSystem;
 class Renderer : public QOpenGLFunctions {
 public:
     Renderer() { }
-    Camera* cam{nullptr};
-    std::vector<Light*> lights;
-    std::vector<Model*> models;
+    ~Renderer();
+    const Camera* cam{nullptr};
     void initialize(){ initializeOpenGLFunctions(); }
+    // Normals, point culling and texture decoding run on 'jobs' instead of this module's own JobSystem::instance()
+    static void shareJobSystem(JobSystem& jobs);
     void renderScene(); 
-    void setCamera(Camera* camera) { cam = camera; }
-    void setLights(const std::vector<Light*>& l) { lights = l; }
-    void addModel(Model* m) { models.push_back(m); }
-    void clearModels() { models.clear(); }
+    void setCamera(const Camera* camera) { cam = camera; }
+    // Applies the snapshot's scene deltas to the retained mirror and takes its camera;
+    // the snapshot must stay alive until renderScene returns
+    void setSnapshot(const FrameSnapshot& snap);
+    // Last scene version folded into the retained mirror
+    std::uint64_t retainedVersion() const { return mirrorVersion; }
     void setViewportSize(int w, int h){ viewportW = (w>0?w:1); viewportH = (h>0?h:1); }
     void clearTextures();
+    // Hot reload: the cached texture for 'path' (if it was ever used) is replaced by 'image';
+    // the old one stays if the image can't be used
+    void replaceTexture(const std::string& path, const QImage& image);
+    // Dynamic resolution: models are drawn into a scaled transient target, then upscaled
+    void setDynamicResolution(bool on);
+    bool dynamicResolution() const { return dynResEnabled; }
+    void setTargetFrameTime(float ms){ targetFrameMs = (ms>1.f?ms:1.f); }
+    float targetFrameTime() const { return targetFrameMs; }
+    float resolutionScale() const { return dynResEnabled ? resScale : 1.f; }
+    float lastSceneGpuTime() const { return gpuSceneMs; }
+    // Framebuffer the final image goes to (nullptr = context default, e.g. the widget FBO)
+    void setTargetFramebuffer(QOpenGLFramebufferObject* fbo){ targetFbo = fbo; }
+    // Optional sink for per-frame events (texture uploads, buffer growth)
+    void setFrameStats(FrameStats* s){ stats = s; }
+    const FrameArena& arena() const { return frameArena; }
+    // Bumped whenever a texture or render target is created or dropped
+    unsigned resourceChanges() const { return resourceEpoch; }
+    // Text dump of the compiled frame graph (passes, lifetimes, memory)
+    std::string renderGraphDump() const { return renderGraph.dump(); }
+    // Bumped whenever the graph is rebuilt, so a cached dump can be refreshed
+    unsigned graphBuilds() const { return graphBuildCount; }
+    // Points drawn per frame across all clouds; over budget, distant cells draw a subsample
+    void setPointBudget(std::size_t points){ pointBudget = points > 0 ? points : 1; }
+    std::size_t pointBudgetLimit() const { return pointBudget; }
+    std::size_t lastPointsDrawn() const { return pointsDrawn; }
+    // Out-of-core meshes: GPU bytes they may occupy; the least recently visible are evicted beyond it
+    void setGeometryBudget(std::size_t bytes){ geometryBudget = bytes; }
+    std::size_t geometryBudgetLimit() const { return geometryBudget; }
+    std::size_t residentGeometryBytes() const { return geometryBytes; }
 private:
     bool glReady{false};
     QOpenGLShaderProgram program;
     QOpenGLVertexArrayObject vao;
     QOpenGLBuffer vboTriangle{QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer streamPoints{QOpenGLBuffer::VertexBuffer};
+    // Per-frame temporaries (light arrays, normals, UVs, packed positions); reset after each frame
+    FrameArena frameArena;
+    // Retained mirror of the scene, kept in sync from journal deltas.
+    // GPU buffers are cached per mesh and only rebuilt when its geometry is edited.
+    struct MeshGpu {
+        QOpenGLBuffer pos{QOpenGLBuffer::VertexBuffer};
+        QOpenGLBuffer nrm{QOpenGLBuffer::VertexBuffer};
+        QOpenGLBuffer uv{QOpenGLBuffer::VertexBuffer};
+        QOpenGLBuffer idx{QOpenGLBuffer::IndexBuffer};
+        int indexCount{0};
+        std::size_t bytes{0}; // counted against the geometry budget
+    };
+    // Point clouds stay GPU-resident as runs of consecutive octree cells, one buffer per run
+    struct PointChunkGpu {
+        QOpenGLBuffer vbo{QOpenGLBuffer::VertexBuffer};
+        std::uint32_t firstCell{0}, cellCount{0}, firstPoint{0}, pointCount{0};
+        bool uploaded{false};
+    };
+    struct RetainedModel {
+        std::uint32_t id{0};
+        std::shared_ptr<const Model> model;
+        Texture texture;
+        QMatrix4x4 transform;
+        std::vector<std::unique_ptr<MeshGpu>> gpu; // empty until first drawn
+        std::vector<std::unique_ptr<PointChunkGpu>> pointChunks; // likewise; uploaded over several frames
+        float boundsMin[3]{}, boundsMax[3]{}; // model space, from modelBounds()
+        bool hasBounds{false};
+        std::uint64_t lastVisible{0}; // frame number, for eviction
+    };
+    struct RetainedLight { std::uint32_t id{0}; Light light; };
+    std::vector<RetainedModel> retained;
+    std::vector<RetainedLight> retainedLights;
+    std::vector<const Light*> lights; // points into retainedLights
+    std::uint64_t mirrorVersion{0};
+    RetainedModel* findRetained(std::uint32_t id);
+    unsigned resourceEpoch{0};
     int viewportW{1}, viewportH{1};
+    // Point clouds
+    static constexpr std::uint32_t kChunkPoints = 1u << 22;        // points per buffer
+    static constexpr std::size_t kUploadPointsPerFrame = 1u << 23; // streaming limit for new clouds
+    std::size_t pointBudget{10000000};
+    // Mesh paging
+    static constexpr std::size_t kUploadBytesPerFrame = 64u << 20;
+    std::size_t geometryBudget{std::size_t(1) << 30};
+    std::size_t geometryBytes{0};
+    std::uint64_t frameNumber{0};
+    std::size_t pointsDrawn{0};
+    float framePxPerUnit{1.f}; // pixels per unit at w = 1 in the scene target
+    FrameStats* stats{nullptr};
+    void markEvent(unsigned e);
+    // Dynamic resolution state
+    bool dynResEnabled{false};
+    float targetFrameMs{33.3f};
+    float resScale{1.f};
+    float gpuSceneMs{0.f};
+    static constexpr float kMinResScale = 0.4f;
+    static constexpr float kMaxResScale = 1.f;
+    static constexpr int kTimerQueries = 3; // results are read back a few frames late to avoid stalls
+    QOpenGLFramebufferObject* targetFbo{nullptr};
+    QOpenGLTimerQuery gpuTimers[kTimerQueries];
+    bool gpuTimerPending[kTimerQueries]{};
+    int gpuTimerFrame{0};
+    bool gpuTimersReady{false};
+    bool gpuSampleFresh{false};
     // Simple texture cache by file path
     std::unordered_map<std::string, unsigned int> textureCache;
+    bool texturesPending{false}; // models may reference files not in the cache yet
     bool bindTextureIfAvailable(const std::string& path);
     unsigned int createTextureFromImage(const QString& qpath);
+    unsigned int createTexture(const QImage& img);
+    unsigned int uploadTexture(const QImage& rgba);
+    void loadPendingTextures();
     void ensureGL();
     void drawTriangle();
-    void drawPoints(const std::vector<float>& data, GLenum primitive, int count, const QVector4D& color = QVector4D(1,1,1,1));
-    void drawMeshTriangles(const Mesh& mesh,
-                           const Model* modelRef,
+    void drawModels(const QMatrix4x4& mvp);
+    void drawPointClouds(const QMatrix4x4& mvp);
+    void updateBounds(RetainedModel& rm);
+    void evict(RetainedModel& rm);
+    bool makeRoom(std::size_t bytes);
+    void drawBoundsProxy(const RetainedModel& rm, const QMatrix4x4& mvp);
+    void uploadPointChunks(const PointCloud& cloud, RetainedModel& rm, std::size_t& uploadBudget);
+    void drawOverlay(const QMatrix4x4& mvp);
+    // Frame graph: Scene -> (Upscale) -> Overlay. Rebuilt only when its layout changes.
+    RenderGraph renderGraph;
+    struct GraphLayout {
+        bool scaled{false};
+        int sceneW{0}, sceneH{0};
+        int x{0}, y{0}, w{0}, h{0};
+        bool operator==(const GraphLayout& o) const {
+            return scaled==o.scaled && sceneW==o.sceneW && sceneH==o.sceneH && x==o.x && y==o.y && w==o.w && h==o.h;
+        }
+    };
+    GraphLayout graphLayout;
+    bool graphValid{false};
+    // The target FBO isn't part of the layout: the render thread cycles through several,
+    // so it is re-bound every frame instead of rebuilding the graph
+    RenderGraph::ResourceId graphBackbuffer{0};
+    unsigned graphBuildCount{0};
+    QMatrix4x4 frameMvp; // read by the pass callbacks
+    bool buildRenderGraph(const GraphLayout& layout);
+    void beginGpuTimer();
+    void endGpuTimer();
+    void updateResolutionScale();
+    void drawPoints(const float* data, int floatCount, GLenum primitive, int count, const QVector4D& color = QVector4D(1,1,1,1));
+    void uploadMesh(const Mesh& mesh, MeshGpu& gpu);
+    void drawMeshTriangles(MeshGpu& gpu,
+                           const Texture* texture,
                            const QMatrix4x4& modelMat,
                            const QMatrix4x4& mvp,
-                           const std::vector<QVector3D>& lpos,
-                           const std::vector<QVector3D>& lcol,
-                           const std::vector<float>& lint);
+                           const FrameVector<QVector3D>& lpos,
+                           const FrameVector<QVector3D>& lcol,
+                           const FrameVector<float>& lint);
 };
 #endif // RENDERER_H
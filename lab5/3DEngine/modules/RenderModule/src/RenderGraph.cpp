@@ -0,0 +1,238 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <sstream>
+
+void RenderGraph::PassBuilder::read(ResourceId r){
+	if(r < 0 || r >= static_cast<int>(graph.resources.size())) return;
+	graph.passes[pass].reads.push_back(r);
+	graph.resources[r].readers.push_back(pass);
+}
+
+void RenderGraph::PassBuilder::write(ResourceId r){
+	if(r < 0 || r >= static_cast<int>(graph.resources.size())) return;
+	graph.passes[pass].writes.push_back(r);
+	graph.resources[r].writers.push_back(pass);
+}
+
+void RenderGraph::PassBuilder::sideEffect(){ graph.passes[pass].sideEffect = true; }
+
+void RenderGraph::reset(){
+	resources.clear(); passes.clear(); order.clear();
+	compiled = false;
+}
+
+RenderGraph::ResourceId RenderGraph::createTexture(const std::string& name, const TextureDesc& desc){
+	Resource r; r.name = name; r.desc = desc;
+	resources.push_back(std::move(r));
+	return static_cast<ResourceId>(resources.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::importFramebuffer(const std::string& name, GLuint fbo, int x, int y, int width, int height){
+	Resource r; r.name = name; r.imported = true; r.importedFbo = fbo;
+	r.x = x; r.y = y;
+	r.desc.width = width; r.desc.height = height;
+	resources.push_back(std::move(r));
+	return static_cast<ResourceId>(resources.size() - 1);
+}
+
+void RenderGraph::setImportedFramebuffer(ResourceId id, GLuint fbo){
+	Resource& r = resources[id];
+	if(!r.imported || r.importedFbo == fbo) return;
+	for(int p : r.writers) if(passes[p].drawFbo == r.importedFbo) passes[p].drawFbo = fbo;
+	r.importedFbo = fbo;
+}
+
+void RenderGraph::addPass(const std::string& name, const std::function<void(PassBuilder&)>& setup, Execute exec){
+	Pass p; p.name = name; p.exec = std::move(exec);
+	passes.push_back(std::move(p));
+	PassBuilder b(*this, static_cast<int>(passes.size() - 1));
+	if(setup) setup(b);
+}
+
+GLuint RenderGraph::buildFbo(QOpenGLExtraFunctions* gl, const std::vector<ResourceId>& attachments){
+	GLuint fbo = 0;
+	gl->glGenFramebuffers(1, &fbo);
+	gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	for(ResourceId id : attachments){
+		const Resource& r = resources[id];
+		const GLuint tex = physicals[r.physical].texture;
+		const GLenum point = r.desc.format == Format::Depth24Stencil8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_COLOR_ATTACHMENT0;
+		gl->glFramebufferTexture2D(GL_FRAMEBUFFER, point, GL_TEXTURE_2D, tex, 0);
+	}
+	ownedFbos.push_back(fbo);
+	return fbo;
+}
+
+bool RenderGraph::compile(QOpenGLExtraFunctions* gl){
+	compiled = false;
+	order.clear();
+	for(auto& fbo : ownedFbos) gl->glDeleteFramebuffers(1, &fbo);
+	ownedFbos.clear();
+
+	// 1. Cull: grow the needed set back from imported outputs until it stops changing
+	// (one backwards sweep suffices when passes are declared in order)
+	std::vector<char> needed(resources.size(), 0);
+	for(size_t i=0;i<resources.size();i++) if(resources[i].imported) needed[i] = 1;
+	for(auto& pass : passes) pass.culled = true;
+	for(bool changed = true; changed; ){
+		changed = false;
+		for(int p=static_cast<int>(passes.size())-1; p>=0; --p){
+			Pass& pass = passes[p];
+			if(!pass.culled) continue;
+			bool alive = pass.sideEffect;
+			for(ResourceId w : pass.writes) alive = alive || needed[w];
+			if(!alive) continue;
+			pass.culled = false; changed = true;
+			for(ResourceId r : pass.reads) needed[r] = 1;
+		}
+	}
+
+	// 2. Order: writers before readers, writers of the same resource in declaration order
+	const int n = static_cast<int>(passes.size());
+	std::vector<std::vector<int>> edges(n);
+	std::vector<int> indegree(n, 0);
+	auto addEdge = [&](int a, int b){ if(a==b || passes[a].culled || passes[b].culled) return; edges[a].push_back(b); ++indegree[b]; };
+	for(const Resource& r : resources){
+		for(size_t i=1;i<r.writers.size();i++) addEdge(r.writers[i-1], r.writers[i]);
+		for(int w : r.writers) for(int rd : r.readers) addEdge(w, rd);
+	}
+	std::vector<int> ready;
+	for(int p=0;p<n;p++) if(!passes[p].culled && indegree[p]==0) ready.push_back(p);
+	while(!ready.empty()){
+		// Lowest declaration index first keeps the order stable and predictable
+		auto it = std::min_element(ready.begin(), ready.end());
+		const int p = *it; ready.erase(it);
+		order.push_back(p);
+		for(int q : edges[p]) if(--indegree[q]==0) ready.push_back(q);
+	}
+	int alive = 0;
+	for(const Pass& p : passes) if(!p.culled) ++alive;
+	if(static_cast<int>(order.size()) != alive) return false; // dependency cycle
+
+	// 3. Lifetimes of transient resources over the compiled order
+	for(auto& r : resources){ r.firstUse = r.lastUse = -1; r.physical = -1; }
+	for(int i=0;i<static_cast<int>(order.size());i++){
+		const Pass& p = passes[order[i]];
+		auto touch = [&](ResourceId id){ Resource& r = resources[id]; if(r.firstUse<0) r.firstUse = i; r.lastUse = i; };
+		for(ResourceId id : p.reads) touch(id);
+		for(ResourceId id : p.writes) touch(id);
+	}
+
+	// 4. Aliasing: a transient reuses a physical texture of the same shape whose last user already ran
+	for(auto& ph : physicals){ ph.busyUntil = -1; ph.used = false; }
+	std::vector<int> transients;
+	for(int i=0;i<static_cast<int>(resources.size());i++) if(!resources[i].imported && resources[i].firstUse >= 0) transients.push_back(i);
+	std::sort(transients.begin(), transients.end(), [&](int a, int b){ return resources[a].firstUse < resources[b].firstUse; });
+	for(int id : transients){
+		Resource& r = resources[id];
+		for(int k=0;k<static_cast<int>(physicals.size());k++){
+			Physical& ph = physicals[k];
+			if(ph.desc == r.desc && (!ph.used || ph.busyUntil < r.firstUse)){ r.physical = k; break; }
+		}
+		if(r.physical < 0){ physicals.push_back({r.desc, 0, -1, false}); r.physical = static_cast<int>(physicals.size()) - 1; }
+		Physical& ph = physicals[r.physical];
+		ph.busyUntil = r.lastUse; ph.used = true;
+	}
+	// Drop textures nobody maps to any more, create the missing ones
+	for(size_t k=0;k<physicals.size();){
+		if(!physicals[k].used){
+			if(physicals[k].texture) gl->glDeleteTextures(1, &physicals[k].texture);
+			physicals.erase(physicals.begin() + static_cast<std::ptrdiff_t>(k));
+			for(auto& r : resources) if(r.physical > static_cast<int>(k)) --r.physical;
+			continue;
+		}
+		Physical& ph = physicals[k];
+		if(!ph.texture){
+			gl->glGenTextures(1, &ph.texture);
+			gl->glBindTexture(GL_TEXTURE_2D, ph.texture);
+			gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			if(ph.desc.format == Format::Depth24Stencil8)
+				gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, ph.desc.width, ph.desc.height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+			else
+				gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, ph.desc.width, ph.desc.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			gl->glBindTexture(GL_TEXTURE_2D, 0);
+		}
+		++k;
+	}
+
+	// 5. Framebuffers: a pass draws into an imported target or into its transient writes
+	for(int p : order){
+		Pass& pass = passes[p];
+		pass.drawFbo = pass.readFbo = 0; pass.x = pass.y = pass.width = pass.height = 0;
+		std::vector<ResourceId> transientWrites, transientReads;
+		for(ResourceId id : pass.writes){
+			const Resource& r = resources[id];
+			if(r.imported) pass.drawFbo = r.importedFbo; else transientWrites.push_back(id);
+			if(!pass.width){ pass.x = r.x; pass.y = r.y; pass.width = r.desc.width; pass.height = r.desc.height; }
+		}
+		if(!transientWrites.empty()){
+			if(pass.drawFbo) return false; // can't mix an imported target with transient attachments
+			pass.drawFbo = buildFbo(gl, transientWrites);
+			if(gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) return false;
+		}
+		for(ResourceId id : pass.reads) if(!resources[id].imported) transientReads.push_back(id);
+		if(!transientReads.empty()) pass.readFbo = buildFbo(gl, transientReads);
+	}
+	gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	compiled = true;
+	return true;
+}
+
+void RenderGraph::execute(QOpenGLExtraFunctions* gl) const{
+	if(!compiled) return;
+	for(int p : order){
+		const Pass& pass = passes[p];
+		gl->glBindFramebuffer(GL_FRAMEBUFFER, pass.drawFbo);
+		if(pass.width > 0) gl->glViewport(pass.x, pass.y, pass.width, pass.height);
+		if(pass.exec) pass.exec({pass.drawFbo, pass.readFbo, pass.x, pass.y, pass.width, pass.height});
+	}
+}
+
+void RenderGraph::release(QOpenGLExtraFunctions* gl){
+	for(auto& fbo : ownedFbos) gl->glDeleteFramebuffers(1, &fbo);
+	ownedFbos.clear();
+	for(auto& ph : physicals) if(ph.texture) gl->glDeleteTextures(1, &ph.texture);
+	physicals.clear();
+	reset();
+}
+
+size_t RenderGraph::transientBytes() const{
+	size_t total = 0;
+	for(const auto& ph : physicals) total += size_t(ph.desc.width) * size_t(ph.desc.height) * bytesPerPixel(ph.desc.format);
+	return total;
+}
+
+size_t RenderGraph::unaliasedBytes() const{
+	size_t total = 0;
+	for(const auto& r : resources) if(!r.imported && r.firstUse >= 0) total += size_t(r.desc.width) * size_t(r.desc.height) * bytesPerPixel(r.desc.format);
+	return total;
+}
+
+std::string RenderGraph::dump() const{
+	std::ostringstream out;
+	auto fmt = [](Format f){ return f == Format::RGBA8 ? "RGBA8" : "D24S8"; };
+	out << "RenderGraph: " << order.size() << " of " << passes.size() << " passes"
+		<< (compiled ? "" : " (not compiled)") << "\n";
+	for(size_t i=0;i<order.size();i++){
+		const Pass& p = passes[order[i]];
+		out << "  " << i << ". " << p.name << "  reads[";
+		for(size_t k=0;k<p.reads.size();k++) out << (k?", ":"") << resources[p.reads[k]].name;
+		out << "] writes[";
+		for(size_t k=0;k<p.writes.size();k++) out << (k?", ":"") << resources[p.writes[k]].name;
+		out << "] " << p.width << "x" << p.height << "\n";
+	}
+	for(const Pass& p : passes) if(p.culled) out << "  culled: " << p.name << "\n";
+	out << "Resources:\n";
+	for(const Resource& r : resources){
+		out << "  " << r.name << "  ";
+		if(r.imported){ out << "imported fbo " << r.importedFbo << "\n"; continue; }
+		out << r.desc.width << "x" << r.desc.height << " " << fmt(r.desc.format);
+		if(r.firstUse < 0){ out << "  unused\n"; continue; }
+		out << "  life [" << r.firstUse << ".." << r.lastUse << "]  -> texture #" << r.physical << "\n";
+	}
+	out << "Transient memory: " << transientBytes()/1024 << " KiB (" << unaliasedBytes()/1024 << " KiB without aliasing)\n";
+	return out.str();
+}
@@ -3,14 +3,22 @@
 #include "../../core/include/Camera.h"
 #include "../../core/include/Light.h"
 #include "../../core/include/Mesh.h"
+#include "../../core/include/PointCloud.h"
 #include "../../core/include/Vec3.h"
+#include "../../core/include/FrameStats.h"
+#include "../../core/include/FrameSnapshot.h"
+#include "../../core/include/SceneIndex.h"
+#include "../../core/include/JobSystem.h"
 #include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLContext>
 #include <QImage>
 #include <QFileInfo>
 #include <limits>
 #include <QVector3D>
 #include <QVector4D>
 #include <QtMath>
+#include <cmath>
 #include <algorithm>
 
 static const char* kVS = R"(
@@ -18,22 +26,26 @@ static const char* kVS = R"(
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aUV;
+layout(location = 3) in vec4 aColor;
 uniform bool uUseAttrNormal;
 uniform float uPointSize;
+uniform float uSplatScale; // point clouds: splat size in pixels at w = 1 (0 = use uPointSize)
 uniform mat4 uMVP;
 uniform mat4 uModel;
 uniform vec3 uNormal; // model-space or world-space normal if uModel is identity
 out vec3 vWorldPos;
 out vec3 vNormal;
 out vec2 vUV;
+out vec4 vColor;
 void main(){
 	vec4 worldPos = uModel * vec4(aPos, 1.0);
 	vWorldPos = worldPos.xyz;
 	vec3 N = uUseAttrNormal ? aNormal : uNormal;
 	vNormal = normalize(N);
 	vUV = aUV;
+	vColor = aColor;
 	gl_Position = uMVP * vec4(aPos, 1.0);
-	gl_PointSize = uPointSize;
+	gl_PointSize = uSplatScale > 0.0 ? clamp(uSplatScale / gl_Position.w, 1.0, 32.0) : uPointSize;
 }
 )";
 
@@ -47,16 +59,18 @@ uniform vec3 uLightColor[16];   // 0..1
 uniform float uLightIntensity[16];
 uniform float uAmbient;     // 0..1
 uniform bool uUseTex;
+uniform bool uUseAttrColor;
 uniform sampler2D uDiffuseTex;
 in vec3 vWorldPos;
 in vec3 vNormal;
 in vec2 vUV;
+in vec4 vColor;
 void main(){
 	// Minimal Lambert lighting with multiple lights
 	vec3 N = normalize(vNormal);
 	// Two-sided lighting: flip normal for back faces
 	if(!gl_FrontFacing) N = -N;
-	vec3 base = uColor.rgb;
+	vec3 base = uUseAttrColor ? vColor.rgb : uColor.rgb;
 	if(uUseTex){ base *= texture(uDiffuseTex, vUV).rgb; }
 	vec3 lit = base * uAmbient;
 	for(int i=0;i<uLightCount;i++){
@@ -68,6 +82,40 @@ void main(){
 }
 )";
 
+namespace {
+// Planes bounding what 'clip' maps into view, in the space it maps from
+void frustumPlanes(const QMatrix4x4& clip, QVector4D planes[6]){
+	const QVector4D r3 = clip.row(3);
+	for(int a=0;a<3;a++){ planes[2*a] = r3 + clip.row(a); planes[2*a+1] = r3 - clip.row(a); }
+}
+// False if the box is entirely behind one of the planes
+bool boxVisible(const QVector4D planes[6], const float lo[3], const float hi[3]){
+	for(int i=0;i<6;i++){
+		const QVector4D& p = planes[i];
+		// Farthest box corner along the plane normal
+		const float d = p.x()*(p.x()>0?hi[0]:lo[0]) + p.y()*(p.y()>0?hi[1]:lo[1]) + p.z()*(p.z()>0?hi[2]:lo[2]) + p.w();
+		if(d < 0.f) return false;
+	}
+	return true;
+}
+float boxDiagonal(const float lo[3], const float hi[3]){
+	const float dx = hi[0]-lo[0], dy = hi[1]-lo[1], dz = hi[2]-lo[2];
+	return std::sqrt(dx*dx + dy*dy + dz*dz);
+}
+// Clip w of the box centre, clamped to the near plane for boxes around the camera
+float centreW(const QVector4D& r3, const float lo[3], const float hi[3]){
+	return std::max(0.1f, r3.x()*(lo[0]+hi[0])*0.5f + r3.y()*(lo[1]+hi[1])*0.5f + r3.z()*(lo[2]+hi[2])*0.5f + r3.w());
+}
+// Largest axis scale of a model matrix, for sizes in world units
+float axisScale(const QMatrix4x4& m){
+	float scale = 0.f;
+	for(int a=0;a<3;a++) scale = std::max(scale, m.column(a).toVector3D().length());
+	return scale;
+}
+// What uploadMesh puts on the GPU: positions, normals, UVs and indices
+std::size_t meshBytes(const Mesh& mesh){ return mesh.vertexCount() * (2*sizeof(Vec3) + 2*sizeof(float)) + mesh.indexCount() * sizeof(unsigned); }
+}
+
 void Renderer::ensureGL(){
 	if(glReady) return;
 	this->glEnable(GL_DEPTH_TEST);
@@ -75,8 +123,9 @@ void Renderer::ensureGL(){
 	// this->glEnable(GL_CULL_FACE); // Disabled to render both faces
 
 	program.create();
-	program.addShaderFromSourceCode(QOpenGLShader::Vertex,   kVS);
-	program.addShaderFromSourceCode(QOpenGLShader::Fragment, kFS);
+	// Cacheable: Qt keeps the linked program binary on disk, so later starts skip the compile
+	program.addCacheableShaderFromSourceCode(QOpenGLShader::Vertex,   kVS);
+	program.addCacheableShaderFromSourceCode(QOpenGLShader::Fragment, kFS);
 	program.link();
 
 	vao.create();
@@ -91,6 +140,10 @@ void Renderer::ensureGL(){
 	};
 	vboTriangle.allocate(verts, sizeof(verts));
 
+	// Gizmo buffer is created once and re-filled per draw, so drawing allocates no GL wrappers
+	streamPoints.create();
+	streamPoints.setUsagePattern(QOpenGLBuffer::StreamDraw);
+
 	program.bind();
 	this->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), reinterpret_cast<void*>(0));
 	this->glEnableVertexAttribArray(0);
@@ -99,6 +152,10 @@ void Renderer::ensureGL(){
 	vao.release();
 	program.release();
 
+	// GPU timer queries drive dynamic resolution (not available on GLES 2)
+	gpuTimersReady = true;
+	for(auto& q : gpuTimers) gpuTimersReady = q.create() && gpuTimersReady;
+
 	glReady = true;
 }
 
@@ -115,78 +172,99 @@ void Renderer::drawTriangle(){
 	vao.release();
 }
 
-void Renderer::drawMeshTriangles(const Mesh& mesh,
-								 const Model* modelRef,
-								 const QMatrix4x4& modelMat,
-								 const QMatrix4x4& mvp,
-								 const std::vector<QVector3D>& lpos,
-								 const std::vector<QVector3D>& lcol,
-								 const std::vector<float>& lint){
-	if(mesh.indices.size() < 3 || mesh.vertices.size() < 3) return;
-	// Compute per-vertex normals (averaged face normals)
-	std::vector<QVector3D> normals(mesh.vertices.size(), QVector3D(0,0,0));
-	for(size_t i=0; i+2 < mesh.indices.size(); i += 3){
-		unsigned ia = mesh.indices[i];
-		unsigned ib = mesh.indices[i+1];
-		unsigned ic = mesh.indices[i+2];
-		if(ia>=mesh.vertices.size() || ib>=mesh.vertices.size() || ic>=mesh.vertices.size()) continue;
-		const Vec3& a = mesh.vertices[ia];
-		const Vec3& b = mesh.vertices[ib];
-		const Vec3& c = mesh.vertices[ic];
+void Renderer::uploadMesh(const Mesh& mesh, MeshGpu& gpu){
+	gpu.indexCount = 0;
+	// Views into a mapped .sceneb are read in place; first touch here is what pages them in
+	const Vec3* verts = mesh.vertexData(); const std::size_t vcount = mesh.vertexCount();
+	const unsigned* indices = mesh.indexData(); const std::size_t icount = mesh.indexCount();
+	if(icount < 3 || vcount < 3) return;
+	ArenaAllocator<float> fa(frameArena);
+	JobSystem& jobs = JobSystem::instance();
+	// Compute per-vertex normals (averaged face normals): face normals on all cores, summed
+	// per vertex here, as triangles share vertices
+	const std::size_t tcount = icount / 3;
+	FrameVector<QVector3D> faces(tcount, QVector3D(0,0,0), ArenaAllocator<QVector3D>(frameArena));
+	jobs.parallelFor(tcount, [&](std::size_t t){
+		const unsigned ia = indices[3*t], ib = indices[3*t+1], ic = indices[3*t+2];
+		if(ia>=vcount || ib>=vcount || ic>=vcount) return;
+		const Vec3& a = verts[ia];
+		const Vec3& b = verts[ib];
+		const Vec3& c = verts[ic];
 		QVector3D va(a.x, a.y, a.z);
 		QVector3D vb(b.x, b.y, b.z);
 		QVector3D vc(c.x, c.y, c.z);
-		QVector3D n = QVector3D::crossProduct(vb - va, vc - va).normalized();
-		normals[ia] += n; normals[ib] += n; normals[ic] += n;
+		faces[t] = QVector3D::crossProduct(vb - va, vc - va).normalized();
+	}, 16384);
+	FrameVector<QVector3D> normals(vcount, QVector3D(0,0,0), ArenaAllocator<QVector3D>(frameArena));
+	for(size_t t=0; t<tcount; t++){
+		const unsigned ia = indices[3*t], ib = indices[3*t+1], ic = indices[3*t+2];
+		if(ia>=vcount || ib>=vcount || ic>=vcount) continue;
+		normals[ia] += faces[t]; normals[ib] += faces[t]; normals[ic] += faces[t];
 	}
-	for(auto& n : normals){ if(n.lengthSquared() > 0) n.normalize(); }
 
 	// Generate simple planar UVs from XY bbox as fallback
 	float minX=std::numeric_limits<float>::max(), minY=std::numeric_limits<float>::max();
 	float maxX=-std::numeric_limits<float>::max(), maxY=-std::numeric_limits<float>::max();
-	for(const auto& v : mesh.vertices){
-		minX = std::min(minX, v.x); maxX = std::max(maxX, v.x);
-		minY = std::min(minY, v.y); maxY = std::max(maxY, v.y);
+	for(const Vec3* v = verts; v != verts + vcount; ++v){
+		minX = std::min(minX, v->x); maxX = std::max(maxX, v->x);
+		minY = std::min(minY, v->y); maxY = std::max(maxY, v->y);
 	}
 	float rx = std::max(1e-6f, maxX - minX);
 	float ry = std::max(1e-6f, maxY - minY);
-	std::vector<float> uv; uv.reserve(mesh.vertices.size()*2);
-	for(const auto& v : mesh.vertices){
-		float u = (v.x - minX)/rx;
-		float vv = (v.y - minY)/ry;
-		uv.push_back(u);
-		uv.push_back(vv);
-	}
+	FrameVector<float> uv(vcount*2, 0.f, fa);
+	FrameVector<float> nbuf(vcount*3, 0.f, fa);
+	jobs.parallelFor(vcount, [&](std::size_t i){
+		uv[2*i] = (verts[i].x - minX)/rx;
+		uv[2*i+1] = (verts[i].y - minY)/ry;
+		QVector3D n = normals[i];
+		if(n.lengthSquared() > 0) n.normalize();
+		nbuf[3*i] = n.x(); nbuf[3*i+1] = n.y(); nbuf[3*i+2] = n.z();
+	}, 16384);
 
-	// Upload data
+	// Vec3 is three packed floats, so positions go up as-is
+	gpu.pos.create(); gpu.pos.bind();
+	gpu.pos.allocate(verts, static_cast<int>(vcount*sizeof(Vec3)));
+	gpu.nrm.create(); gpu.nrm.bind();
+	gpu.nrm.allocate(nbuf.data(), static_cast<int>(nbuf.size()*sizeof(float)));
+	gpu.uv.create(); gpu.uv.bind();
+	gpu.uv.allocate(uv.data(), static_cast<int>(uv.size()*sizeof(float)));
+	gpu.uv.release();
+	gpu.idx.create(); gpu.idx.bind();
+	gpu.idx.allocate(indices, static_cast<int>(icount*sizeof(unsigned)));
+	gpu.idx.release();
+	gpu.indexCount = static_cast<int>(icount);
+	gpu.bytes = meshBytes(mesh);
+	// The GPU copy is what gets drawn; a mapped view's pages can go until it is evicted
+	mesh.releasePages();
+	markEvent(FrameStats::BufferGrowth);
+	++resourceEpoch;
+}
+
+void Renderer::drawMeshTriangles(MeshGpu& gpu,
+								 const Texture* texture,
+								 const QMatrix4x4& modelMat,
+								 const QMatrix4x4& mvp,
+								 const FrameVector<QVector3D>& lpos,
+								 const FrameVector<QVector3D>& lcol,
+								 const FrameVector<float>& lint){
+	if(gpu.indexCount < 3) return;
 	vao.bind();
-	QOpenGLBuffer vboPos(QOpenGLBuffer::VertexBuffer); vboPos.create(); vboPos.bind();
-	std::vector<float> pos; pos.reserve(mesh.vertices.size()*3);
-	for(const auto& v : mesh.vertices){ pos.push_back(v.x); pos.push_back(v.y); pos.push_back(v.z); }
-	vboPos.allocate(pos.data(), static_cast<int>(pos.size()*sizeof(float)));
+	gpu.pos.bind();
 	this->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), reinterpret_cast<void*>(0));
 	this->glEnableVertexAttribArray(0);
-
-	QOpenGLBuffer vboNrm(QOpenGLBuffer::VertexBuffer); vboNrm.create(); vboNrm.bind();
-	std::vector<float> nbuf; nbuf.reserve(normals.size()*3);
-	for(const auto& n : normals){ nbuf.push_back(n.x()); nbuf.push_back(n.y()); nbuf.push_back(n.z()); }
-	vboNrm.allocate(nbuf.data(), static_cast<int>(nbuf.size()*sizeof(float)));
+	gpu.nrm.bind();
 	this->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), reinterpret_cast<void*>(0));
 	this->glEnableVertexAttribArray(1);
-
-	QOpenGLBuffer vboUV(QOpenGLBuffer::VertexBuffer); vboUV.create(); vboUV.bind();
-	vboUV.allocate(uv.data(), static_cast<int>(uv.size()*sizeof(float)));
+	gpu.uv.bind();
 	this->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), reinterpret_cast<void*>(0));
 	this->glEnableVertexAttribArray(2);
-
-	QOpenGLBuffer ebo(QOpenGLBuffer::IndexBuffer); ebo.create(); ebo.bind();
-	ebo.allocate(mesh.indices.data(), static_cast<int>(mesh.indices.size()*sizeof(unsigned)));
+	gpu.idx.bind();
 
 	// Set uniforms
 	program.bind();
 	program.setUniformValue("uUseAttrNormal", true);
 	program.setUniformValue("uPointSize", 1.0f);
-	program.setUniformValue("uMVP", mvp);
+	program.setUniformValue("uMVP", mvp * modelMat);
 	program.setUniformValue("uModel", modelMat);
 	program.setUniformValue("uColor", QVector4D(0.7f, 0.7f, 0.75f, 1.0f));
 	program.setUniformValue("uAmbient", 0.2f);
@@ -200,34 +278,29 @@ void Renderer::drawMeshTriangles(const Mesh& mesh,
 
 	// Texture binding
 	bool useTex = false;
-	if(modelRef && modelRef->texture.loaded && !modelRef->texture.file.empty()){
-		useTex = bindTextureIfAvailable(modelRef->texture.file);
+	if(texture && texture->loaded && !texture->file.empty()){
+		useTex = bindTextureIfAvailable(texture->file);
 	}
 	program.setUniformValue("uUseTex", useTex);
 	if(useTex){ program.setUniformValue("uDiffuseTex", 0); }
 
 	// Draw
-	this->glDrawElements(GL_TRIANGLES, static_cast<int>(mesh.indices.size()), GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
+	this->glDrawElements(GL_TRIANGLES, gpu.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
 
-	// Cleanup - ВАЖЛИВО: destroy() звільняє GPU пам'ять, release() тільки відв'язує
+	// Buffers are cached in the retained mirror; only unbind
 	program.release();
-	ebo.release(); ebo.destroy();
-	vboUV.release(); vboUV.destroy();
-	vboNrm.release(); vboNrm.destroy();
-	vboPos.release(); vboPos.destroy();
+	gpu.idx.release();
+	gpu.uv.release();
 	vao.release();
 }
 
-void Renderer::drawPoints(const std::vector<float>& data, GLenum primitive, int count, const QVector4D& color){
+void Renderer::drawPoints(const float* data, int floatCount, GLenum primitive, int count, const QVector4D& color){
 	if(count <= 0) return;
 	program.bind();
 	program.setUniformValue("uColor", color);
 	vao.bind();
-	// Створюємо тимчасовий буфер для кожного виклику - так надійніше
-	QOpenGLBuffer vboTemp(QOpenGLBuffer::VertexBuffer);
-	vboTemp.create();
-	vboTemp.bind();
-	vboTemp.allocate(data.data(), static_cast<int>(data.size()*sizeof(float)));
+	streamPoints.bind();
+	streamPoints.allocate(data, static_cast<int>(floatCount*sizeof(float)));
 	this->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), reinterpret_cast<void*>(0));
 	this->glEnableVertexAttribArray(0);
 	// Disable normal attribute array slot when drawing points without normals
@@ -236,8 +309,7 @@ void Renderer::drawPoints(const std::vector<float>& data, GLenum primitive, int
 	this->glDisableVertexAttribArray(2);
 	// Expect caller to set a desired point size beforehand if drawing GL_POINTS
 	this->glDrawArrays(primitive, 0, count);
-	vboTemp.release();
-	vboTemp.destroy();
+	streamPoints.release();
 	vao.release();
 	program.release();
 }
@@ -245,9 +317,6 @@ void Renderer::drawPoints(const std::vector<float>& data, GLenum primitive, int
 void Renderer::renderScene(){
 	ensureGL();
 
-	this->glClearColor(0.1f,0.1f,0.15f,1.f);
-	this->glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-
 	// Compute MVP once from camera (or identity if no camera provided)
 	QMatrix4x4 proj; QMatrix4x4 view; QMatrix4x4 mvp;
 	const float aspect = viewportH > 0 ? float(viewportW)/float(viewportH) : 1.0f;
@@ -266,6 +335,44 @@ void Renderer::renderScene(){
 	}
 	mvp = proj * view;
 
+	frameMvp = mvp;
+
+	// Native viewport in device pixels (set up by the widget before paintGL)
+	GLint vp[4] = {0, 0, viewportW, viewportH};
+	this->glGetIntegerv(GL_VIEWPORT, vp);
+
+	GraphLayout layout;
+	layout.x = vp[0]; layout.y = vp[1]; layout.w = vp[2]; layout.h = vp[3];
+	if(dynResEnabled && resScale < kMaxResScale){
+		// Round to multiples of 8 so small scale changes don't rebuild the graph every frame
+		const int sw = std::max(8, (int(layout.w*resScale) + 7) & ~7);
+		const int sh = std::max(8, (int(layout.h*resScale) + 7) & ~7);
+		if(sw < layout.w && sh < layout.h){ layout.scaled = true; layout.sceneW = sw; layout.sceneH = sh; }
+	}
+	if(!graphValid || !(layout == graphLayout)){
+		graphValid = buildRenderGraph(layout);
+		if(!graphValid && layout.scaled){
+			// Fall back to drawing straight into the target
+			layout.scaled = false; layout.sceneW = layout.sceneH = 0;
+			graphValid = buildRenderGraph(layout);
+		}
+		graphLayout = layout;
+	}
+	if(graphValid) renderGraph.setImportedFramebuffer(graphBackbuffer, targetFbo ? targetFbo->handle() : QOpenGLContext::currentContext()->defaultFramebufferObject());
+	framePxPerUnit = 0.5f * proj(1,1) * float(graphLayout.scaled ? graphLayout.sceneH : graphLayout.h);
+	if(graphValid) renderGraph.execute(QOpenGLContext::currentContext()->extraFunctions());
+	updateResolutionScale();
+
+	// All render-path temporaries came from the arena; a heap block here means the frame outgrew it
+	if(frameArena.heapAllocationsThisFrame() > 0) markEvent(FrameStats::BufferGrowth);
+	frameArena.reset();
+}
+
+void Renderer::markEvent(unsigned e){
+	if(stats) stats->markEvent(static_cast<FrameStats::Event>(e));
+}
+
+void Renderer::drawOverlay(const QMatrix4x4& mvp){
 	// Draw coordinate axes (X=red, Y=green, Z=blue) with simple arrows
 	const float axisLen = 5.0f;
 	const float arrowSize = 0.4f;
@@ -280,40 +387,28 @@ void Renderer::renderScene(){
 	program.release();
 	
 	// X axis - Red
-	std::vector<float> xData = {
+	const float xData[] = {
 		0.0f, 0.0f, 0.0f,  axisLen, 0.0f, 0.0f,  // main line
 		axisLen, 0.0f, 0.0f,  axisLen-arrowSize, arrowSize*0.5f, 0.0f,  // arrow line 1
 		axisLen, 0.0f, 0.0f,  axisLen-arrowSize, -arrowSize*0.5f, 0.0f  // arrow line 2
 	};
-	drawPoints(xData, GL_LINES, 6, QVector4D(1.0f, 0.0f, 0.0f, 1.0f));
+	drawPoints(xData, 18, GL_LINES, 6, QVector4D(1.0f, 0.0f, 0.0f, 1.0f));
 	
 	// Y axis - Green
-	std::vector<float> yData = {
+	const float yData[] = {
 		0.0f, 0.0f, 0.0f,  0.0f, axisLen, 0.0f,  // main line
 		0.0f, axisLen, 0.0f,  arrowSize*0.5f, axisLen-arrowSize, 0.0f,  // arrow line 1
 		0.0f, axisLen, 0.0f,  -arrowSize*0.5f, axisLen-arrowSize, 0.0f  // arrow line 2
 	};
-	drawPoints(yData, GL_LINES, 6, QVector4D(0.0f, 1.0f, 0.0f, 1.0f));
+	drawPoints(yData, 18, GL_LINES, 6, QVector4D(0.0f, 1.0f, 0.0f, 1.0f));
 	
 	// Z axis - Blue
-	std::vector<float> zData = {
+	const float zData[] = {
 		0.0f, 0.0f, 0.0f,  0.0f, 0.0f, axisLen,  // main line
 		0.0f, 0.0f, axisLen,  arrowSize*0.5f, 0.0f, axisLen-arrowSize,  // arrow line 1
 		0.0f, 0.0f, axisLen,  -arrowSize*0.5f, 0.0f, axisLen-arrowSize  // arrow line 2
 	};
-	drawPoints(zData, GL_LINES, 6, QVector4D(0.0f, 0.0f, 1.0f, 1.0f));
-
-	// Pack up to 16 lights (reused by model rendering)
-	const int maxL = 16;
-	std::vector<QVector3D> lpos; lpos.reserve(std::min((int)lights.size(), maxL));
-	std::vector<QVector3D> lcol; lcol.reserve(std::min((int)lights.size(), maxL));
-	std::vector<float> lint; lint.reserve(std::min((int)lights.size(), maxL));
-	for(size_t i=0;i<lights.size() && (int)i<maxL;i++){
-		auto* l = lights[i]; if(!l) continue;
-		lpos.emplace_back(l->position.x, l->position.y, l->position.z);
-		lcol.emplace_back(l->color.r, l->color.g, l->color.b);
-		lint.emplace_back(l->intensity);
-	}
+	drawPoints(zData, 18, GL_LINES, 6, QVector4D(0.0f, 0.0f, 1.0f, 1.0f));
 
 	// Draw lights as points
 	if(!lights.empty()){
@@ -330,25 +425,418 @@ void Renderer::renderScene(){
 			program.setUniformValue("uUseAttrNormal", false);
 			program.setUniformValue("uUseTex", false);
 			program.release();
-			const std::vector<float> one = { l->position.x, l->position.y, l->position.z };
-			drawPoints(one, GL_POINTS, 1, col);
+			const float one[] = { l->position.x, l->position.y, l->position.z };
+			drawPoints(one, 3, GL_POINTS, 1, col);
 		}
 	}
+}
+
+void Renderer::drawModels(const QMatrix4x4& mvp){
+	// Pack up to 16 lights (reused by model rendering)
+	const int maxL = 16;
+	FrameVector<QVector3D> lpos{ArenaAllocator<QVector3D>(frameArena)}; lpos.reserve(std::min((int)lights.size(), maxL));
+	FrameVector<QVector3D> lcol{ArenaAllocator<QVector3D>(frameArena)}; lcol.reserve(std::min((int)lights.size(), maxL));
+	FrameVector<float> lint{ArenaAllocator<float>(frameArena)}; lint.reserve(std::min((int)lights.size(), maxL));
+	for(size_t i=0;i<lights.size() && (int)i<maxL;i++){
+		auto* l = lights[i]; if(!l) continue;
+		lpos.emplace_back(l->position.x, l->position.y, l->position.z);
+		lcol.emplace_back(l->color.r, l->color.g, l->color.b);
+		lint.emplace_back(l->intensity);
+	}
+
+	if(texturesPending) loadPendingTextures();
 
-	// Draw models as lit triangle meshes (first mesh per model for now)
-	for(auto* m : models){
+	// Draw models as lit triangle meshes (every mesh, e.g. one per OBJ material group or glTF
+	// primitive). Models are paged onto the GPU whole, largest on screen first, within the
+	// geometry budget; a visible model that isn't resident yet is drawn as its bounding box meanwhile.
+	++frameNumber;
+	struct Pending { RetainedModel* rm; float sizePx; };
+	FrameVector<Pending> pending{ArenaAllocator<Pending>(frameArena)};
+	QVector4D planes[6];
+	for(auto& rm : retained){
+		const Model* m = rm.model.get();
 		if(!m) continue; if(m->meshes.empty()) continue;
-		const auto& mesh = m->meshes.front();
-		QMatrix4x4 modelMat; // identity until we have per-model transforms
-		drawMeshTriangles(mesh, m, modelMat, mvp, lpos, lcol, lint);
+		float sizePx = std::numeric_limits<float>::max();
+		if(rm.hasBounds){
+			const QMatrix4x4 clip = mvp * rm.transform;
+			frustumPlanes(clip, planes);
+			if(!boxVisible(planes, rm.boundsMin, rm.boundsMax)) continue;
+			sizePx = boxDiagonal(rm.boundsMin, rm.boundsMax) * axisScale(rm.transform) * framePxPerUnit / centreW(clip.row(3), rm.boundsMin, rm.boundsMax);
+		}
+		rm.lastVisible = frameNumber;
+		if(rm.gpu.empty()) pending.push_back({&rm, sizePx});
+		else for(auto& g : rm.gpu) drawMeshTriangles(*g, &rm.texture, rm.transform, mvp, lpos, lcol, lint);
+	}
+	std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b){ return a.sizePx > b.sizePx; });
+	std::size_t uploadBudget = kUploadBytesPerFrame;
+	for(const Pending& p : pending){
+		RetainedModel& rm = *p.rm;
+		std::size_t bytes = 0;
+		for(const Mesh& mesh : rm.model->meshes) bytes += meshBytes(mesh);
+		// At least one upload per frame, however large the model
+		if((bytes <= uploadBudget || uploadBudget == kUploadBytesPerFrame) && makeRoom(bytes)){
+			for(const Mesh& mesh : rm.model->meshes){
+				rm.gpu.push_back(std::make_unique<MeshGpu>());
+				uploadMesh(mesh, *rm.gpu.back());
+				geometryBytes += rm.gpu.back()->bytes;
+			}
+			uploadBudget -= std::min(uploadBudget, bytes);
+			for(auto& g : rm.gpu) drawMeshTriangles(*g, &rm.texture, rm.transform, mvp, lpos, lcol, lint);
+		} else if(rm.hasBounds) drawBoundsProxy(rm, mvp);
 	}
+	drawPointClouds(mvp);
+}
+
+void Renderer::updateBounds(RetainedModel& rm){
+	// From the file where possible, so culling a paged-out model doesn't touch its vertices
+	rm.hasBounds = rm.model && modelBounds(*rm.model, rm.boundsMin, rm.boundsMax);
+}
+
+void Renderer::evict(RetainedModel& rm){
+	if(rm.gpu.empty()) return;
+	for(const auto& g : rm.gpu) geometryBytes -= g->bytes;
+	rm.gpu.clear();
+	++resourceEpoch;
+}
+
+bool Renderer::makeRoom(std::size_t bytes){
+	while(geometryBytes + bytes > geometryBudget){
+		RetainedModel* oldest = nullptr;
+		for(auto& rm : retained)
+			if(!rm.gpu.empty() && rm.lastVisible < frameNumber && (!oldest || rm.lastVisible < oldest->lastVisible)) oldest = &rm;
+		if(!oldest) return false; // everything resident is on screen
+		evict(*oldest);
+	}
+	return true;
+}
+
+void Renderer::drawBoundsProxy(const RetainedModel& rm, const QMatrix4x4& mvp){
+	// The 12 edges: four along each axis
+	const float* lo = rm.boundsMin; const float* hi = rm.boundsMax;
+	float lines[24*3]; int n = 0;
+	for(int a=0;a<3;a++) for(int k=0;k<4;k++){
+		const int b = (a+1)%3, c = (a+2)%3;
+		float p[3];
+		p[b] = (k&1) ? hi[b] : lo[b]; p[c] = (k&2) ? hi[c] : lo[c];
+		p[a] = lo[a]; for(float f : p) lines[n++] = f;
+		p[a] = hi[a]; for(float f : p) lines[n++] = f;
+	}
+	program.bind();
+	program.setUniformValue("uMVP", mvp * rm.transform);
+	program.setUniformValue("uModel", rm.transform);
+	program.setUniformValue("uPointSize", 1.0f);
+	program.setUniformValue("uAmbient", 1.0f);
+	program.setUniformValue("uLightCount", 0);
+	program.setUniformValue("uUseAttrNormal", false);
+	program.setUniformValue("uUseTex", false);
+	program.release();
+	drawPoints(lines, n, GL_LINES, n/3, QVector4D(0.6f, 0.6f, 0.65f, 1.0f));
+}
+
+void Renderer::uploadPointChunks(const PointCloud& cloud, RetainedModel& rm, std::size_t& uploadBudget){
+	static_assert(sizeof(PointCloud::Point) == 16, "point layout is uploaded as is");
+	if(rm.pointChunks.empty()){
+		// Cells are contiguous in the point array, so a run of them is one buffer range
+		const std::uint32_t cellCount = static_cast<std::uint32_t>(cloud.cells.size());
+		for(std::uint32_t c=0;c<cellCount;){
+			auto chunk = std::make_unique<PointChunkGpu>();
+			chunk->firstCell = c; chunk->firstPoint = cloud.cells[c].first;
+			while(c < cellCount && chunk->pointCount + cloud.cells[c].count <= kChunkPoints){ chunk->pointCount += cloud.cells[c].count; chunk->cellCount++; c++; }
+			rm.pointChunks.push_back(std::move(chunk));
+		}
+	}
+	// Large clouds stream in over a few frames instead of stalling one
+	for(auto& chunk : rm.pointChunks){
+		if(chunk->uploaded) continue;
+		if(chunk->pointCount > uploadBudget) return;
+		chunk->vbo.create();
+		chunk->vbo.bind();
+		chunk->vbo.allocate(cloud.points.data() + chunk->firstPoint, static_cast<int>(chunk->pointCount * sizeof(PointCloud::Point)));
+		chunk->vbo.release();
+		chunk->uploaded = true;
+		uploadBudget -= chunk->pointCount;
+		markEvent(FrameStats::BufferGrowth);
+		++resourceEpoch;
+	}
+}
+
+void Renderer::drawPointClouds(const QMatrix4x4& mvp){
+	pointsDrawn = 0;
+	struct VisibleCell {
+		const RetainedModel* rm; PointChunkGpu* chunk; const PointCloud::Cell* cell;
+		float sizePx;  // cell diagonal in pixels at w = 1
+		float area;    // projected size in pixels squared
+		std::uint32_t take;
+	};
+	FrameVector<VisibleCell> visible{ArenaAllocator<VisibleCell>(frameArena)};
+	std::size_t uploadBudget = kUploadPointsPerFrame, total = 0;
+	for(auto& rm : retained){
+		const Model* m = rm.model.get();
+		if(!m || !m->points || m->points->cells.empty()) continue;
+		const PointCloud& cloud = *m->points;
+		uploadPointChunks(cloud, rm, uploadBudget);
+		const QMatrix4x4 clip = mvp * rm.transform;
+		const QVector4D r3 = clip.row(3);
+		QVector4D planes[6];
+		frustumPlanes(clip, planes);
+		const float scale = axisScale(rm.transform);
+		// Cells are tested on all cores; 0 marks a culled one
+		FrameVector<float> cellPx(cloud.cells.size(), 0.f, ArenaAllocator<float>(frameArena));
+		for(auto& chunk : rm.pointChunks){
+			if(!chunk->uploaded) continue;
+			const std::uint32_t first = chunk->firstCell;
+			JobSystem::instance().parallelFor(chunk->cellCount, [&](std::size_t i){
+				const PointCloud::Cell& cell = cloud.cells[first + i];
+				if(!boxVisible(planes, cell.boundsMin, cell.boundsMax)) return;
+				const float sizePx = boxDiagonal(cell.boundsMin, cell.boundsMax) * scale * framePxPerUnit;
+				cellPx[first + i] = std::max(1.f, sizePx / centreW(r3, cell.boundsMin, cell.boundsMax));
+			}, 256);
+			for(std::uint32_t c=first;c<first+chunk->cellCount;c++){
+				if(cellPx[c] == 0.f) continue;
+				const PointCloud::Cell& cell = cloud.cells[c];
+				const float sizePx = boxDiagonal(cell.boundsMin, cell.boundsMax) * scale * framePxPerUnit;
+				visible.push_back({&rm, chunk.get(), &cell, sizePx, cellPx[c]*cellPx[c], cell.count});
+				total += cell.count;
+			}
+		}
+	}
+	if(visible.empty()) return;
+
+	if(total > pointBudget){
+		// Every cell keeps points in proportion to its screen area (capped at what it has):
+		// bisect the ratio so the sum meets the budget. Points are shuffled per cell, so a prefix is an even subsample.
+		double lo = 0.0, hi = 0.0;
+		for(const VisibleCell& v : visible) hi = std::max(hi, double(v.cell->count) / v.area);
+		for(int it=0;it<40;it++){
+			const double s = 0.5 * (lo + hi);
+			std::size_t sum = 0;
+			for(const VisibleCell& v : visible) sum += static_cast<std::size_t>(std::min(double(v.cell->count), s * v.area));
+			(sum > pointBudget ? hi : lo) = s;
+		}
+		for(VisibleCell& v : visible) v.take = static_cast<std::uint32_t>(std::min(double(v.cell->count), lo * v.area));
+	}
+
+	program.bind();
+	const int locSplat = program.uniformLocation("uSplatScale");
+	program.setUniformValue("uUseAttrNormal", false);
+	program.setUniformValue("uUseTex", false);
+	program.setUniformValue("uLightCount", 0);
+	program.setUniformValue("uAmbient", 1.0f); // unlit: scans carry their own shading
+	program.setUniformValue("uColor", QVector4D(0.8f, 0.8f, 0.8f, 1.0f));
+	vao.bind();
+	this->glDisableVertexAttribArray(1);
+	this->glDisableVertexAttribArray(2);
+	this->glEnableVertexAttribArray(0);
+	const RetainedModel* boundModel = nullptr; PointChunkGpu* boundChunk = nullptr;
+	for(const VisibleCell& v : visible){
+		if(v.take == 0) continue;
+		if(v.rm != boundModel){
+			boundModel = v.rm;
+			program.setUniformValue("uMVP", mvp * v.rm->transform);
+			program.setUniformValue("uModel", v.rm->transform);
+			const bool hasColor = v.rm->model->points->hasColor;
+			program.setUniformValue("uUseAttrColor", hasColor);
+			if(hasColor) this->glEnableVertexAttribArray(3); else this->glDisableVertexAttribArray(3);
+			boundChunk = nullptr;
+		}
+		if(v.chunk != boundChunk){
+			boundChunk = v.chunk;
+			v.chunk->vbo.bind();
+			this->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PointCloud::Point), reinterpret_cast<void*>(0));
+			this->glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PointCloud::Point), reinterpret_cast<void*>(12));
+		}
+		// Fewer points over the same area: grow the splats so the surface stays closed
+		program.setUniformValue(locSplat, v.sizePx / std::sqrt(float(v.take)));
+		this->glDrawArrays(GL_POINTS, static_cast<GLint>(v.cell->first - v.chunk->firstPoint), static_cast<GLsizei>(v.take));
+		pointsDrawn += v.take;
+	}
+	// Leave the shared program as the mesh and overlay paths expect it
+	this->glDisableVertexAttribArray(3);
+	program.setUniformValue(locSplat, 0.0f);
+	program.setUniformValue("uUseAttrColor", false);
+	if(boundChunk) boundChunk->vbo.release();
+	vao.release();
+	program.release();
+}
+
+Renderer::RetainedModel* Renderer::findRetained(std::uint32_t id){
+	for(auto& rm : retained) if(rm.id == id) return &rm;
+	return nullptr;
+}
+
+void Renderer::setSnapshot(const FrameSnapshot& snap){
+	cam = &snap.camera;
+	bool lightsChanged = false;
+	const std::uint64_t applied = mirrorVersion;
+	for(const SceneDelta& d : snap.deltas){
+		// Deltas are cumulative until confirmed, so earlier ones may already be applied.
+		// A resync batch shares one version, hence the comparison against the batch start.
+		if(d.change.version <= applied) continue;
+		mirrorVersion = std::max(mirrorVersion, d.change.version);
+		const std::uint32_t id = d.change.id;
+		switch(d.change.kind){
+		case SceneChange::Kind::Cleared:
+			retained.clear(); retainedLights.clear(); lightsChanged = true;
+			geometryBytes = 0;
+			++resourceEpoch;
+			break;
+		case SceneChange::Kind::ModelAdded:
+			if(d.model && !findRetained(id)){
+				RetainedModel rm;
+				rm.id = id; rm.model = d.model; rm.texture = d.texture;
+				rm.transform = QMatrix4x4(d.transform.data()).transposed(); // stored column-major
+				updateBounds(rm);
+				texturesPending = texturesPending || !rm.texture.file.empty();
+				retained.push_back(std::move(rm));
+			}
+			break;
+		case SceneChange::Kind::ModelRemoved:
+			for(size_t i=0;i<retained.size();i++) if(retained[i].id == id){ evict(retained[i]); retained.erase(retained.begin() + static_cast<std::ptrdiff_t>(i)); ++resourceEpoch; break; }
+			break;
+		case SceneChange::Kind::GeometryEdited:
+			if(auto* rm = findRetained(id)){
+				if(d.model) rm->model = d.model;
+				evict(*rm); rm->pointChunks.clear(); updateBounds(*rm);
+				++resourceEpoch;
+			}
+			break;
+		case SceneChange::Kind::TransformEdited:
+			if(auto* rm = findRetained(id)) rm->transform = QMatrix4x4(d.transform.data()).transposed();
+			break;
+		case SceneChange::Kind::TextureChanged:
+			if(auto* rm = findRetained(id)){ rm->texture = d.texture; texturesPending = texturesPending || !rm->texture.file.empty(); }
+			break;
+		case SceneChange::Kind::LightAdded:
+			retainedLights.push_back({id, d.light}); lightsChanged = true;
+			break;
+		case SceneChange::Kind::LightRemoved:
+			for(size_t i=0;i<retainedLights.size();i++) if(retainedLights[i].id == id){ retainedLights.erase(retainedLights.begin() + static_cast<std::ptrdiff_t>(i)); lightsChanged = true; break; }
+			break;
+		case SceneChange::Kind::LightEdited:
+			for(auto& rl : retainedLights) if(rl.id == id) rl.light = d.light;
+			break;
+		}
+	}
+	if(lightsChanged){
+		lights.clear();
+		for(const auto& rl : retainedLights) lights.push_back(&rl.light);
+	}
+}
+
+bool Renderer::buildRenderGraph(const GraphLayout& layout){
+	QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+	using G = RenderGraph;
+	renderGraph.reset();
+	// The real target is set by renderScene() before every execute()
+	const G::ResourceId backbuffer = renderGraph.importFramebuffer("backbuffer", 0, layout.x, layout.y, layout.w, layout.h);
+	graphBackbuffer = backbuffer;
+	G::ResourceId sceneColor = backbuffer, sceneDepth = backbuffer;
+	if(layout.scaled){
+		sceneColor = renderGraph.createTexture("sceneColor", {layout.sceneW, layout.sceneH, G::Format::RGBA8});
+		sceneDepth = renderGraph.createTexture("sceneDepth", {layout.sceneW, layout.sceneH, G::Format::Depth24Stencil8});
+	}
+	renderGraph.addPass("Scene", [&](G::PassBuilder& b){
+		b.write(sceneColor);
+		if(sceneDepth != sceneColor) b.write(sceneDepth);
+	}, [this](const G::PassContext&){
+		this->glClearColor(0.1f,0.1f,0.15f,1.f);
+		this->glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+		beginGpuTimer();
+		drawModels(frameMvp);
+		endGpuTimer();
+	});
+	if(layout.scaled){
+		const int sw = layout.sceneW, sh = layout.sceneH;
+		renderGraph.addPass("Upscale", [&](G::PassBuilder& b){
+			b.read(sceneColor); b.read(sceneDepth); b.write(backbuffer);
+		}, [this, sw, sh](const G::PassContext& ctx){
+			// Upscale colour, then copy depth so the overlay is still occluded by models
+			QOpenGLExtraFunctions* f = QOpenGLContext::currentContext()->extraFunctions();
+			f->glBindFramebuffer(GL_READ_FRAMEBUFFER, ctx.readFbo);
+			f->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, ctx.drawFbo);
+			const int x1 = ctx.x + ctx.width, y1 = ctx.y + ctx.height;
+			f->glBlitFramebuffer(0, 0, sw, sh, ctx.x, ctx.y, x1, y1, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			f->glBlitFramebuffer(0, 0, sw, sh, ctx.x, ctx.y, x1, y1, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+			f->glBindFramebuffer(GL_FRAMEBUFFER, ctx.drawFbo);
+		});
+	}
+	// Axes and light gizmos always at native resolution
+	renderGraph.addPass("Overlay", [&](G::PassBuilder& b){ b.write(backbuffer); },
+		[this](const G::PassContext&){ drawOverlay(frameMvp); });
+
+	const bool ok = renderGraph.compile(gl);
+	markEvent(FrameStats::BufferGrowth);
+	++resourceEpoch;
+	++graphBuildCount;
+	return ok;
+}
+
+void Renderer::shareJobSystem(JobSystem& jobs){ JobSystem::setInstance(jobs); }
+
+Renderer::~Renderer(){
+	// Graph textures/FBOs are raw GL names, so they need the context that made them
+	if(QOpenGLContext::currentContext()) renderGraph.release(QOpenGLContext::currentContext()->extraFunctions());
+}
+
+void Renderer::setDynamicResolution(bool on){
+	dynResEnabled = on;
+	// Transient targets are dropped on the next frame, when the graph is rebuilt
+	if(!on) resScale = kMaxResScale;
+}
+
+void Renderer::beginGpuTimer(){
+	if(!dynResEnabled || !gpuTimersReady) return;
+	const int slot = gpuTimerFrame % kTimerQueries;
+	if(gpuTimerPending[slot]){
+		// Result from kTimerQueries frames ago; skip the sample rather than stall on it
+		if(gpuTimers[slot].isResultAvailable()){
+			gpuSceneMs = static_cast<float>(gpuTimers[slot].waitForResult()) / 1.0e6f;
+			gpuSampleFresh = true;
+		}
+		gpuTimerPending[slot] = false;
+	}
+	gpuTimers[slot].begin();
+}
+
+void Renderer::endGpuTimer(){
+	if(!dynResEnabled || !gpuTimersReady) return;
+	const int slot = gpuTimerFrame % kTimerQueries;
+	gpuTimers[slot].end();
+	gpuTimerPending[slot] = true;
+	++gpuTimerFrame;
+}
+
+void Renderer::updateResolutionScale(){
+	if(!dynResEnabled || !gpuSampleFresh) return;
+	gpuSampleFresh = false;
+	// Leave part of the frame for overlay, upscale and CPU work
+	const float budget = targetFrameMs * 0.85f;
+	const float ms = std::max(0.01f, gpuSceneMs);
+	// GPU cost is roughly proportional to pixel count, i.e. scale^2
+	float desired = resScale * std::sqrt(budget / ms);
+	desired = std::max(kMinResScale, std::min(kMaxResScale, desired));
+	// Hysteresis: ignore small wobble, then move gradually to avoid visible pumping
+	if(std::fabs(desired - resScale) < 0.03f * resScale) return;
+	resScale += (desired - resScale) * 0.25f;
+	resScale = std::max(kMinResScale, std::min(kMaxResScale, resScale));
 }
 
 // Create GL texture from image file and return id, 0 on failure
 unsigned int Renderer::createTextureFromImage(const QString& qpath){
-	QImage img(qpath);
-	if(img.isNull()) return 0;
-	QImage src = img.convertToFormat(QImage::Format_RGBA8888).mirrored();
+	return createTexture(QImage(qpath));
+}
+
+namespace {
+// As glTexImage2D takes it: RGBA, bottom row first
+QImage textureImage(const QImage& img){ return img.isNull() ? QImage() : img.convertToFormat(QImage::Format_RGBA8888).mirrored(); }
+}
+
+unsigned int Renderer::createTexture(const QImage& img){
+	return uploadTexture(textureImage(img));
+}
+
+unsigned int Renderer::uploadTexture(const QImage& src){
+	if(src.isNull()) return 0;
 	unsigned int texId = 0;
 	this->glGenTextures(1, &texId);
 	this->glActiveTexture(GL_TEXTURE0);
@@ -360,6 +848,8 @@ unsigned int Renderer::createTextureFromImage(const QString& qpath){
 	this->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	this->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, src.width(), src.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, src.constBits());
 	this->glGenerateMipmap(GL_TEXTURE_2D);
+	markEvent(FrameStats::TextureUpload);
+	++resourceEpoch;
 	return texId;
 }
 
@@ -381,6 +871,38 @@ bool Renderer::bindTextureIfAvailable(const std::string& path){
 	return true;
 }
 
+void Renderer::loadPendingTextures(){
+	// New texture files are decoded on all cores, then uploaded here; a file that fails is left
+	// to bindTextureIfAvailable as before
+	texturesPending = false;
+	std::vector<std::string> paths;
+	for(const auto& rm : retained){
+		const std::string& f = rm.texture.file;
+		if(!rm.texture.loaded || f.empty() || textureCache.count(f) || std::find(paths.begin(), paths.end(), f) != paths.end()) continue;
+		paths.push_back(f);
+	}
+	if(paths.empty()) return;
+	std::vector<QImage> images(paths.size());
+	JobSystem::instance().parallelFor(paths.size(), [&](std::size_t i){
+		const QFileInfo fi(QString::fromStdString(paths[i]));
+		if(fi.exists()) images[i] = textureImage(QImage(fi.absoluteFilePath()));
+	});
+	for(std::size_t i=0;i<paths.size();i++){
+		const unsigned int id = uploadTexture(images[i]);
+		if(id) textureCache.emplace(paths[i], id);
+	}
+}
+
+void Renderer::replaceTexture(const std::string& path, const QImage& image){
+	if(!glReady) return;
+	auto it = textureCache.find(path);
+	if(it == textureCache.end()) return; // first use reads the file as it is now
+	const unsigned int id = createTexture(image);
+	if(id == 0) return;
+	this->glDeleteTextures(1, &it->second);
+	it->second = id;
+}
+
 void Renderer::clearTextures(){
 	if(!glReady) return;
 	for(const auto& pair : textureCache){
@@ -388,4 +910,6 @@ void Renderer::clearTextures(){
 		this->glDeleteTextures(1, &texId);
 	}
 	textureCache.clear();
+	texturesPending = true;
+	++resourceEpoch;
 }